@@ -1,42 +1,139 @@
 #include <pybind11/numpy.h>
 #include <vector>
 
+#include <config.h>
 #include <driver/array.h>
+#include <driver/array_pool.h>
 #include <ffi.h>
 
 namespace freetensor {
 
 using namespace pybind11::literals;
 
-void init_ffi_array(py::module_ &m) {
-#define INIT_FROM_NUMPY_DEV(nativeType, dtype)                                 \
-    py::init([](py::array_t<nativeType, py::array::c_style> &np,               \
-                const Ref<Device> &device) {                                   \
-        std::vector<size_t> shape(np.shape(), np.shape() + np.ndim());         \
-        Array arr(shape, dtype, device);                                       \
-        arr.fromCPU(np.unchecked().data(), np.nbytes());                       \
-        return arr;                                                            \
-    })
+/**
+ * Keep a Python object alive from C++, possibly released from a non-Python
+ * thread
+ */
+static std::shared_ptr<void> keepAlive(const py::object &obj) {
+    return std::shared_ptr<void>(new py::object(obj), [](void *p) {
+        py::gil_scoped_acquire acquire;
+        delete (py::object *)p;
+    });
+}
 
-#define INIT_FROM_NUMPY(nativeType, dtype)                                     \
-    py::init([](py::array_t<nativeType, py::array::c_style> &np) {             \
-        std::vector<size_t> shape(np.shape(), np.shape() + np.ndim());         \
-        Array arr(shape, dtype);                                               \
-        arr.fromCPU(np.unchecked().data(), np.nbytes());                       \
-        return arr;                                                            \
-    })
+static std::string bufferFormat(DataType dtype) {
+    switch (dtype) {
+    case DataType::Int64:
+        return py::format_descriptor<int64_t>::format();
+    case DataType::Int32:
+        return py::format_descriptor<int32_t>::format();
+    case DataType::Float64:
+        return py::format_descriptor<double>::format();
+    case DataType::Float32:
+        return py::format_descriptor<float>::format();
+    case DataType::Bool:
+        return py::format_descriptor<bool>::format();
+    default:
+        ASSERT(false);
+    }
+}
+
+/**
+ * Create an `Array` from a numpy array
+ *
+ * If `copy` is false, borrow the numpy array's memory instead of copying it.
+ * Arrays to be used on non-CPU devices are still copied. So are read-only or
+ * non-contiguous arrays, with a warning, because writes to the `Array` would
+ * not reach them
+ */
+template <class T>
+static Array fromNumpy(const py::array &np, DataType dtype,
+                       const Ref<Device> &device, bool copy) {
+    std::vector<size_t> shape(np.shape(), np.shape() + np.ndim());
+    if (!copy && device->type() == TargetType::CPU) {
+        if (np.writeable() && (np.flags() & py::array::c_style)) {
+            return Array(const_cast<void *>(np.data()), shape, dtype, device,
+                         keepAlive(np));
+        }
+        WARNING("The numpy array is copied instead of borrowed, because it is "
+                "read-only or not contiguous");
+    }
+    auto contiguous = py::array_t<T, py::array::c_style>::ensure(np);
+    Array arr(shape, dtype, device);
+    arr.fromCPU(contiguous.data(), contiguous.nbytes());
+    return arr;
+}
 
-    py::class_<Array, Ref<Array>>(m, "Array")
-        .def(INIT_FROM_NUMPY_DEV(double, DataType::Float64))
-        .def(INIT_FROM_NUMPY_DEV(float, DataType::Float32))
-        .def(INIT_FROM_NUMPY_DEV(int64_t, DataType::Int64))
-        .def(INIT_FROM_NUMPY_DEV(int32_t, DataType::Int32))
-        .def(INIT_FROM_NUMPY_DEV(bool, DataType::Bool))
-        .def(INIT_FROM_NUMPY(double, DataType::Float64))
-        .def(INIT_FROM_NUMPY(float, DataType::Float32))
-        .def(INIT_FROM_NUMPY(int64_t, DataType::Int64))
-        .def(INIT_FROM_NUMPY(int32_t, DataType::Int32))
-        .def(INIT_FROM_NUMPY(bool, DataType::Bool))
+static Array fromNumpy(const py::object &obj, const Ref<Device> &device,
+                       bool copy) {
+    // Keep the data type of a numpy array of a supported type. Otherwise,
+    // convert to Float64 as numpy does, which is impossible without a copy
+    if (py::isinstance<py::array>(obj)) {
+        auto np = py::reinterpret_borrow<py::array>(obj);
+        auto &&dt = np.dtype();
+        switch (dt.kind()) {
+        case 'f':
+            if (dt.itemsize() == 8) {
+                return fromNumpy<double>(np, DataType::Float64, device, copy);
+            }
+            if (dt.itemsize() == 4) {
+                return fromNumpy<float>(np, DataType::Float32, device, copy);
+            }
+            break;
+        case 'i':
+            if (dt.itemsize() == 8) {
+                return fromNumpy<int64_t>(np, DataType::Int64, device, copy);
+            }
+            if (dt.itemsize() == 4) {
+                return fromNumpy<int32_t>(np, DataType::Int32, device, copy);
+            }
+            break;
+        case 'b':
+            return fromNumpy<bool>(np, DataType::Bool, device, copy);
+        }
+        if (!copy) {
+            throw DriverError("Unable to borrow a numpy array of data type " +
+                              std::string(py::str(dt)) +
+                              ", which has to be converted");
+        }
+    } else if (!copy) {
+        throw DriverError("Unable to borrow a non-numpy object");
+    }
+    auto np = py::array_t<double, py::array::c_style |
+                                      py::array::forcecast>::ensure(obj);
+    if (!np) {
+        throw DriverError("Unable to convert " +
+                          std::string(py::str(obj.get_type())) +
+                          " to an Array");
+    }
+    return fromNumpy<double>(np, DataType::Float64, device, true);
+}
+
+void init_ffi_array(py::module_ &m) {
+    py::class_<Array, Ref<Array>>(m, "Array", py::buffer_protocol())
+        .def(py::init([](const py::object &np, const Ref<Device> &device,
+                         bool copy) { return fromNumpy(np, device, copy); }),
+             "data"_a, "device"_a, "copy"_a = true)
+        .def(py::init([](const py::object &np, bool copy) {
+                 return fromNumpy(np, Config::defaultDevice(), copy);
+             }),
+             "data"_a, "copy"_a = true)
+        // Expose the data on CPU without copying, e.g. for `np.asarray`. The
+        // view is valid until the Array is modified on, or moved to, another
+        // device
+        .def_buffer([](Array &arr) {
+            std::vector<ssize_t> shape(arr.shape().begin(), arr.shape().end());
+            std::vector<ssize_t> strides(shape.size());
+            ssize_t stride = sizeOf(arr.dtype());
+            for (size_t i = shape.size(); i > 0; i--) {
+                strides[i - 1] = stride;
+                stride *= shape[i - 1];
+            }
+            return py::buffer_info(arr.rawSharedToCPU(), sizeOf(arr.dtype()),
+                                   bufferFormat(arr.dtype()), shape.size(),
+                                   shape, strides);
+        })
+        .def_property_readonly("is_borrowed", &Array::isBorrowed)
         .def("numpy",
              [](Array &arr) -> py::object {
                  switch (arr.dtype()) {
@@ -79,5 +176,21 @@ void init_ffi_array(py::module_ &m) {
         .def_property_readonly("prefer_device", &Array::preferDevice);
 
     py::implicitly_convertible<py::array, Array>();
+
+    m.def(
+        "array_pool_stats",
+        []() {
+            auto stats = ArrayPool::getInstance().stats();
+            auto total = stats.hits_ + stats.misses_;
+            return py::dict(
+                "live_bytes"_a = stats.liveBytes_,
+                "cached_bytes"_a = stats.cachedBytes_, "hits"_a = stats.hits_,
+                "misses"_a = stats.misses_,
+                "hit_rate"_a = total == 0 ? 0. : (double)stats.hits_ / total);
+        },
+        "Statistics of the pool allocating Array storage on CPU");
+    m.def(
+        "trim_array_pool", []() { ArrayPool::getInstance().trim(); },
+        "Release all freed Array storage cached in the pool to the system");
 }
 } // namespace freetensor
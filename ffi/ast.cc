@@ -5,6 +5,7 @@
 #include <ffi.h>
 #include <frontend/frontend_var.h>
 #include <func.h>
+#include <hash.h>
 #include <serialize/load_ast.h>
 #include <serialize/print_ast.h>
 #include <stmt.h>
@@ -87,6 +88,11 @@ void init_ffi_ast(py::module_ &m) {
     pyAST
         .def("match",
              [](const Stmt &op, const Stmt &other) { return match(op, other); })
+        .def("hash", [](const AST &op) { return op->hash(); })
+        .def("same_as",
+             [](const AST &op, const AST &other) {
+                 return HashComparator()(op, other);
+             })
         .def("type", [](const AST &op) { return op->nodeType(); })
         .def("node_type",
              [](const AST &op) {
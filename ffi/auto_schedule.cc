@@ -10,6 +10,26 @@ using namespace pybind11::literals;
 void init_ffi_auto_schedule(py::module_ &m) {
     py::class_<Sketch>(m, "Sketch")
         .def("get_annotation", &Sketch::getAnnotation);
+    py::class_<CostModel>(m, "CostModel")
+        .def(py::init<>())
+        .def("trained", &CostModel::trained)
+        .def("predict", &CostModel::predict, "features"_a,
+             py::call_guard<py::gil_scoped_release>())
+        .def("update", &CostModel::update, "features"_a, "flops"_a,
+             py::call_guard<py::gil_scoped_release>());
+    py::class_<TuningRecord>(m, "TuningRecord")
+        .def(py::init([](const std::string &sketch,
+                         const std::vector<int> &annotation,
+                         const std::vector<std::string> &logs,
+                         const std::vector<double> &feature, double time) {
+                 return TuningRecord{sketch, annotation, logs, feature, time};
+             }),
+             "sketch"_a, "annotation"_a, "logs"_a, "feature"_a, "time"_a)
+        .def_readonly("sketch", &TuningRecord::sketch_)
+        .def_readonly("annotation", &TuningRecord::annotation_)
+        .def_readonly("logs", &TuningRecord::logs_)
+        .def_readonly("feature", &TuningRecord::feature_)
+        .def_readonly("time", &TuningRecord::time_);
     py::class_<AutoSchedule>(m, "AutoSchedule")
         .def(py::init<
                  const Schedule &, const Ref<Target> &, const Ref<Device> &,
@@ -20,11 +40,18 @@ void init_ffi_auto_schedule(py::module_ &m) {
                                           const AutoSchedule::Predicts &)> &,
                  std::string>(),
              "schedule"_a, "target"_a, "device"_a, "measured_size"_a,
-             "predict_func"_a, "update_func"_a, "tag"_a = "")
+             "predict_func"_a = py::none(), "update_func"_a = py::none(),
+             "tag"_a = "")
         .def("measuredSize", &AutoSchedule::measuredSize)
         .def("set_params", &AutoSchedule::setParams, "args"_a,
              "kws"_a = std::unordered_map<std::string, Ref<Array>>())
-        .def("search_one_round", &AutoSchedule::searchOneRound, "n"_a)
+        .def("set_measure_cores", &AutoSchedule::setMeasureCores, "cores"_a)
+        .def("set_measure_workers", &AutoSchedule::setMeasureWorkers, "n"_a,
+             "timeout"_a = 60, "mem_limit"_a = 0)
+        .def("set_timing_options", &AutoSchedule::setTimingOptions,
+             "options"_a)
+        .def("search_one_round", &AutoSchedule::searchOneRound, "n"_a,
+             py::call_guard<py::gil_scoped_release>())
         .def("gen_features", &AutoSchedule::genFeatures, "schedules"_a)
         .def("test_and_add", &AutoSchedule::testAndAdd, "sketches"_a)
         .def("get_best_schedule", &AutoSchedule::getBestSchedule)
@@ -37,7 +64,12 @@ void init_ffi_auto_schedule(py::module_ &m) {
         .def("test_parallelize", &AutoSchedule::testParallelize)
         .def("get_flop", &AutoSchedule::getFlop)
         .def("get_tag", &AutoSchedule::getTag)
-        .def("get_best_time", &AutoSchedule::getBestTime);
+        .def("get_best_time", &AutoSchedule::getBestTime)
+        .def("get_workload", &AutoSchedule::getWorkload)
+        .def("pop_records", &AutoSchedule::popRecords)
+        .def("apply_record", &AutoSchedule::applyRecord, "record"_a)
+        .def("add_records", &AutoSchedule::addRecords, "records"_a)
+        .def("get_throughput", &AutoSchedule::getThroughput);
 }
 
 } // namespace freetensor
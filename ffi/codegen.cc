@@ -7,7 +7,7 @@ namespace freetensor {
 using namespace pybind11::literals;
 
 void init_ffi_codegen(py::module_ &m) {
-    m.def("code_gen_cpu", &codeGenCPU, "ast"_a);
+    m.def("code_gen_cpu", &codeGenCPU, "ast"_a, "target"_a = nullptr);
     m.def("code_gen_cuda", &codeGenCUDA, "ast"_a);
 }
 
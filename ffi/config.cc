@@ -11,6 +11,8 @@ void init_ffi_config(py::module_ &m) {
     Config::init();
 
     m.def("with_mkl", Config::withMKL, "Check if FreeTensor is built with MKL");
+    m.def("cpu_blas", Config::cpuBLAS,
+          "Library for MatMul on CPU: mkl, openblas, blis or builtin");
     m.def("with_cuda", Config::withCUDA,
           "Check if FreeTensor is built with CUDA");
     m.def("set_pretty_print", Config::setPrettyPrint, "Set colored printing",
@@ -23,6 +25,56 @@ void init_ffi_config(py::module_ &m) {
           "Check if printing IDs of all statements in an AST");
     m.def("set_werror", Config::setWerror, "Error on warning", "flag"_a = true);
     m.def("werror", Config::werror, "Check if error-on-warning enabled");
+    m.def("set_debug_binary", Config::setDebugBinary,
+          "Compile with `-g` at backend. Do not delete the binary file after "
+          "loaded",
+          "flag"_a = true);
+    m.def("debug_binary", Config::debugBinary,
+          "Check if compiling binary in debug mode");
+    m.def("set_compile_cache", Config::setCompileCache,
+          "Reuse binaries compiled by the backend compiler across runs",
+          "flag"_a = true);
+    m.def("compile_cache", Config::compileCache,
+          "Check if the compilation cache is enabled");
+    m.def("set_compile_cache_dir", Config::setCompileCacheDir,
+          "Set where to store the cached binaries", "dir"_a);
+    m.def("compile_cache_dir", Config::compileCacheDir,
+          "Check where the cached binaries are stored");
+    m.def("set_compile_cache_size", Config::setCompileCacheSize,
+          "Set the max total bytes of the cached binaries", "bytes"_a);
+    m.def("compile_cache_size", Config::compileCacheSize,
+          "Check the max total bytes of the cached binaries");
+    m.def("set_backend_compiler_jobs", Config::setBackendCompilerJobs,
+          "Set the max number of concurrent backend compiler processes. 0 = "
+          "number of hardware threads",
+          "n"_a);
+    m.def("backend_compiler_jobs", Config::backendCompilerJobs,
+          "Check the max number of concurrent backend compiler processes");
+    m.def("set_array_alignment", Config::setArrayAlignment,
+          "Set the alignment of Array storage on CPU, in bytes", "bytes"_a);
+    m.def("array_alignment", Config::arrayAlignment,
+          "Check the alignment of Array storage on CPU");
+    m.def("set_array_pool_size", Config::setArrayPoolSize,
+          "Set the max bytes of freed Array storage kept for reuse",
+          "bytes"_a);
+    m.def("array_pool_size", Config::arrayPoolSize,
+          "Check the max bytes of freed Array storage kept for reuse");
+    m.def("set_array_huge_pages", Config::setArrayHugePages,
+          "Back large Array storage on CPU with huge pages", "flag"_a = true);
+    m.def("array_huge_pages", Config::arrayHugePages,
+          "Check if large Array storage is backed with huge pages");
+    m.def("set_array_first_touch", Config::setArrayFirstTouch,
+          "Place new Array storage on CPU on the NUMA nodes of the threads "
+          "using it",
+          "flag"_a = true);
+    m.def("array_first_touch", Config::arrayFirstTouch,
+          "Check if new Array storage is placed by first touch");
+    m.def("compile_cache_hits", Config::compileCacheHits,
+          "Number of binaries loaded from the compilation cache");
+    m.def("compile_cache_misses", Config::compileCacheMisses,
+          "Number of binaries not found in the compilation cache");
+    m.def("reset_compile_cache_stats", Config::resetCompileCacheStats,
+          "Reset the hit and miss counters of the compilation cache");
     m.def("set_default_target", Config::setDefaultTarget,
           "Set default target (internal implementation of `with Target`)",
           "target"_a);
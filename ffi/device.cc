@@ -2,6 +2,7 @@
 
 #include <driver/device.h>
 #include <ffi.h>
+#include <hash_combine.h>
 
 namespace freetensor {
 
@@ -12,6 +13,10 @@ void init_ffi_device(py::module_ &m) {
         .value("CPU", TargetType::CPU)
         .value("GPU", TargetType::GPU);
 
+    py::enum_<ParallelRuntime>(m, "ParallelRuntime")
+        .value("OpenMP", ParallelRuntime::OpenMP)
+        .value("ThreadPool", ParallelRuntime::ThreadPool);
+
     py::class_<Target, Ref<Target>> pyTarget(m, "Target");
     pyTarget
         .def("type", [](const Ref<Target> &target) { return target->type(); })
@@ -31,7 +36,28 @@ void init_ffi_device(py::module_ &m) {
         .def(py::init([](bool useNativeArch) {
                  return Ref<CPU>::make(useNativeArch);
              }),
-             "use_native_arch"_a = true);
+             "use_native_arch"_a = true)
+        .def(
+            "set_vector_bytes",
+            [](const Ref<CPU> &target, int bytes) {
+                target->setVectorBytes(bytes);
+            },
+            "bytes"_a)
+        .def("vector_bytes", &CPU::vectorBytes)
+        .def(
+            "set_parallel_runtime",
+            [](const Ref<CPU> &target, ParallelRuntime runtime) {
+                target->setParallelRuntime(runtime);
+            },
+            "runtime"_a)
+        .def("parallel_runtime", &CPU::parallelRuntime)
+        .def(
+            "set_pin_threads",
+            [](const Ref<CPU> &target, bool flag) {
+                target->setPinThreads(flag);
+            },
+            "flag"_a = true)
+        .def("pin_threads", &CPU::pinThreads);
     py::class_<GPU, Ref<GPU>>(m, "GPU", pyTarget)
         .def(py::init([](bool useNativeArch) {
                  return Ref<GPU>::make(useNativeArch);
@@ -49,8 +75,19 @@ void init_ffi_device(py::module_ &m) {
     py::class_<Device, Ref<Device>>(m, "Device")
         .def(py::init<const Ref<Target> &, size_t>(), "target"_a, "num"_a = 0)
         .def("target", &Device::target)
+        .def("num", &Device::num)
         .def("main_mem_type", &Device::mainMemType)
-        .def("sync", &Device::sync);
+        .def("sync", &Device::sync)
+        .def("__eq__",
+             [](const Ref<Device> &lhs, const Ref<Device> &rhs) {
+                 return *lhs == *rhs;
+             })
+        // Consistent with `__eq__`: equal devices have the same target type
+        // and number
+        .def("__hash__", [](const Ref<Device> &device) {
+            return hashCombine(std::hash<int>()((int)device->type()),
+                               std::hash<size_t>()(device->num()));
+        });
 }
 
 } // namespace freetensor
@@ -2,6 +2,7 @@
 #include <vector>
 
 #include <driver.h>
+#include <driver/measure_worker.h>
 #include <except.h>
 #include <ffi.h>
 
@@ -10,8 +11,85 @@ namespace freetensor {
 using namespace pybind11::literals;
 
 void init_ffi_driver(py::module_ &m) {
+    py::class_<BatchBinary, Ref<BatchBinary>>(m, "BatchBinary")
+        .def(py::init<const std::vector<std::string> &, const Ref<Device> &,
+                      bool>(),
+             "srcs"_a, "device"_a, "async_build"_a = false)
+        .def("__len__", &BatchBinary::size)
+        .def("src", &BatchBinary::src, "i"_a)
+        .def("device", &BatchBinary::device);
+
+    m.def("resident_library_count", &Library::residentCount,
+          "Number of binaries of generated programs currently loaded");
+    m.def("resident_library_bytes", &Library::residentBytes,
+          "Total bytes mapped for binaries of generated programs currently "
+          "loaded");
+
+    py::class_<TimingOptions>(m, "TimingOptions")
+        .def(py::init([](int warmups, int minRounds, int maxRounds,
+                         double maxRelCI, double minRoundTime,
+                         bool flushCache) {
+                 TimingOptions ret;
+                 ret.warmups_ = warmups;
+                 ret.minRounds_ = minRounds;
+                 ret.maxRounds_ = maxRounds;
+                 ret.maxRelCI_ = maxRelCI;
+                 ret.minRoundTime_ = minRoundTime;
+                 ret.flushCache_ = flushCache;
+                 return ret;
+             }),
+             "warmups"_a = 3, "min_rounds"_a = 10, "max_rounds"_a = 10,
+             "max_rel_ci"_a = 0., "min_round_time"_a = 0.,
+             "flush_cache"_a = false)
+        .def_readwrite("warmups", &TimingOptions::warmups_)
+        .def_readwrite("min_rounds", &TimingOptions::minRounds_)
+        .def_readwrite("max_rounds", &TimingOptions::maxRounds_)
+        .def_readwrite("max_rel_ci", &TimingOptions::maxRelCI_)
+        .def_readwrite("min_round_time", &TimingOptions::minRoundTime_)
+        .def_readwrite("flush_cache", &TimingOptions::flushCache_);
+    py::class_<TimingResult>(m, "TimingResult")
+        .def_readonly("mean", &TimingResult::mean_)
+        .def_readonly("median", &TimingResult::median_)
+        .def_readonly("trimmed_mean", &TimingResult::trimmedMean_)
+        .def_readonly("stddev", &TimingResult::stddev_)
+        .def_readonly("rel_ci", &TimingResult::relCI_)
+        .def_readonly("rounds", &TimingResult::rounds_)
+        .def_readonly("repeats", &TimingResult::repeats_);
+
+    // Measure a CPU program in a child process, as `AutoSchedule` does with
+    // measurement workers. For internal use and testing
+    py::class_<MeasureWorker>(m, "MeasureWorker")
+        .def(py::init([](double timeout, size_t memLimit) {
+                 MeasureWorkerOptions options;
+                 options.timeout_ = timeout;
+                 options.memLimit_ = memLimit;
+                 return std::make_unique<MeasureWorker>(options);
+             }),
+             "timeout"_a = 60, "mem_limit"_a = 0)
+        .def(
+            "time",
+            [](MeasureWorker &worker, const Func &func, const std::string &src,
+               const std::vector<Ref<Array>> &args,
+               const std::unordered_map<std::string, Ref<Array>> &kws,
+               const TimingOptions &options) {
+                auto device = Ref<Device>::make(Ref<CPU>::make());
+                auto image = Ref<MeasureImage>::make(
+                    Driver::buildImage(src, device).first);
+                return worker.time(image, "run",
+                                   MeasureArgs::pack(func, args, kws),
+                                   func->returns_.size(), options);
+            },
+            "func"_a, "src"_a, "args"_a,
+            "kws"_a = std::unordered_map<std::string, Ref<Array>>(),
+            "options"_a = TimingOptions(),
+            py::call_guard<py::gil_scoped_release>());
+
     py::class_<Driver, Ref<Driver>>(m, "Driver")
-        .def(py::init<const Func &, const std::string &, const Ref<Device> &>())
+        .def(py::init<const Func &, const std::string &, const Ref<Device> &,
+                      bool>(),
+             "func"_a, "src"_a, "device"_a, "async_build"_a = false)
+        .def(py::init<const Func &, const Ref<BatchBinary> &, size_t>(),
+             "func"_a, "batch"_a, "index"_a)
         .def("set_args",
              static_cast<void (Driver::*)(
                  const std::vector<Ref<Array>> &,
@@ -23,10 +101,24 @@ void init_ffi_driver(py::module_ &m) {
                  const std::unordered_map<std::string, Ref<Array>> &)>(
                  &Driver::setArgs),
              "kws"_a)
+        .def("wait", &Driver::wait,
+             py::call_guard<py::gil_scoped_release>())
+        .def("is_ready", &Driver::isReady)
+        .def("compile_time", &Driver::compileTime,
+             py::call_guard<py::gil_scoped_release>())
         .def("run", &Driver::run)
         .def("sync", &Driver::sync)
         .def("collect_returns", &Driver::collectReturns)
-        .def("time", &Driver::time, "rounds"_a = 10, "warmpups"_a = 3);
+        .def("time", &Driver::time, "rounds"_a = 10, "warmpups"_a = 3)
+        .def("benchmark", &Driver::benchmark,
+             "options"_a = TimingOptions())
+        .def("prepare", &Driver::prepare, "args"_a,
+             "kws"_a = std::unordered_map<std::string, Ref<Array>>(),
+             py::keep_alive<0, 1>());
+
+    py::class_<BoundCall>(m, "BoundCall")
+        .def("__len__", &BoundCall::size)
+        .def("__call__", &BoundCall::operator(), "args"_a);
 }
 
 } // namespace freetensor
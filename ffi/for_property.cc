@@ -26,6 +26,7 @@ void init_ffi_for_property(py::module_ &m) {
         .def_readonly("vectorize", &ForProperty::vectorize_)
         .def_readonly("no_deps", &ForProperty::noDeps_)
         .def_readonly("prefer_libs", &ForProperty::preferLibs_)
+        .def_readonly("streaming_stores", &ForProperty::streamingStores_)
         .def_property_readonly(
             "reductions",
             [](const Ref<ForProperty> &p) -> std::vector<Ref<ReductionItem>> {
@@ -36,7 +37,9 @@ void init_ffi_for_property(py::module_ &m) {
         .def("with_vectorize", &ForProperty::withVectorize,
              "vectorize"_a = true)
         .def("with_no_deps", &ForProperty::withNoDeps, "var"_a)
-        .def("with_prefer_libs", &ForProperty::withPreferLibs, "prefer_libs"_a);
+        .def("with_prefer_libs", &ForProperty::withPreferLibs, "prefer_libs"_a)
+        .def("with_streaming_stores", &ForProperty::withStreamingStores,
+             "vars"_a);
 }
 
 } // namespace freetensor
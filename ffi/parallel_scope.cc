@@ -3,6 +3,8 @@
 
 namespace freetensor {
 
+using namespace pybind11::literals;
+
 void init_ffi_parallel_scope(py::module_ &m) {
     py::class_<SerialScope>(m, "SerialScope")
         .def(py::init<>())
@@ -12,8 +14,19 @@ void init_ffi_parallel_scope(py::module_ &m) {
             return lhs == rhs;
         });
 
+    py::enum_<OpenMPScope::Kind>(m, "OpenMPScopeKind")
+        .value("Static", OpenMPScope::Kind::Static)
+        .value("Dynamic", OpenMPScope::Kind::Dynamic)
+        .value("Guided", OpenMPScope::Kind::Guided)
+        .value("TaskLoop", OpenMPScope::Kind::TaskLoop);
     py::class_<OpenMPScope>(m, "OpenMPScope")
         .def(py::init<>())
+        .def(py::init([](const OpenMPScope::Kind &kind, int chunk) {
+                 return OpenMPScope{kind, chunk};
+             }),
+             "kind"_a, "chunk"_a = 0)
+        .def_readonly("kind", &OpenMPScope::kind_)
+        .def_readonly("chunk", &OpenMPScope::chunk_)
         .def("__str__",
              [](const OpenMPScope &scope) { return toString(scope); })
         .def("__eq__", [](const OpenMPScope &lhs, const OpenMPScope &rhs) {
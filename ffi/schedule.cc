@@ -63,15 +63,19 @@ void init_ffi_schedule(py::module_ &m) {
         .def("parallelize", &Schedule::parallelize, "loop"_a, "parallel"_a)
         .def("unroll", &Schedule::unroll, "loop"_a, "immedate"_a = false)
         .def("vectorize", &Schedule::vectorize, "loop"_a)
+        .def("streaming_store", &Schedule::streamingStore, "loop"_a, "var"_a)
         .def("separate_tail", &Schedule::separateTail,
              "noDuplicateVarDefs"_a = false)
         .def("as_matmul", &Schedule::asMatMul)
+        .def("as_blocked_matmul", &Schedule::asBlockedMatMul, "loop"_a,
+             "target"_a)
         .def("auto_schedule", &Schedule::autoSchedule)
         .def("auto_use_lib", &Schedule::autoUseLib)
         .def("auto_fuse", &Schedule::autoFuse)
         .def("auto_parallelize", &Schedule::autoParallelize)
         .def("auto_set_mem_type", &Schedule::autoSetMemType)
-        .def("auto_unroll", &Schedule::autoUnroll);
+        .def("auto_unroll", &Schedule::autoUnroll)
+        .def("auto_streaming_store", &Schedule::autoStreamingStore);
 }
 
 } // namespace freetensor
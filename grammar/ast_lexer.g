@@ -34,6 +34,7 @@ REDUCTION:  '@!reduction';
 UNROLL:     '@!unroll';
 VECTORIZE:  '@!vectorize';
 PREFERLIBS: '@!prefer_libs';
+STREAMING_STORES: '@!streaming_stores';
 
 TRUE:       'true';
 FALSE:      'false';
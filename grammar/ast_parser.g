@@ -237,6 +237,11 @@ forProperty returns [Ref<ForProperty> property]
       {
         $property = $prev.property->withPreferLibs();
       }
+    | prev=forProperty STREAMING_STORES ':' var { std::vector<std::string> streamingStores = {$var.name}; }
+        (',' var2=var { streamingStores.emplace_back($var2.name); })*
+      {
+        $property = $prev.property->withStreamingStores(std::move(streamingStores));
+      }
     | prev=forProperty UNROLL
       {
         $property = $prev.property->withUnroll();
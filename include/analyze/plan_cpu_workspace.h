@@ -0,0 +1,75 @@
+#ifndef FREE_TENSOR_PLAN_CPU_WORKSPACE_H
+#define FREE_TENSOR_PLAN_CPU_WORKSPACE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <visitor.h>
+
+namespace freetensor {
+
+struct WorkspacePlan {
+    std::unordered_map<ID, size_t> offsets_; /// VarDef ID -> offset in bytes
+    size_t size_ = 0;                        /// Total bytes of the workspace
+};
+
+class FindWorkspaceLiveRanges : public Visitor {
+  public:
+    struct Candidate {
+        ID id_;
+        size_t size_;
+        size_t begin_ = SIZE_MAX, end_ = 0; /// Inclusive timestamps
+    };
+
+  private:
+    size_t minSize_;
+    size_t now_ = 0;
+    bool inParallel_ = false;
+    std::vector<Candidate> candidates_;
+    std::unordered_map<std::string, std::vector<int>>
+        nameToCandidate_; /// -1 for a VarDef not planned
+    std::unordered_map<int, size_t> defDepth_; /// Candidate -> depth in loops_
+    std::vector<std::pair<For, size_t>> loops_; /// (loop, begin timestamp)
+    std::unordered_map<ID, std::vector<int>>
+        extendToLoopEnd_; /// For ID -> candidates
+
+  public:
+    FindWorkspaceLiveRanges(size_t minSize) : minSize_(minSize) {}
+
+    const std::vector<Candidate> &candidates() const { return candidates_; }
+
+  private:
+    void access(const std::string &var);
+
+  protected:
+    void visitStmt(const Stmt &op) override;
+    void visit(const VarDef &op) override;
+    void visit(const For &op) override;
+    void visit(const Load &op) override;
+    void visit(const Store &op) override;
+    void visit(const ReduceTo &op) override;
+};
+
+/**
+ * Plan local (`AccessType::Cache`) CPU buffers into one workspace
+ *
+ * A buffer is planned if it has a constant size of at least `minSize` bytes,
+ * and is not defined inside an OpenMP parallel loop, where each thread needs
+ * its own copy. The live range of a buffer spans from its first access to its
+ * last access. If a buffer is accessed in a loop inside its scope, the live
+ * range covers the whole loop, since the value may be carried across
+ * iterations. Buffers with disjoint live ranges then share space, by assigning
+ * offsets greedily in decreasing order of size
+ *
+ * @param op : The lowered program
+ * @param minSize : Smaller buffers are left to the backend compiler, which may
+ * promote them to registers
+ * @param align : Alignment of each buffer in the workspace, in bytes
+ */
+WorkspacePlan planCPUWorkspace(const Stmt &op, size_t minSize = 4096,
+                               size_t align = 64);
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_PLAN_CPU_WORKSPACE_H
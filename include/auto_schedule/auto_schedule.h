@@ -1,12 +1,17 @@
 #ifndef FREE_TENSOR_AUTO_SCHEDULE_H
 #define FREE_TENSOR_AUTO_SCHEDULE_H
 
+#include <auto_schedule/cost_model.h>
+#include <auto_schedule/measure_pipeline.h>
 #include <auto_schedule/rule.h>
 #include <auto_schedule/sketch.h>
+#include <chrono>
 #include <driver/array.h>
 #include <driver/device.h>
 #include <driver/target.h>
 #include <functional>
+#include <future>
+#include <memory>
 #include <random>
 #include <schedule.h>
 #include <set>
@@ -21,6 +26,17 @@ constexpr double EVOLUTIONARY_SEARCH_CROSSOVER_PROB = 0.3;
 
 constexpr double INIT_RAND_RATIO = 0.7;
 
+/**
+ * A measured program, to be saved in a tuning log and loaded in later runs
+ */
+struct TuningRecord {
+    std::string sketch_;            /// `Sketch::structure()`
+    std::vector<int> annotation_;   /// `Sketch::getAnnotation()`
+    std::vector<std::string> logs_; /// Schedules applied to the program
+    std::vector<double> feature_;   /// Input of the cost model
+    double time_;                   /// In ms, or 1e30 if failed
+};
+
 class AutoSchedule {
   public:
     typedef std::vector<std::vector<double>> Features;
@@ -40,26 +56,135 @@ class AutoSchedule {
     std::default_random_engine randGen_;
     std::function<Predicts(const Features &)> predictFunc_;
     std::function<void(const Features &, const Predicts &)> updateFunc_;
+    CostModel costModel_; /// Used if `predictFunc_` and `updateFunc_` are empty
     std::vector<Ref<Rule>> rules_;
     double flop_;
     std::string tag_;
+    std::unique_ptr<MeasurePipeline> pipeline_;
+    std::vector<int> measureCores_;
+    size_t nMeasureWorkers_ = 0; /// 0 for measuring in this process
+    MeasureWorkerOptions measureWorkerOptions_;
+    Ref<MeasureArgs> measureArgs_; /// `args_` and `kws_` packed for workers
+    TimingOptions timingOptions_;  /// How to measure each program
+    std::vector<TuningRecord> newRecords_; /// Not taken by `popRecords` yet
+    size_t nMeasured_ = 0; /// Number of measured programs, for the throughput
+    std::chrono::steady_clock::time_point
+        tuneBegin_; /// When the first program is submitted for measuring
+
+    /**
+     * Programs submitted for measuring, whose results are not collected yet
+     */
+    struct PendingTest {
+        std::vector<Ref<Sketch>> sketches_;
+        Features features_;
+        std::vector<std::future<double>> times_;
+    };
 
   private:
-    std::vector<double> measure(std::vector<Ref<Sketch>> &sketches);
+    /**
+     * Compile the programs in the background, and queue them to be measured
+     * in the measurement thread as soon as each of them is compiled
+     *
+     * @return : One future for the time of each program
+     */
+    std::vector<std::future<double>>
+    measure(std::vector<Ref<Sketch>> &sketches);
+
+    /**
+     * `measure` in `MeasureWorker`s. The binaries are built but not loaded in
+     * this process
+     */
+    std::vector<std::future<double>>
+    measureInWorkers(std::vector<Ref<Sketch>> &sketches);
+
+    /**
+     * Generate code and features of the programs, and submit them for
+     * measuring. This returns without waiting for the measurement, so the
+     * caller can prepare the next batch in the meantime
+     */
+    PendingTest submitTest(std::vector<Ref<Sketch>> &sketches_in);
+
+    /**
+     * Wait for the measurement, update the cost model, and record the
+     * measured programs
+     */
+    std::vector<double> finishTest(PendingTest &&pending);
+
+    /**
+     * Add a program to `measuredSketches_`, which should be a max-heap of the
+     * time, if it is one of the best `measuredSize_` ones
+     */
+    void pushMeasured(const Ref<Sketch> &sketch, double time);
+
+    /**
+     * Train the cost model with successfully measured programs
+     */
+    void updateModel(const Features &features, const Predicts &flops);
+
+    /**
+     * Re-create the program of a record from the sketches of this program
+     *
+     * @return : The program, or nullptr if the record does not match any sketch
+     */
+    Ref<Sketch> restoreSketch(const TuningRecord &record);
 
   public:
-    AutoSchedule(const Schedule &schedule, const Ref<Target> &target,
-                 const Ref<Device> &device, int measuredSize,
-                 const std::function<Predicts(const Features &)> &predictFunc,
-                 const std::function<void(const Features &, const Predicts &)>
-                     &updateFunc,
-                 std::string tag = "");
+    /**
+     * @param predictFunc, updateFunc : Predict the throughput of programs from
+     * their features, and train with measured ones, in place of the built-in
+     * `CostModel`. Leave them empty to use the built-in one
+     */
+    AutoSchedule(
+        const Schedule &schedule, const Ref<Target> &target,
+        const Ref<Device> &device, int measuredSize,
+        const std::function<Predicts(const Features &)> &predictFunc = nullptr,
+        const std::function<void(const Features &, const Predicts &)>
+            &updateFunc = nullptr,
+        std::string tag = "");
 
     size_t measuredSize() const { return measuredSize_; }
 
     void setParams(const std::vector<Ref<Array>> &args,
                    const std::unordered_map<std::string, Ref<Array>> &kws);
 
+    /**
+     * Pin the measurement thread to some cores, which should be kept away from
+     * other work, e.g. by `isolcpus`
+     *
+     * @param cores : IDs of the cores. Empty for not pinning
+     */
+    void setMeasureCores(const std::vector<int> &cores);
+
+    /**
+     * Measure the programs in child processes, so a crashing or hanging
+     * program is recorded as a failed one instead of bringing the tuning down.
+     * Only for CPU
+     *
+     * @param n : Number of worker processes measuring concurrently. They share
+     * the cores set by `setMeasureCores` evenly. 0 for measuring in this
+     * process
+     * @param timeout : Max seconds to measure one program
+     * @param memLimit : Max bytes of the address space of a worker. 0 for
+     * unlimited
+     */
+    void setMeasureWorkers(size_t n, double timeout = 60, size_t memLimit = 0);
+
+    /**
+     * Set how to measure each program
+     *
+     * By default, a program is measured for 5 to 50 rounds of at least 1 ms
+     * each, until the 95% confidence interval of the time is within 2% of it.
+     * The median time over the rounds is used for ranking the programs
+     */
+    void setTimingOptions(const TimingOptions &options) {
+        timingOptions_ = options;
+    }
+
+    /**
+     * Number of measured programs per hour since the first measurement
+     */
+    double getThroughput() const;
+
     void searchOneRound(size_t n);
 
     std::vector<Ref<Sketch>> evolutionarySearch(std::vector<Ref<Sketch>> init,
@@ -79,6 +204,35 @@ class AutoSchedule {
     Schedule getBestSchedule();
     double getBestTime();
 
+    /**
+     * A key of the program being tuned, to tell which records in a tuning log
+     * belong to it
+     */
+    std::string getWorkload() const;
+
+    /**
+     * Take the records of the programs measured since the last call, to be
+     * appended to a tuning log
+     */
+    std::vector<TuningRecord> popRecords();
+
+    /**
+     * Apply the schedules of a record to the original program, without
+     * searching or measuring
+     *
+     * Throws an `InvalidSchedule` if the record does not match the program
+     */
+    Schedule applyRecord(const TuningRecord &record);
+
+    /**
+     * Warm-start the search from records of previous runs
+     *
+     * The programs of the records are added to the population as if measured
+     * in this run, and the cost model is updated with their features and
+     * times. Records not matching the program are ignored
+     */
+    void addRecords(const std::vector<TuningRecord> &records);
+
     double getFlop() { return flop_; }
     std::string getTag() { return tag_; }
 
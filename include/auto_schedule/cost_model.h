@@ -0,0 +1,100 @@
+#ifndef FREE_TENSOR_COST_MODEL_H
+#define FREE_TENSOR_COST_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace freetensor {
+
+struct CostModelOptions {
+    int treesPerUpdate_ = 10;   /// Trees grown in each `update`
+    int maxDepth_ = 6;          /// Max depth of each tree
+    double learningRate_ = 0.3; /// Shrinkage of each tree
+    double lambda_ = 1;         /// L2 regularization of the leaf values
+    size_t minLeaf_ = 2;        /// Min samples in a leaf
+    int nBins_ = 64;            /// Max buckets of each feature, <= 256
+    size_t maxSamples_ = 16384; /// Keep only this amount of latest samples
+    int maxTrees_ = 300;        /// Refit from scratch beyond this many trees
+};
+
+/**
+ * A gradient-boosted regression tree model, to predict the throughput of
+ * programs from their `fixedLengthFeature`s, natively in place of a Python
+ * callback
+ *
+ * The model fits the logarithm of the throughput with squared errors, so it is
+ * not biased by the scale of the workload. It is trained incrementally, as
+ * continued boosting does: each `update` adds its samples to the training set,
+ * and grows some more trees on the residuals of all the samples, without
+ * re-training the existing trees. Once there would be more than `maxTrees_`
+ * trees, the model is refitted from scratch on the kept samples, with half of
+ * that many trees, so the cost of `predict` stays bounded, and trees fitted on
+ * dropped samples go away. Splits are found on histograms, with each
+ * feature bucketed by the quantiles of the training set. A feature of -1
+ * (unknown) is just a value less than any known one
+ *
+ * `predict` is parallelized with OpenMP, and can be called from multiple
+ * threads, but not during `update`
+ */
+class CostModel {
+  public:
+    typedef std::vector<std::vector<double>> Features;
+    typedef std::vector<double> Predicts;
+
+  private:
+    struct Node {
+        int feature_ = -1; /// -1 for a leaf
+        double threshold_ = 0;
+        int left_ = -1, right_ = -1; /// Go left if feature <= threshold
+        double value_ = 0;           /// Output of a leaf
+    };
+    typedef std::vector<Node> Tree; /// The root is at 0
+
+    CostModelOptions options_;
+    std::vector<Tree> trees_;
+    double base_ = 0; /// Initial prediction, in log scale
+
+    Features samples_;
+    std::vector<double> labels_; /// Log of the throughput
+    std::vector<double> preds_;  /// Current predictions of the samples
+
+  private:
+    static double eval(const Tree &tree, const std::vector<double> &feature);
+    double predictLog(const std::vector<double> &feature) const;
+
+    /**
+     * Grow a tree on the residuals of the samples
+     *
+     * @param cuts : Bucket boundaries of each feature. A value `x` is in bucket
+     * `b` if `cuts[b - 1] < x <= cuts[b]`
+     * @param bins : Bucket of each feature of each sample, row-major
+     */
+    Tree grow(const std::vector<std::vector<double>> &cuts,
+              const std::vector<uint8_t> &bins) const;
+
+  public:
+    CostModel(const CostModelOptions &options = {}) : options_(options) {}
+
+    /**
+     * Whether there are any trees. An untrained model predicts 1 for all
+     */
+    bool trained() const { return !trees_.empty(); }
+
+    /**
+     * Predict the throughput of programs
+     */
+    Predicts predict(const Features &features) const;
+
+    /**
+     * Train with more measured programs
+     *
+     * @param features : Features of the programs
+     * @param flops : Throughput of the programs. Non-positive ones are ignored
+     */
+    void update(const Features &features, const Predicts &flops);
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_COST_MODEL_H
@@ -0,0 +1,69 @@
+#ifndef FREE_TENSOR_MEASURE_PIPELINE_H
+#define FREE_TENSOR_MEASURE_PIPELINE_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <driver/measure_worker.h>
+
+namespace freetensor {
+
+/**
+ * Dedicated threads to measure programs, in the order they are submitted
+ *
+ * Programs are compiled by other threads (see `BuildPool`), and each
+ * measurement job waits for its program before timing it. So programs compiled
+ * later are still being compiled when earlier ones are being measured
+ *
+ * By default, there is one thread measuring programs one by one in this
+ * process. Alternatively, each thread can drive a `MeasureWorker` process, so a
+ * crashing or hanging program does not bring down the caller. There are then as
+ * many threads as the workers, measuring programs concurrently
+ *
+ * The threads can be pinned to some cores, to keep the measurement away from
+ * the compilers. With multiple workers, the cores are evenly split among them.
+ * OpenMP threads started by the measured programs inherit the pinning, and
+ * there are as many of them as the cores
+ */
+class MeasurePipeline {
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void(MeasureWorker *)>> jobs_;
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+  public:
+    /**
+     * @param cores : IDs of the cores to pin the measurement threads to. Empty
+     * for not pinning
+     * @param nWorkers : Number of `MeasureWorker` processes. 0 for measuring in
+     * this process
+     * @param options : Timeout and resource limits of the workers
+     */
+    MeasurePipeline(const std::vector<int> &cores = {}, size_t nWorkers = 0,
+                    const MeasureWorkerOptions &options = {});
+    ~MeasurePipeline();
+
+    MeasurePipeline(const MeasurePipeline &) = delete;
+    MeasurePipeline &operator=(const MeasurePipeline &) = delete;
+
+    /**
+     * Measure a program in a measurement thread
+     *
+     * @param job : Returns the time of the program. It is given the worker of
+     * the thread, or nullptr if measuring in this process. It is started after
+     * all previously submitted jobs are started
+     * @return : A future for the time. Any exception thrown by the job is
+     * rethrown when getting the result
+     */
+    std::future<double> submit(std::function<double(MeasureWorker *)> job);
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_MEASURE_PIPELINE_H
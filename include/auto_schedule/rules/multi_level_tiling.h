@@ -48,6 +48,11 @@ class MultiLevelTilingPart : public SketchPartNode {
     bool crossover(const SketchPart &part,
                    std::default_random_engine &gen) override;
     [[nodiscard]] std::vector<int> getAnnotation() const override;
+    [[nodiscard]] size_t annotationSize() const override {
+        return target_.spaceLoops.size() * spaceLoopTimes_ +
+               target_.reductionLoops.size() * reductionLoopTimes_;
+    }
+    void setAnnotation(const std::vector<int> &annotation) override;
     size_t spaceLoopLength() const { return target_.spaceLoops.size(); }
     size_t frontSpaceLoopTimes() const { return frontSpaceLoopTimes_; }
     [[nodiscard]] size_t hash() const override;
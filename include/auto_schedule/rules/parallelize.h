@@ -15,11 +15,16 @@ class ParallelizeRule : public Rule {
 class ParallelizePart : public SketchPartNode {
 
   public:
+    /// OpenMP schedules to explore. The first one is the default
+    static const std::vector<OpenMPScope> candidateScopes_;
+
     int maxSize_;
     int parallelSize_;
+    int scopeIdx_; /// Index in `candidateScopes_`
     ID lastParallelizedID_{};
-    ParallelizePart(size_t maxSize, size_t parallelSize = 0)
-        : maxSize_(maxSize), parallelSize_(parallelSize) {}
+    ParallelizePart(size_t maxSize, size_t parallelSize = 0, int scopeIdx = 0)
+        : maxSize_(maxSize), parallelSize_(parallelSize), scopeIdx_(scopeIdx) {
+    }
     void genRandAnnotation(std::default_random_engine &gen) override;
     bool mutate(std::default_random_engine &gen) override;
     bool crossover(const SketchPart &part,
@@ -27,14 +32,20 @@ class ParallelizePart : public SketchPartNode {
     void apply(Schedule &schedule, SketchTarget &target) override;
     SketchPartType partType() override { return SketchPartType::Parallelize; }
     [[nodiscard]] std::vector<int> getAnnotation() const override {
-        return {parallelSize_};
+        return {parallelSize_, scopeIdx_};
     };
+    [[nodiscard]] size_t annotationSize() const override { return 2; }
+    void setAnnotation(const std::vector<int> &annotation) override {
+        parallelSize_ = annotation.at(0);
+        scopeIdx_ = annotation.at(1);
+    }
     [[nodiscard]] size_t hash() const override {
-        return hashCombine(std::hash<std::string>{}("parallelize"),
-                           std::hash<int>{}(parallelSize_));
+        return hashCombine(hashCombine(std::hash<std::string>{}("parallelize"),
+                                       std::hash<int>{}(parallelSize_)),
+                           std::hash<int>{}(scopeIdx_));
     }
     [[nodiscard]] SketchPart clone() const override {
-        return Ref<ParallelizePart>::make(maxSize_, parallelSize_);
+        return Ref<ParallelizePart>::make(maxSize_, parallelSize_, scopeIdx_);
     };
 };
 
@@ -21,6 +21,8 @@ class ThreadBindPart : public SketchPartNode {
     [[nodiscard]] std::vector<int> getAnnotation() const override {
         return {};
     };
+    [[nodiscard]] size_t annotationSize() const override { return 0; }
+    void setAnnotation(const std::vector<int> &) override {}
     [[nodiscard]] size_t hash() const override {
         return std::hash<std::string>{}("thread bind");
     }
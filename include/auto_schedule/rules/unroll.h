@@ -30,6 +30,10 @@ class UnrollPart : public SketchPartNode {
     [[nodiscard]] std::vector<int> getAnnotation() const override {
         return {maxSize_};
     };
+    [[nodiscard]] size_t annotationSize() const override { return 1; }
+    void setAnnotation(const std::vector<int> &annotation) override {
+        maxSize_ = annotation.at(0);
+    }
     [[nodiscard]] size_t hash() const override {
         return hashCombine(std::hash<std::string>{}("unroll"),
                            std::hash<int>{}(maxSize_));
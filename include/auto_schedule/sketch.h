@@ -35,6 +35,17 @@ class SketchPartNode {
     virtual void apply(Schedule &schedule, SketchTarget &target) = 0;
     virtual SketchPartType partType() = 0;
     virtual std::vector<int> getAnnotation() const = 0;
+
+    /**
+     * Number of values in `getAnnotation`, determined by the sketch itself
+     */
+    virtual size_t annotationSize() const = 0;
+
+    /**
+     * Restore an annotation from the values of `getAnnotation`, e.g., from a
+     * tuning record. There must be `annotationSize()` values
+     */
+    virtual void setAnnotation(const std::vector<int> &annotation) = 0;
     virtual ~SketchPartNode() = default;
     virtual size_t hash() const = 0;
     virtual SketchPart clone() const = 0;
@@ -120,6 +131,20 @@ class Sketch {
 
     std::vector<int> getAnnotation() const;
 
+    /**
+     * Restore the annotations of all parts from `getAnnotation` of a sketch of
+     * the same `structure`
+     *
+     * @return : false if the number of values does not match
+     */
+    bool setAnnotation(const std::vector<int> &annotation);
+
+    /**
+     * The rules applied to generate this sketch, without the annotations. It
+     * identifies one of the sketches generated from a program
+     */
+    std::string structure() const;
+
     [[nodiscard]] std::pair<bool, Sketch>
     genMutation(std::default_random_engine &gen) const;
 
@@ -3,24 +3,74 @@
 
 #include <unordered_set>
 
+#include <analyze/plan_cpu_workspace.h>
 #include <codegen/code_gen_c.h>
+#include <driver/target.h>
 #include <func.h>
 
 namespace freetensor {
 
 class CodeGenCPU : public CodeGenC<CodeGenStream> {
     bool inParallel_ = false;
+    Expr parallelLen_; /// Trip count of the innermost OpenMP loop, including
+                       /// the loops collapsed into it
+    bool nestedBLAS_ = false; /// Any BLAS call using threads inside an OpenMP
+                              /// loop
+    bool useThreadPool_ = false;  /// Run OpenMP loops with our thread pool
+    bool usedThreadPool_ = false; /// Any loop is run with our thread pool
+    bool pinThreads_ = false;     /// Bind threads of parallel loops to cores
     int64_t sharedStackTop_ = 8192 * 1024, sharedStackSize_ = 0;
     int64_t threadStackTop_ = 0, threadStackSize_ = 0;
     std::unordered_set<For> collapsed_;
+    WorkspacePlan workspace_;
+    std::unordered_multiset<std::string> streaming_; /// Variables written
+                                                     /// with streaming stores
+    bool needStreamFence_ = false; /// Streaming stores in a collapsed loop are
+                                   /// not fenced yet
 
   public:
     CodeGenCPU(const std::vector<FuncParam> &params,
-               const std::vector<FuncRet> &returns)
-        : CodeGenC(params, returns) {}
+               const std::vector<FuncRet> &returns,
+               const WorkspacePlan &workspace = {},
+               const Ref<CPU> &target = nullptr)
+        : CodeGenC(params, returns), workspace_(workspace) {
+        if (target.isValid()) {
+            useThreadPool_ =
+                target->parallelRuntime() == ParallelRuntime::ThreadPool;
+            pinThreads_ = target->pinThreads();
+        }
+    }
 
     int64_t sharedStackSize() const { return sharedStackSize_; }
     int64_t threadStackSize() const { return threadStackSize_; }
+    size_t workspaceSize() const { return workspace_.size_; }
+    bool nestedBLAS() const { return nestedBLAS_; }
+    bool usedThreadPool() const { return usedThreadPool_; }
+    bool pinThreads() const { return pinThreads_; }
+
+  private:
+    /**
+     * Allocate a local array from the heap through the context, instead of
+     * from the stack
+     */
+    void genHeapLocal(const VarDef &op);
+
+    /**
+     * Place a local array at its planned offset in the workspace
+     */
+    void genWorkspaceLocal(const VarDef &op, size_t offset);
+
+    /**
+     * Run an OpenMP loop with `ThreadPool::parallelFor` in the runtime.
+     * Reductions are done on private buffers of each chunk, which are combined
+     * into the shared one at the end of the chunk
+     */
+    void genThreadPoolFor(const For &op);
+
+    /**
+     * Generate a loop without the fence for its streaming stores
+     */
+    void genFor(const For &op);
 
   protected:
     void genAlloc(const Ref<Tensor> &tensor, const std::string &rawPtr,
@@ -29,6 +79,7 @@ class CodeGenCPU : public CodeGenC<CodeGenStream> {
 
     using CodeGenC<CodeGenStream>::visit;
     void visit(const VarDef &op) override;
+    void visit(const Store &op) override;
     void visit(const ReduceTo &op) override;
     void visit(const For &op) override;
     void visit(const MatMul &op) override;
@@ -37,9 +88,12 @@ class CodeGenCPU : public CodeGenC<CodeGenStream> {
 /**
  * Generate target function code
  *
+ * @param target : Options of the target (e.g. the parallel runtime) are
+ * respected if set
+ *
  * @return : source
  */
-std::string codeGenCPU(const Func &func);
+std::string codeGenCPU(const Func &func, const Ref<CPU> &target = nullptr);
 
 } // namespace freetensor
 
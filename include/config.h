@@ -1,6 +1,7 @@
 #ifndef FREE_TENSOR_CONFIG_H
 #define FREE_TENSOR_CONFIG_H
 
+#include <atomic>
 #include <string>
 
 #include <ref.h>
@@ -22,6 +23,29 @@ class Config {
     static bool
         debugBinary_; /// Compile with `-g` at backend. Do not delete the binary
                       /// file after loaded. Env FT_DEBUG_BINARY
+    static bool compileCache_; /// Reuse compiled binaries across runs. Env
+                               /// FT_COMPILE_CACHE
+    static std::string
+        compileCacheDir_; /// Where to store the cached binaries. Env
+                          /// FT_COMPILE_CACHE_DIR. Defaults to
+                          /// ~/.freetensor/cache
+    static size_t compileCacheSize_; /// Max total bytes of cached binaries.
+                                     /// Env FT_COMPILE_CACHE_SIZE
+    static size_t backendCompilerJobs_; /// Max number of concurrent backend
+                                        /// compiler processes. 0 = number of
+                                        /// hardware threads. Env
+                                        /// FT_BACKEND_COMPILER_JOBS
+    static size_t arrayAlignment_; /// Alignment of Array storage on CPU, in
+                                   /// bytes. Env FT_ARRAY_ALIGNMENT
+    static size_t arrayPoolSize_;  /// Max bytes of freed Array storage kept
+                                   /// for reuse. Env FT_ARRAY_POOL_SIZE
+    static bool arrayHugePages_;   /// Back large Array storage with huge pages.
+                                   /// Env FT_ARRAY_HUGE_PAGES
+    static bool arrayFirstTouch_;  /// Place new Array storage on NUMA nodes of
+                                   /// the threads using it. Env
+                                   /// FT_ARRAY_FIRST_TOUCH
+    static std::atomic<size_t> compileCacheHits_,
+        compileCacheMisses_; /// Statistics of the compilation cache
     static Ref<Target> defaultTarget_; /// Used for lower and codegen when
                                        /// target is omitted. Initialized to CPU
     static Ref<Device>
@@ -32,6 +56,9 @@ class Config {
     static void init(); /// Called in src/ffi/config.cc
 
     static std::string withMKL();
+
+    /// Library for MatMul on CPU: "mkl", "openblas", "blis" or "builtin"
+    static std::string cpuBLAS();
     static bool withCUDA();
 
     static void setPrettyPrint(bool pretty = true) { prettyPrint_ = pretty; }
@@ -46,6 +73,45 @@ class Config {
     static void setDebugBinary(bool flag = true) { debugBinary_ = flag; }
     static bool debugBinary() { return debugBinary_; }
 
+    static void setCompileCache(bool flag = true) { compileCache_ = flag; }
+    static bool compileCache() { return compileCache_; }
+
+    static void setCompileCacheDir(const std::string &dir) {
+        compileCacheDir_ = dir;
+    }
+    static const std::string &compileCacheDir() { return compileCacheDir_; }
+
+    static void setCompileCacheSize(size_t bytes) {
+        compileCacheSize_ = bytes;
+    }
+    static size_t compileCacheSize() { return compileCacheSize_; }
+
+    static void setBackendCompilerJobs(size_t n) { backendCompilerJobs_ = n; }
+    static size_t backendCompilerJobs() { return backendCompilerJobs_; }
+
+    static void setArrayAlignment(size_t bytes);
+    static size_t arrayAlignment() { return arrayAlignment_; }
+
+    static void setArrayPoolSize(size_t bytes) { arrayPoolSize_ = bytes; }
+    static size_t arrayPoolSize() { return arrayPoolSize_; }
+
+    static void setArrayHugePages(bool flag = true) { arrayHugePages_ = flag; }
+    static bool arrayHugePages() { return arrayHugePages_; }
+
+    static void setArrayFirstTouch(bool flag = true) {
+        arrayFirstTouch_ = flag;
+    }
+    static bool arrayFirstTouch() { return arrayFirstTouch_; }
+
+    static void countCompileCacheHit() { compileCacheHits_++; }
+    static void countCompileCacheMiss() { compileCacheMisses_++; }
+    static size_t compileCacheHits() { return compileCacheHits_; }
+    static size_t compileCacheMisses() { return compileCacheMisses_; }
+    static void resetCompileCacheStats() {
+        compileCacheHits_ = 0;
+        compileCacheMisses_ = 0;
+    }
+
     static void setDefaultTarget(const Ref<Target> &target) {
         defaultTarget_ = target;
     }
@@ -1,28 +1,89 @@
 #ifndef FREE_TENSOR_DRIVER_H
 #define FREE_TENSOR_DRIVER_H
 
+#include <functional>
+#include <future>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <driver/array.h>
+#include <driver/library.h>
 #include <func.h>
 
 #include <../runtime/cpu_context.h>
+#include <../runtime/timing.h>
 #ifdef FT_WITH_CUDA
 #include <../runtime/gpu_context.h>
 #endif
 
 namespace freetensor {
 
+class Driver;
+class BoundCall;
+
+/**
+ * Native code of multiple CPU programs, built into one binary with one backend
+ * compiler invocation
+ *
+ * This amortizes the cost of launching the compiler, parsing the runtime
+ * headers and loading the binary over all the programs. The entrance of the
+ * i-th program is renamed to `entry(i)`. Construct a `Driver` from a
+ * `BatchBinary` and an index to run each of the programs
+ */
+class BatchBinary {
+    friend Driver;
+
+    std::vector<std::string> srcs_;
+    Ref<Device> dev_;
+    std::shared_future<std::pair<Ref<Library>, double>> building_;
+
+  public:
+    /**
+     * @param srcs : Native code of each program generated from codegen
+     * @param device : The device to run the programs. Must be a CPU
+     * @param asyncBuild : If true, return immediately and build the binary in
+     * the background. The building is joined by any of the `Driver`s
+     */
+    BatchBinary(const std::vector<std::string> &srcs, const Ref<Device> &device,
+                bool asyncBuild = false);
+
+    size_t size() const { return srcs_.size(); }
+    const std::string &src(size_t i) const { return srcs_.at(i); }
+    const Ref<Device> &device() const { return dev_; }
+
+    static std::string entry(size_t i) { return "run_" + std::to_string(i); }
+
+    /**
+     * Source code of the whole batch, compiled into one binary
+     */
+    static std::string source(const std::vector<std::string> &srcs);
+};
+
+/**
+ * A compiled program, loaded and ready to run
+ *
+ * A `Driver` is not thread-safe. The arguments set by `setArgs`, the context,
+ * and the workspace for local arrays kept in the context across invocations
+ * are all owned by the `Driver`, so it must not be invoked from multiple
+ * threads at the same time. To run the same program concurrently, create a
+ * `Driver` for each thread, e.g., from a `BatchBinary`, so the binary is
+ * loaded only once and shared
+ */
 class Driver {
-    void *dlHandle_ = nullptr;
+    friend BatchBinary;
+    friend BoundCall;
+
+    Ref<Library> lib_;
     void (*func_)(void ** /* params */, void ** /* retRaw */,
                   size_t ** /* retShapes */, size_t * /* retDims */,
                   void * /* ctx */) = nullptr;
 
     Func f_;
     std::string src_;
+    std::string entry_ = "run"; /// Symbol of the entrance in the binary
+    Ref<BatchBinary> batch_;    /// Keep the batch alive, if any
     std::vector<Ref<Array>> args_; /// Ref count holders
     std::vector<void *> rawArgs,
         rawRets; /// Raw arguments and return values passed to (from) the
@@ -30,15 +91,68 @@ class Driver {
     std::vector<size_t *> retShapes_;
     std::vector<size_t> retDims_;
     std::unordered_map<std::string, size_t> name2param_;
+    std::vector<int> ret2param_; /// Which parameter is returned by each return
+                                 /// value, or -1 if it is not a parameter
     std::unordered_map<std::string, Ref<Buffer>> name2buffer_;
     Ref<Device> dev_, hostDev_;
 
     std::unique_ptr<Context> ctx_;
 
+    std::shared_future<std::pair<Ref<Library>, double>>
+        building_; /// Valid when being built in the background
+    double compileTime_ = 0; /// Time spent in the backend compiler, in ms
+
   private:
-    void buildAndLoad();
+    struct DeferBuild {};
+
+    /**
+     * Set up the parameters, but leave the binary unloaded
+     */
+    Driver(const Func &func, const std::string &src, const Ref<Device> &device,
+           const Ref<Device> &hostDevice, DeferBuild);
+
+    /**
+     * Compile the source code, or find it in the compilation cache
+     *
+     * @param use : Called with the path of the binary, which is removed
+     * afterwards. If it throws a `DriverError` for a cached binary, the binary
+     * is built again
+     * @return : Wall time of the backend compiler in ms, or 0 if the binary is
+     * found in the compilation cache
+     */
+    static double build(const std::string &src, const Ref<Device> &dev,
+                        const std::function<void(const std::string &)> &use);
+
+    /**
+     * Compile the source code and load the binary
+     *
+     * This function does not access any member of `Driver`, so it can be run
+     * in the background
+     *
+     * @return : (the loaded binary, wall time of the backend compiler in ms).
+     * The time is 0 if the binary is loaded from the compilation cache
+     */
+    static std::pair<Ref<Library>, double>
+    buildAndLoad(const std::string &src, const Ref<Device> &dev);
+
+    /**
+     * Find the entrance from a loaded binary and initialize the context
+     */
+    void load(const Ref<Library> &lib);
 
   public:
+    /**
+     * Compile the source code into a binary without loading it, e.g., to run
+     * it in another process
+     *
+     * This function can be run in the background
+     *
+     * @return : (content of the binary, wall time of the backend compiler in
+     * ms). The time is 0 if the binary is found in the compilation cache
+     */
+    static std::pair<std::string, double>
+    buildImage(const std::string &src, const Ref<Device> &dev);
+
     /**
      * Compile a program using a backend compiler and load it into memory
      *
@@ -47,15 +161,39 @@ class Driver {
      * @param src : Native code generated from codegen
      * @param device : The device to run the program
      * @param hostDevice : The hosting CPU device (Optional)
+     * @param asyncBuild : If true, return immediately and build the program in
+     * the background. The building is joined in `run` or `wait`, where any
+     * compiling error is thrown as a `DriverError`
      * @{
      */
     Driver(const Func &func, const std::string &src, const Ref<Device> &device,
-           const Ref<Device> &hostDevice);
-    Driver(const Func &func, const std::string &src, const Ref<Device> &device)
+           const Ref<Device> &hostDevice, bool asyncBuild = false);
+    Driver(const Func &func, const std::string &src, const Ref<Device> &device,
+           bool asyncBuild = false)
         : Driver(func, src, device,
                  device->type() == TargetType::CPU
                      ? device
-                     : Ref<Device>::make(Ref<CPU>::make())) {}
+                     : Ref<Device>::make(Ref<CPU>::make()),
+                 asyncBuild) {}
+    /** @} */
+
+    /**
+     * Run the `index`-th program in a `BatchBinary`
+     *
+     * The binary is shared with other `Driver`s of the same batch. If the
+     * batch is being built in the background, it is joined in `run` or `wait`.
+     * `compileTime` reports the time of building the whole batch
+     *
+     * @param func : AST of the `index`-th function
+     * @param batch : The binary built from a batch of programs
+     * @param index : Which program in the batch
+     * @param hostDevice : The hosting CPU device (Optional)
+     * @{
+     */
+    Driver(const Func &func, const Ref<BatchBinary> &batch, size_t index,
+           const Ref<Device> &hostDevice);
+    Driver(const Func &func, const Ref<BatchBinary> &batch, size_t index)
+        : Driver(func, batch, index, batch->device()) {}
     /** @} */
 
     ~Driver() {
@@ -80,6 +218,25 @@ class Driver {
         setArgs({}, kws);
     }
 
+    /**
+     * Wait until the program is built and loaded, if it is being built in the
+     * background
+     *
+     * Throws a `DriverError` if the building fails
+     */
+    void wait();
+
+    /**
+     * Check if the program is built and loaded, without blocking
+     */
+    bool isReady() const;
+
+    /**
+     * Wall time of the backend compiler, in ms, waiting for the building if
+     * needed. The time is 0 if the binary is loaded from the compilation cache
+     */
+    double compileTime();
+
     void run();
 
     /**
@@ -100,7 +257,72 @@ class Driver {
      */
     double time(int rounds = 10, int warmups = 3);
 
+    /**
+     * Run the program and measure its time cost, with statistics over the
+     * rounds
+     *
+     * Rounds can be repeated adaptively until the time is stable, and the
+     * caches can be evicted before each round. See `TimingOptions`
+     *
+     * @return : Statistics of the time, in ms
+     */
+    TimingResult benchmark(const TimingOptions &options = {});
+
     void unload();
+
+    /**
+     * Validate a binding of arguments once, for repeated invocations
+     *
+     * See `BoundCall` for details. The `Driver` must outlive the returned
+     * object
+     */
+    BoundCall prepare(
+        const std::vector<Ref<Array>> &args,
+        const std::unordered_map<std::string, Ref<Array>> &kws = {});
+};
+
+/**
+ * A prepared invocation of a `Driver`, for calling a program repeatedly with a
+ * low overhead
+ *
+ * The parameters to bind, their data types, memory types and access types are
+ * resolved once when preparing. Later calls take the arguments positionally,
+ * in the order of the bound parameters in the function signature, and only
+ * check them against a fingerprint (data type and shape) of the previous call.
+ * If the fingerprint does not match, the call falls back to the full
+ * validation of `Driver::setArgs`
+ */
+class BoundCall {
+    struct Slot {
+        size_t param_; /// Index in the function's parameters
+        std::string name_;
+        MemType mtype_;
+        AccessType atype_;
+        bool updateClosure_;
+        DataType dtype_;            /// Fingerprint
+        std::vector<size_t> shape_; /// Fingerprint
+    };
+
+    Driver &driver_;
+    std::vector<Slot> slots_;
+    std::vector<size_t> closures_; /// Parameters taken from closures
+
+  public:
+    BoundCall(Driver &driver, const std::vector<Ref<Array>> &args,
+              const std::unordered_map<std::string, Ref<Array>> &kws);
+
+    /**
+     * Number of arguments to pass in each call
+     */
+    size_t size() const { return slots_.size(); }
+
+    /**
+     * Set the arguments, run the program, and collect the return values
+     *
+     * @param args : Arguments for the bound parameters, in their order in the
+     * function signature
+     */
+    std::vector<Ref<Array>> operator()(const std::vector<Ref<Array>> &args);
 };
 
 } // namespace freetensor
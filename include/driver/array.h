@@ -2,6 +2,7 @@
 #define FREE_TENSOR_ARRAY_H
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include <driver/device.h>
@@ -19,6 +20,12 @@ class Array {
     DataType dtype_;
     Ref<Device> preferDevice_;
 
+    uint8_t *borrowed_ = nullptr; /// One of `ptrs_` not owned by us, if any
+    std::shared_ptr<void> borrowedOwner_; /// Owner of `borrowed_`
+
+  private:
+    void release(uint8_t *&ptr, const Ref<Device> &device);
+
   public:
     /**
      * Intialize an array on a specific device
@@ -40,6 +47,17 @@ class Array {
     Array(void *ptr, const std::vector<size_t> &shape, DataType dtype,
           const Ref<Device> &device);
 
+    /**
+     * Borrow CPU memory owned by someone else, without copying
+     *
+     * The memory is used as the storage on `device`, which must be a CPU, so
+     * any modification to it is visible to the owner, and vice versa. `owner`
+     * is kept alive until the memory is no longer used, i.e., when this Array
+     * is destroyed, or moved to another device
+     */
+    Array(void *ptr, const std::vector<size_t> &shape, DataType dtype,
+          const Ref<Device> &device, const std::shared_ptr<void> &owner);
+
     ~Array();
 
     Array(Array &&);
@@ -57,6 +75,19 @@ class Array {
     void *rawMovedTo(const Ref<Device> &device);
     void *rawInitTo(const Ref<Device> &device);
 
+    /**
+     * Get the data on a CPU, and copy it to a CPU if there is no copy yet
+     *
+     * The pointer is valid until the Array is modified on, or moved to,
+     * another device
+     */
+    void *rawSharedToCPU();
+
+    /**
+     * Check if the storage is borrowed from someone else
+     */
+    bool isBorrowed() const { return borrowed_ != nullptr; }
+
     void fromCPU(const void *other, size_t size);
     void toCPU(void *other, size_t size);
 
@@ -0,0 +1,97 @@
+#ifndef FREE_TENSOR_ARRAY_POOL_H
+#define FREE_TENSOR_ARRAY_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace freetensor {
+
+/**
+ * A caching allocator for the storage of `Array`s on CPU
+ *
+ * Requested sizes are rounded up to size classes (4 classes between two powers
+ * of 2), and freed blocks are kept in per-class free lists for reuse, up to
+ * `Config::arrayPoolSize()` bytes in total. Blocks are aligned to
+ * `Config::arrayAlignment()`. If `Config::arrayHugePages()` is set, blocks of
+ * at least one huge page are aligned to huge pages and advised to be backed by
+ * them
+ *
+ * All functions are thread-safe
+ */
+class ArrayPool {
+  public:
+    struct Stats {
+        size_t liveBytes_;   /// Bytes of blocks in use
+        size_t cachedBytes_; /// Bytes of freed blocks kept for reuse
+        size_t hits_;        /// Allocations served from the cache
+        size_t misses_;      /// Allocations served by the system
+    };
+
+  private:
+    struct Block {
+        size_t size_, align_;
+    };
+
+    mutable std::mutex lock_;
+    std::unordered_map<void *, Block> live_;
+    std::unordered_map<size_t, std::vector<std::pair<void *, size_t>>>
+        cache_; // size class -> [(ptr, align)]
+    Stats stats_ = {0, 0, 0, 0};
+
+    ArrayPool() = default;
+
+    static size_t sizeClass(size_t size);
+    /**
+     * @param size : Size of the block, rounded to its size class
+     * @param align : Alignment of the block
+     * @param used : Bytes requested, which are to be first touched
+     */
+    static void *sysAlloc(size_t size, size_t align, size_t used);
+
+    /**
+     * Touch each page of new storage from the OpenMP thread which will
+     * process it, so it is placed on the thread's NUMA node
+     *
+     * The storage is split evenly among the threads, the same as a statically
+     * scheduled `parallel for` over its outermost dimension with the default
+     * number of threads. The placement does not match a loop partitioning the
+     * array otherwise, e.g., by an inner dimension, with a different number
+     * of threads, or with a dynamic schedule. A block reused from the cache is
+     * not touched again, and keeps the placement of its first use
+     */
+    static void firstTouch(void *ptr, size_t size, bool hugePages);
+
+    void trimTo(size_t maxBytes);
+
+  public:
+    ArrayPool(const ArrayPool &) = delete;
+    ArrayPool &operator=(const ArrayPool &) = delete;
+
+    /**
+     * Allocate a block of at least `size` bytes
+     */
+    void *alloc(size_t size);
+
+    /**
+     * Return a block from `alloc` to the pool
+     *
+     * A pointer not from `alloc` is released by the plain `::free`, so it must
+     * be from `malloc` or `aligned_alloc`
+     */
+    void free(void *ptr);
+
+    /**
+     * Release all cached blocks to the system
+     */
+    void trim() { trimTo(0); }
+
+    Stats stats() const;
+
+    static ArrayPool &getInstance();
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_ARRAY_POOL_H
@@ -0,0 +1,59 @@
+#ifndef FREE_TENSOR_BUILD_POOL_H
+#define FREE_TENSOR_BUILD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace freetensor {
+
+/**
+ * A bounded pool of worker threads to build programs in the background
+ *
+ * The pool is shared by all asynchronously built `Driver`s, and it has as many
+ * workers as hardware threads
+ */
+class BuildPool {
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> jobs_;
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+  public:
+    BuildPool(size_t nThreads);
+    ~BuildPool();
+
+    BuildPool(const BuildPool &) = delete;
+    BuildPool &operator=(const BuildPool &) = delete;
+
+    /**
+     * Run a job in the background
+     *
+     * @return : A future for the result. Any exception thrown by the job is
+     * rethrown when getting the result
+     */
+    template <class F> std::future<std::invoke_result_t<F>> submit(F &&f) {
+        typedef std::invoke_result_t<F> Result;
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            std::forward<F>(f));
+        auto ret = task->get_future();
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            jobs_.emplace([task]() { (*task)(); });
+        }
+        cv_.notify_one();
+        return ret;
+    }
+
+    static BuildPool &getInstance();
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_BUILD_POOL_H
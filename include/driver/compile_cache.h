@@ -0,0 +1,60 @@
+#ifndef FREE_TENSOR_COMPILE_CACHE_H
+#define FREE_TENSOR_COMPILE_CACHE_H
+
+#include <string>
+
+#include <opt.h>
+
+namespace freetensor {
+
+/**
+ * Persistent on-disk cache of binaries built by the backend compiler
+ *
+ * Entries are keyed by a hash of the source code, the compiler command line
+ * (which includes the target-specific flags like `-march=native`), and the
+ * contents of the runtime headers. Entries are published by atomically renaming
+ * a complete file into the cache directory, so concurrent processes never see a
+ * partially written binary. When the total size exceeds
+ * `Config::compileCacheSize()`, least recently used entries are evicted
+ *
+ * All functions are thread-safe
+ */
+class CompileCache {
+  public:
+    /**
+     * Compute the key for a compilation
+     *
+     * @param src : Source code to compile
+     * @param cmd : Compiler command, excluding input and output file names
+     */
+    static std::string key(const std::string &src, const std::string &cmd);
+
+    /**
+     * Look up a binary in the cache, and mark it as recently used
+     *
+     * Hits and misses are not counted here, because the binary may still fail
+     * to load, e.g., if evicted concurrently. The caller counts them with
+     * `Config::countCompileCacheHit` and `Config::countCompileCacheMiss`
+     *
+     * @return : Path to the cached binary, or null if not found
+     */
+    static Opt<std::string> lookup(const std::string &key);
+
+    /**
+     * Copy a freshly built binary into the cache, and evict old entries if the
+     * cache is full
+     *
+     * @return : Path to the cached binary
+     */
+    static std::string insert(const std::string &key, const std::string &path);
+
+    /**
+     * Evict least recently used entries until the total size is no more than
+     * `maxBytes`
+     */
+    static void evict(size_t maxBytes);
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_COMPILE_CACHE_H
@@ -0,0 +1,37 @@
+#ifndef FREE_TENSOR_COMPILER_JOB_H
+#define FREE_TENSOR_COMPILER_JOB_H
+
+#include <string>
+#include <vector>
+
+namespace freetensor {
+
+/**
+ * Run the backend compiler in a child process, and wait until it finishes
+ *
+ * The compiler is spawned directly with `posix_spawn`, without a shell. At most
+ * `Config::backendCompilerJobs()` compilers run at the same time in this
+ * process, and other callers block until a slot is free. Anything the compiler
+ * prints is captured. If the compiler fails, its output is thrown in a
+ * `DriverError`
+ *
+ * @param argv : The compiler and its arguments
+ * @return : Wall time of the compiler process, in ms, excluding the time
+ * waiting for a free slot
+ */
+double runCompilerJob(const std::vector<std::string> &argv);
+
+/**
+ * Max number of compilers running at the same time, resolved from
+ * `Config::backendCompilerJobs()`
+ */
+size_t maxCompilerJobs();
+
+/**
+ * Join a command line into a string, for printing or hashing
+ */
+std::string joinCommand(const std::vector<std::string> &argv);
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_COMPILER_JOB_H
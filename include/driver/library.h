@@ -0,0 +1,76 @@
+#ifndef FREE_TENSOR_LIBRARY_H
+#define FREE_TENSOR_LIBRARY_H
+
+#include <string>
+
+#include <ref.h>
+
+namespace freetensor {
+
+/**
+ * A loaded binary of generated programs
+ *
+ * A `Library` is shared by all the `Driver`s running programs from it, and it
+ * is unloaded with `dlclose` when the last of them is destroyed, so a
+ * long-running process re-specializing its programs does not leak the code
+ * pages. Opening the same binary twice returns the same `Library`
+ *
+ * Unloading a library is safe only if no code in it is still running, so:
+ *
+ * - The user of a `Library` should hold a reference to it as long as any
+ * program in it may be running (e.g., a `Driver` syncs its device before
+ * releasing it).
+ * - The OpenMP runtime is never unloaded together with a `Library`. Its worker
+ * threads outlive the parallel regions, so the runtime is pinned in memory the
+ * first time a `Library` using it is opened.
+ *
+ * All functions are thread-safe
+ */
+class Library {
+    void *handle_;
+    std::string path_;
+    size_t bytes_;
+
+  public:
+    /**
+     * Take the ownership of a handle from `dlopen`. Please use `open` instead
+     */
+    Library(void *handle, const std::string &path);
+    ~Library();
+
+    Library(const Library &) = delete;
+    Library &operator=(const Library &) = delete;
+
+    /**
+     * Load a binary, or get the loaded one
+     *
+     * Throws a `DriverError` if unable to load it
+     */
+    static Ref<Library> open(const std::string &path);
+
+    /**
+     * Find a symbol, or return nullptr if not found
+     */
+    void *symbol(const std::string &name) const;
+
+    const std::string &path() const { return path_; }
+
+    /**
+     * Size of the memory mapped for the binary's segments
+     */
+    size_t bytes() const { return bytes_; }
+
+    /**
+     * Number of `Library`s currently loaded
+     */
+    static size_t residentCount();
+
+    /**
+     * Total `bytes()` of `Library`s currently loaded
+     */
+    static size_t residentBytes();
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_LIBRARY_H
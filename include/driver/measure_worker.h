@@ -0,0 +1,128 @@
+#ifndef FREE_TENSOR_MEASURE_WORKER_H
+#define FREE_TENSOR_MEASURE_WORKER_H
+
+#include <string>
+#include <sys/types.h> // pid_t
+#include <unordered_map>
+#include <vector>
+
+#include <../runtime/timing.h>
+#include <driver/array.h>
+#include <func.h>
+#include <ref.h>
+
+namespace freetensor {
+
+/**
+ * A binary of CPU programs to be measured in a `MeasureWorker`
+ */
+struct MeasureImage {
+    size_t id_;         /// Unique in the process, to tell if a worker has it
+    std::string bytes_; /// Content of the shared library
+
+    MeasureImage(std::string bytes);
+};
+
+/**
+ * Arguments to be passed to the programs measured in a `MeasureWorker`
+ */
+struct MeasureArgs {
+    size_t id_;                      /// Unique in the process
+    std::vector<std::string> bytes_; /// Data of each parameter, in order
+
+    MeasureArgs(std::vector<std::string> bytes);
+
+    /**
+     * Copy the arguments of a function, resolving positional arguments,
+     * keyword arguments and closures as `Driver::setArgs` does
+     */
+    static Ref<MeasureArgs>
+    pack(const Func &func, const std::vector<Ref<Array>> &args,
+         const std::unordered_map<std::string, Ref<Array>> &kws);
+};
+
+struct MeasureWorkerOptions {
+    double timeout_ = 60; /// Max seconds to measure one program
+    size_t memLimit_ = 0; /// Max bytes of the address space, 0 for unlimited
+};
+
+/**
+ * A child process to measure CPU programs, so a crashing or hanging program
+ * does not bring down the caller
+ *
+ * The worker (`runtime/cpu_measure_worker.cc`) is built by the backend compiler
+ * on first use, and stored in the compilation cache directory. It is spawned
+ * lazily, and spawned again after it dies. Each worker inherits the CPU
+ * affinity of the thread spawning it, and so do the OpenMP threads in it
+ *
+ * The worker talks with us through a UNIX stream socket, in requests of a
+ * 1-byte kind followed by its fields. Integers are 64-bit in the host byte
+ * order, and byte strings are prefixed by their lengths:
+ *
+ * - `L image`: Load a shared library.
+ * - `A n arg_0 ... arg_n-1`: Set the data of the parameters.
+ * - `T entry nRets warmups minRounds maxRounds maxRelCI minRoundTime
+ * flushCache`: Time the `entry` function in the loaded library with the
+ * arguments. `maxRelCI` and `minRoundTime` are `double`s. See `TimingOptions`.
+ *
+ * The worker replies `K` on success, or `E message` on an error. For `T`, `K`
+ * is followed by the mean, median, trimmed mean, standard deviation and
+ * relative confidence interval as `double`s, and the numbers of rounds and
+ * repeats. See `TimingResult`. Everything is passed in the stream,
+ * without sharing files or memory, so the same protocol can be served by a
+ * worker on a remote host over a TCP socket
+ *
+ * A `MeasureWorker` is not thread-safe. Each thread should use its own
+ */
+class MeasureWorker {
+    MeasureWorkerOptions options_;
+    pid_t pid_ = -1;
+    int sock_ = -1;
+    size_t imageId_ = 0, argsId_ = 0; /// What the worker has got, 0 for none
+
+  private:
+    void start();
+    void stop();
+
+    /**
+     * Send a request and wait for its reply
+     *
+     * @return : The payload of a successful reply, if any
+     */
+    std::string request(const std::string &msg, size_t replyBytes);
+
+    /**
+     * Kill the worker after it becomes unusable, and throw a `DriverError`.
+     * The worker is spawned again for the next request
+     */
+    [[noreturn]] void fail(const std::string &reason);
+
+  public:
+    MeasureWorker(const MeasureWorkerOptions &options = {})
+        : options_(options) {}
+    ~MeasureWorker() { stop(); }
+
+    MeasureWorker(const MeasureWorker &) = delete;
+    MeasureWorker &operator=(const MeasureWorker &) = delete;
+
+    /**
+     * Run a program in the worker and measure its time cost
+     *
+     * Throws a `DriverError` if the program fails to load, crashes the worker,
+     * or does not finish in time
+     *
+     * @param image : The binary containing the program
+     * @param entry : Symbol of the program in the binary
+     * @param args : Arguments of the program
+     * @param nRets : Number of return values of the program
+     * @param options : How to measure
+     * @return : Statistics of the time, in ms
+     */
+    TimingResult time(const Ref<MeasureImage> &image, const std::string &entry,
+                      const Ref<MeasureArgs> &args, size_t nRets,
+                      const TimingOptions &options = {});
+};
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_MEASURE_WORKER_H
@@ -0,0 +1,38 @@
+#ifndef FREE_TENSOR_PRECOMPILED_HEADER_H
+#define FREE_TENSOR_PRECOMPILED_HEADER_H
+
+#include <string>
+#include <vector>
+
+#include <opt.h>
+
+namespace freetensor {
+
+/**
+ * Get a precompiled `cpu_runtime.h`, and build it if not built yet
+ *
+ * Parsing the runtime headers (and `mkl.h`) takes a large share of the time
+ * compiling a generated CPU program. We precompile them once for each set of
+ * compiler flags, and store the result in `<compileCacheDir>/pch/<key>/`. The
+ * key covers the contents of the runtime headers as well, so a modified runtime
+ * gets a new precompiled header. A header is built at most once in a process,
+ * and concurrent processes publish it by atomically renaming a complete
+ * directory
+ *
+ * The returned directory should be searched before `FT_RUNTIME_DIR`. The
+ * compiler uses the precompiled header only if it is compatible, and falls back
+ * to the plain header otherwise, so it is always safe to use
+ *
+ * @param flags : The compiler and its flags to compile the generated code,
+ * excluding input, output and linker flags. The header is built with exactly
+ * the same flags, as required by precompiled headers
+ * @param key : A unique key of `flags`, e.g. from `CompileCache::key`
+ * @return : The directory containing the precompiled header, or null if it
+ * cannot be built
+ */
+Opt<std::string> precompiledCPURuntime(const std::vector<std::string> &flags,
+                                       const std::string &key);
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_PRECOMPILED_HEADER_H
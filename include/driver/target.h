@@ -30,13 +30,55 @@ class Target {
     virtual MemType mainMemType() const = 0;
 };
 
+/**
+ * How parallel loops (loops bound to `OpenMPScope`) are run on a CPU
+ */
+enum class ParallelRuntime : int {
+    OpenMP,     /// OpenMP worksharing loops
+    ThreadPool, /// A persistent work-stealing thread pool in the runtime
+};
+
 class CPU : public Target {
+    Opt<int> vectorBytes_;
+    ParallelRuntime parallelRuntime_ = ParallelRuntime::OpenMP;
+    bool pinThreads_ = false;
+
   public:
     CPU(bool useNativeArch = true) : Target(useNativeArch) {}
 
     TargetType type() const override { return TargetType::CPU; }
     std::string toString() const override { return "CPU"; }
     MemType mainMemType() const override { return MemType::CPU; }
+
+    /// Width of SIMD registers in bytes, e.g. 32 for AVX2, 64 for AVX-512
+    void setVectorBytes(int bytes) { vectorBytes_ = Opt<int>::make(bytes); }
+    Opt<int> explicitVectorBytes() const { return vectorBytes_; }
+
+    /**
+     * Width of SIMD registers in bytes. If not set, detect it from the host
+     * when using the native architecture, or fall back to 16 (SSE2 or NEON)
+     */
+    int vectorBytes() const;
+
+    /**
+     * Run parallel loops with OpenMP (by default), or with FreeTensor's own
+     * thread pool (see runtime/cpu_thread_pool.h). The thread pool keeps its
+     * workers alive across invocations of a program, which saves the cost of
+     * forking and joining a team for short parallel loops
+     */
+    void setParallelRuntime(ParallelRuntime runtime) {
+        parallelRuntime_ = runtime;
+    }
+    ParallelRuntime parallelRuntime() const { return parallelRuntime_; }
+
+    /**
+     * Pin threads running parallel loops to CPU cores, filling one socket
+     * after another in the order of the loop's partition. Together with
+     * `Config::arrayFirstTouch`, each part of the data is then processed on
+     * the NUMA node where it is placed
+     */
+    void setPinThreads(bool flag = true) { pinThreads_ = flag; }
+    bool pinThreads() const { return pinThreads_; }
 };
 
 class GPU : public Target {
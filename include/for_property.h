@@ -35,6 +35,9 @@ struct ForProperty : public ASTPart {
                                       // no dependencies over this loop
     bool preferLibs_; // Aggresively transform to external library calls in
                       // auto-schedule
+    std::vector<std::string> streamingStores_; // vars written with
+                                               // non-temporal stores in this
+                                               // loop
 
     ForProperty()
         : parallel_(), unroll_(false), vectorize_(false), preferLibs_(false) {}
@@ -64,6 +67,12 @@ struct ForProperty : public ASTPart {
         ret->preferLibs_ = preferLibs;
         return ret;
     }
+    Ref<ForProperty>
+    withStreamingStores(const std::vector<std::string> &streamingStores) {
+        auto ret = Ref<ForProperty>::make(*this);
+        ret->streamingStores_ = streamingStores;
+        return ret;
+    }
 
     void compHash() override;
 };
@@ -80,6 +89,7 @@ inline Ref<ForProperty> deepCopy(const Ref<ForProperty> &_p) {
     p->reductions_ = _p->reductions_;
     p->noDeps_ = _p->noDeps_;
     p->preferLibs_ = _p->preferLibs_;
+    p->streamingStores_ = _p->streamingStores_;
     return p;
 }
 
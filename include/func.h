@@ -49,7 +49,7 @@ class FuncNode : public ASTNode {
 
     bool isFunc() const override { return true; }
 
-    void compHash() override { ASSERT(false); } // TODO
+    void compHash() override;
 
     DEFINE_NODE_TRAIT(Func);
 };
@@ -5,6 +5,7 @@
 #include <unordered_set>
 
 #include <expr.h>
+#include <func.h>
 #include <hash_combine.h>
 #include <stmt.h>
 
@@ -27,6 +28,9 @@ class Hasher {
     static size_t compHash(const ReductionItem &r);
     static size_t compHash(const ForProperty &p);
 
+    // func
+    static size_t compHash(const FuncNode &op);
+
     // stmt
     static size_t compHash(const AnyNode &op);
     static size_t compHash(const StmtSeqNode &op);
@@ -61,6 +65,9 @@ class Hasher {
 
 class HashComparator {
   private:
+    // func
+    bool compare(const Func &lhs, const Func &rhs) const;
+
     // stmt
     bool compare(const Any &lhs, const Any &rhs) const;
     bool compare(const StmtSeq &lhs, const StmtSeq &rhs) const;
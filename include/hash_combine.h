@@ -1,12 +1,22 @@
 #ifndef FREE_TENSOR_HASH_COMBINE_H
 #define FREE_TENSOR_HASH_COMBINE_H
 
+#include <cstdint>
 #include <cstdlib>
+#include <string>
 
 namespace freetensor {
 
 size_t hashCombine(size_t seed, size_t other);
 
+/**
+ * 64-bit FNV-1a. Unlike `std::hash`, which is implementation-defined, the
+ * result is stable across processes and builds, so it can be used in keys
+ * saved to disk
+ */
+uint64_t fnv1a(const std::string &data,
+               uint64_t basis = 0xcbf29ce484222325ull);
+
 }
 
 #endif // FREE_TENSOR_HASH_COMBINE_H
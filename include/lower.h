@@ -6,6 +6,7 @@
 #include <config.h>
 #include <driver/target.h>
 #include <pass/cpu/lower_parallel_reduction.h>
+#include <pass/cpu/lower_vector.h>
 #include <pass/float_simplify.h>
 #include <pass/gpu/lower_parallel_reduction.h>
 #include <pass/gpu/lower_vector.h>
@@ -118,6 +119,8 @@ T lower(const T &_ast, const Ref<Target> &_target = nullptr,
     case TargetType::CPU:
         ast = APPLY("cpu_lower_parallel_reduction", cpu::lowerParallelReduction,
                     ast);
+        ast = APPLY("cpu_lower_vector", cpu::lowerVector, ast,
+                    target.as<CPU>());
         ast = APPLY("use_builtin_div", useBuiltinDiv, ast);
         break;
 
@@ -267,7 +267,9 @@ class Mutator {
                             ->withUnroll(op->property_->unroll_)
                             ->withVectorize(op->property_->vectorize_)
                             ->withNoDeps(op->property_->noDeps_)
-                            ->withPreferLibs(op->property_->preferLibs_);
+                            ->withPreferLibs(op->property_->preferLibs_)
+                            ->withStreamingStores(
+                                op->property_->streamingStores_);
         property->reductions_.reserve(op->property_->reductions_.size());
         for (auto &&r : op->property_->reductions_) {
             std::vector<Expr> begins, ends;
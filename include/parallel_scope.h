@@ -18,14 +18,51 @@ inline bool operator!=(const SerialScope &lhs, const SerialScope &rhs) {
     return false;
 }
 
-struct OpenMPScope {};
+struct OpenMPScope {
+    /**
+     * How iterations are distributed to threads. `Static`, `Dynamic` and
+     * `Guided` are the `schedule` kinds of `omp for`. `TaskLoop` runs the loop
+     * as `omp taskloop`, whose tasks are stolen by idle threads, which suits
+     * irregular nests
+     */
+    enum Kind { Static, Dynamic, Guided, TaskLoop } kind_ = Static;
+    int chunk_ = 0; /// Chunk size, or grain size for `TaskLoop`. 0 = default
+};
 inline bool operator==(const OpenMPScope &lhs, const OpenMPScope &rhs) {
-    return true;
+    return lhs.kind_ == rhs.kind_ && lhs.chunk_ == rhs.chunk_;
 }
 inline bool operator!=(const OpenMPScope &lhs, const OpenMPScope &rhs) {
-    return false;
+    return !(lhs == rhs);
+}
+/**
+ * "openmp", or "openmp:<kind>" or "openmp:<kind>:<chunk>" for a non-default
+ * schedule, e.g. "openmp:dynamic:16"
+ */
+inline std::string toString(const OpenMPScope &parallel) {
+    std::string ret = "openmp";
+    switch (parallel.kind_) {
+    case OpenMPScope::Static:
+        if (parallel.chunk_ > 0) {
+            ret += ":static";
+        }
+        break;
+    case OpenMPScope::Dynamic:
+        ret += ":dynamic";
+        break;
+    case OpenMPScope::Guided:
+        ret += ":guided";
+        break;
+    case OpenMPScope::TaskLoop:
+        ret += ":taskloop";
+        break;
+    default:
+        ASSERT(false);
+    }
+    if (parallel.chunk_ > 0) {
+        ret += ":" + std::to_string(parallel.chunk_);
+    }
+    return ret;
 }
-inline std::string toString(const OpenMPScope &parallel) { return "openmp"; }
 
 struct CUDAStreamScope {};
 inline bool operator==(const CUDAStreamScope &lhs, const CUDAStreamScope &rhs) {
@@ -99,8 +136,41 @@ inline ParallelScope parseParallelScope(const std::string &_str) {
     if (auto scope = SerialScope{}; str == tolower(toString(scope))) {
         return scope;
     }
-    if (auto scope = OpenMPScope{}; str == tolower(toString(scope))) {
-        return scope;
+    if (str == "openmp") {
+        return OpenMPScope{};
+    }
+    if (str.substr(0, 7) == "openmp:") {
+        // "openmp:<kind>" or "openmp:<kind>:<chunk>"
+        auto rest = str.substr(7), chunk = std::string();
+        auto pos = rest.find(':');
+        auto kind = rest.substr(0, pos);
+        if (pos != std::string::npos) {
+            chunk = rest.substr(pos + 1);
+        }
+        OpenMPScope scope;
+        bool valid = true;
+        if (kind == "static") {
+            scope.kind_ = OpenMPScope::Static;
+        } else if (kind == "dynamic") {
+            scope.kind_ = OpenMPScope::Dynamic;
+        } else if (kind == "guided") {
+            scope.kind_ = OpenMPScope::Guided;
+        } else if (kind == "taskloop") {
+            scope.kind_ = OpenMPScope::TaskLoop;
+        } else {
+            valid = false;
+        }
+        if (pos != std::string::npos) {
+            if (chunk.empty() ||
+                chunk.find_first_not_of("0123456789") != std::string::npos) {
+                valid = false;
+            } else {
+                scope.chunk_ = std::stoi(chunk);
+            }
+        }
+        if (valid) {
+            return scope;
+        }
     }
     if (auto scope = CUDAStreamScope{}; str == tolower(toString(scope))) {
         return scope;
@@ -134,7 +204,10 @@ template <> struct hash<freetensor::SerialScope> {
 };
 
 template <> struct hash<freetensor::OpenMPScope> {
-    size_t operator()(const freetensor::OpenMPScope &) { return 0; }
+    size_t operator()(const freetensor::OpenMPScope &parallel) {
+        return freetensor::hashCombine(std::hash<int>()((int)parallel.kind_),
+                                       std::hash<int>()(parallel.chunk_));
+    }
 };
 
 template <> struct hash<freetensor::CUDAStreamScope> {
@@ -0,0 +1,105 @@
+#ifndef FREE_TENSOR_CPU_LOWER_VECTOR_H
+#define FREE_TENSOR_CPU_LOWER_VECTOR_H
+
+#include <string>
+#include <vector>
+
+#include <analyze/symbol_table.h>
+#include <analyze/type_infer.h>
+#include <driver/target.h>
+#include <func.h>
+#include <mutator.h>
+
+namespace freetensor {
+
+namespace cpu {
+
+class LowerVector : public WithTypeInfer<SymbolTable<Mutator>> {
+    typedef WithTypeInfer<SymbolTable<Mutator>> BaseClass;
+
+    /// A vectorized expression in C, with `%` for scalar sub-expressions
+    struct VecExpr {
+        std::string code_;
+        DataType dtype_;
+        int maskBytes_ = 0; /// Lane width of a comparison result, or 0 if not
+                            /// a comparison
+    };
+
+    int vectorBytes_;
+
+    std::string var_; /// Iterator of the loop being lowered, or empty
+    int vecLen_ = 0;
+    Expr lane0_;   /// Value of the iterator in the first lane
+    Expr laneCnt_; /// Number of active lanes. Null if all lanes are active
+
+    std::vector<std::string> streaming_; /// Variables written with streaming
+                                         /// stores in the current loops
+
+  public:
+    LowerVector(int vectorBytes) : vectorBytes_(vectorBytes) {}
+
+  private:
+    bool isVarying(const Expr &op) const;
+
+    /**
+     * Position of the varying index, which must be the last one, or -1 if all
+     * indices are loop-invariant
+     */
+    int varyingDim(const std::vector<Expr> &indices) const;
+
+    /**
+     * If the last index is `var_ + invariant`, return the index of the first
+     * lane. Otherwise return null, and the access should be a gather or scatter
+     */
+    Expr contiguousBase(const Expr &index) const;
+
+    std::string vecType(DataType dtype) const;
+    std::string tmplArgs(DataType dtype) const;
+    std::string suffix() const { return laneCnt_.isValid() ? "N" : ""; }
+    std::string laneCntArg(std::vector<Expr> &params);
+
+    VecExpr vectorize(const Expr &op, std::vector<Expr> &params);
+    VecExpr vectorizeAs(const Expr &op, DataType dtype,
+                        std::vector<Expr> &params);
+    VecExpr convert(const VecExpr &expr, DataType dtype);
+
+    /// Address of the first lane of an access to `var`
+    Expr baseAddr(const std::string &var, const std::vector<Expr> &indices,
+                  const Expr &base);
+
+    Stmt lowerBody(const Stmt &body, const Expr &lane0, const Expr &laneCnt);
+    Stmt lowerLoop(const For &op);
+
+  protected:
+    using BaseClass::visit;
+    Stmt visitStmt(const Stmt &op) override;
+    Stmt visit(const For &op) override;
+    Stmt visit(const If &op) override;
+    Stmt visit(const Store &op) override;
+    Stmt visit(const ReduceTo &op) override;
+};
+
+/**
+ * Lower loops marked with `vectorize` into explicit SIMD code, using GCC vector
+ * extensions (see runtime/cpu_vector.h)
+ *
+ * The vector length is `target->vectorBytes()` divided by the size of the
+ * widest data type in the loop. A loop whose length is not divisible by the
+ * vector length ends with a masked vector iteration. Contiguous accesses are
+ * lowered to unaligned vector loads and stores, other accesses to gathers and
+ * scatters. Reductions into a loop-invariant location are lowered to
+ * horizontal reductions. Contiguous stores to variables in `streamingStores_`
+ * of the loop or an outer loop are lowered to vector streaming stores
+ *
+ * A loop that cannot be lowered is left as it is, with a warning saying why,
+ * and the backend compiler may still vectorize it
+ */
+Stmt lowerVector(const Stmt &op, const Ref<CPU> &target);
+
+DEFINE_PASS_FOR_FUNC(lowerVector)
+
+} // namespace cpu
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_CPU_LOWER_VECTOR_H
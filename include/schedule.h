@@ -380,6 +380,10 @@ class Schedule {
     /**
      * Mark a loop with a parallel implementation
      *
+     * An OpenMP scope may carry a schedule kind and a chunk size (see
+     * `OpenMPScope`), e.g. "openmp:dynamic:16" for a load-imbalanced loop, or
+     * "openmp:taskloop" for an irregular nest
+     *
      * @param loop : ID of the loop
      * @param parallel : Parallel scope
      */
@@ -407,12 +411,31 @@ class Schedule {
      * achitecture, the scheduler may or may not postpone it to the backend
      * compiler. The vectorization is a best-effort schedule
      *
+     * On CPU, the loop is lowered to explicit SIMD code when lowering. If it
+     * cannot be, a warning is printed and it is left to the backend compiler
+     *
      * @param loop : ID of the loop
      * @throw InvalidSchedule if the ID or name is not found, or the dependency
      * requirement is not met
      */
     void vectorize(const ID &loop);
 
+    /**
+     * Write a variable with non-temporal (streaming) stores in a loop
+     *
+     * A streaming store bypasses the cache. It saves the read-for-ownership of
+     * a regular store and does not evict other data from the cache, which
+     * pays off for large outputs written only once. The loop is followed by a
+     * fence. Only CPU is supported
+     *
+     * @param loop : ID of the loop
+     * @param var : Name of the variable. It should be defined outside the loop
+     * @throw InvalidSchedule if the loop is not found, the variable is not in
+     * `MemType::CPU`, the variable is read anywhere in the program, or an
+     * element of it is written more than once in the loop
+     */
+    void streamingStore(const ID &loop, const std::string &var);
+
     /**
      * Seperate main iterations and tail iterations of a loop
      *
@@ -464,6 +487,36 @@ class Schedule {
      */
     void asMatMul(const ID &loop);
 
+    /**
+     * Transform nested loops of a matrix multiplication into a cache-blocked
+     * GEMM written in FreeTensor IR, instead of an external call as `asMatMul`
+     *
+     * The result follows BLIS: B is packed into panels of NR columns for each
+     * KC x NC block, A into panels of MR rows for each MC x KC block, and a
+     * micro-kernel accumulates each MR x NR tile of C in a local buffer, whose
+     * vectorized and unrolled loops are lowered to SIMD registers. MR and NR
+     * are derived from the vector width of the target
+     *
+     * Since the result is ordinary loops, it can be further scheduled together
+     * with the surrounding code. Generated loops are named after `loop`:
+     * `<loop>.jc`, `<loop>.pc` and `<loop>.ic` iterate over blocks of N, K and
+     * M, `<loop>.jr` and `<loop>.ir` over register tiles, `<loop>.kr` is the
+     * innermost reduction, and `<loop>.store` adds a tile to C. `<loop>.pack_a`
+     * and `<loop>.pack_b` are packing loops. Loops used by all of A, B and C
+     * are kept as batch loops outside
+     *
+     * `<loop>.store` is inside `<loop>.pc`, so when K is longer than KC, it
+     * adds a partial sum of each KC block to C, instead of writing the final
+     * result. Therefore, an epilogue (e.g. an activation) can not be fused
+     * into `<loop>.store`. Apply it after the whole `<loop>.jc` loop instead
+     *
+     * @param loop : ID of the loop
+     * @param target : Target architecture. Only CPU is supported
+     * @throw InvalidSchedule if the loop is not a matrix multiplication with
+     * exactly one loop in each of the m, n and k axes
+     */
+    void asBlockedMatMul(const ID &loop, const Ref<Target> &target);
+
     /**
      * (Experimental) Automatic scheduling using some heuristics
      *
@@ -506,6 +559,16 @@ class Schedule {
      */
     void autoUnroll(const Target &target);
 
+    /**
+     * (Experimental) Automatically use streaming stores for large outputs
+     * written only once, using some heuristics
+     *
+     * Not called by `autoSchedule`. Call it explicitly to opt in
+     *
+     * @param target : Target architecture
+     */
+    void autoStreamingStore(const Target &target);
+
     std::vector<std::pair<ID, int>>
     multiLevelTiling(const ForsWithDataReuse &target,
                      const MultiLevelTilingAnnotation &annotation,
@@ -0,0 +1,62 @@
+#ifndef FREE_TENSOR_AS_BLOCKED_MATMUL_H
+#define FREE_TENSOR_AS_BLOCKED_MATMUL_H
+
+#include <unordered_map>
+
+#include <analyze/symbol_table.h>
+#include <driver/target.h>
+#include <mutator.h>
+
+namespace freetensor {
+
+/**
+ * Sizes of a BLIS-style blocked GEMM. The register tile is MR x NR, and the
+ * packed blocks of A and B are MC x KC and KC x NC, respectively
+ */
+struct GEMMBlocking {
+    int mr_, nr_, kc_, mc_, nc_;
+};
+
+/**
+ * Blocking for a target, the same as the built-in GEMM of the runtime. See
+ * `gemmBlockSizes` in runtime/cpu_gemm_blocking.h
+ */
+GEMMBlocking gemmBlocking(const Ref<CPU> &target, DataType dtype);
+
+class AsBlockedMatMul : public SymbolTable<Mutator> {
+    typedef SymbolTable<Mutator> BaseClass;
+
+    ID loop_;
+    Ref<CPU> target_;
+    bool done_ = false;
+
+    // Collected from the loop nest
+    std::vector<For> nests_;
+    std::vector<std::string> scope_, initScope_;
+    Store init_;
+    ReduceTo leaf_;
+
+  public:
+    AsBlockedMatMul(const ID &loop, const Ref<CPU> &target)
+        : loop_(loop), target_(target) {}
+
+    bool done() const { return done_; }
+
+  private:
+    void collect(const Stmt &op);
+    Stmt transform();
+
+  protected:
+    using BaseClass::visit;
+    Stmt visit(const For &op) override;
+};
+
+/**
+ * Transform nested loops of a matrix multiplication into a BLIS-style
+ * cache-blocked GEMM in FreeTensor IR. See `Schedule::asBlockedMatMul`
+ */
+Stmt asBlockedMatMul(const Stmt &ast, const ID &loop, const Ref<CPU> &target);
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_AS_BLOCKED_MATMUL_H
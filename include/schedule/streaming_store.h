@@ -0,0 +1,39 @@
+#ifndef FREE_TENSOR_STREAMING_STORE_H
+#define FREE_TENSOR_STREAMING_STORE_H
+
+#include <analyze/symbol_table.h>
+#include <mutator.h>
+
+namespace freetensor {
+
+class StreamingStore : public SymbolTable<Mutator> {
+    typedef SymbolTable<Mutator> BaseClass;
+
+    ID loop_;
+    std::string var_;
+    ID def_;
+    std::vector<ID> outerLoops_, loopStack_;
+    bool done_ = false;
+
+  public:
+    StreamingStore(const ID &loop, const std::string &var)
+        : loop_(loop), var_(var) {}
+
+    bool done() const { return done_; }
+    const ID &def() const { return def_; }
+    const std::vector<ID> &outerLoops() const { return outerLoops_; }
+
+  protected:
+    using BaseClass::visit;
+    Stmt visit(const For &op) override;
+};
+
+/**
+ * Mark stores to a variable in a loop as non-temporal. See
+ * `Schedule::streamingStore`
+ */
+Stmt streamingStore(const Stmt &ast, const ID &loop, const std::string &var);
+
+} // namespace freetensor
+
+#endif // FREE_TENSOR_STREAMING_STORE_H
@@ -32,6 +32,8 @@ from .transformer import (transform, inline, empty, var, capture_var, metadata,
 
 from .meta import *
 from .auto_schedule import *
-from .optimize import optimize
+from .tuning_log import TuningLog
+from .optimize import (optimize, optimize_cache_info, clear_optimize_cache,
+                       set_optimize_cache_size)
 
 from .task_scheduler import TaskScheduler
@@ -1,37 +1,131 @@
 import freetensor_ffi as ffi
-import xgboost as xgb
 import numpy as np
 
+from .tuning_log import TuningLog, target_fingerprint
+
 
 class AutoSchedule(ffi.AutoSchedule):
 
-    def __init__(self, schedule, target, device, n_measured, tag=""):
+    def __init__(self,
+                 schedule,
+                 target,
+                 device,
+                 n_measured,
+                 tag="",
+                 measure_cores=None,
+                 measure_workers=0,
+                 measure_timeout=60,
+                 measure_mem_limit=0,
+                 tuning_log=None,
+                 timing=None,
+                 cost_model="native"):
+        '''
+        Parameters
+        ----------
+        measure_cores : Sequence[int], optional
+            Pin the thread measuring the programs to these cores, which should
+            be kept away from other work. The programs are compiled by other
+            threads while earlier ones are being measured
+        measure_workers : int
+            Measure the programs in this amount of child processes, so a
+            crashing or hanging program is recorded as a failed one instead of
+            bringing the tuning down. The workers share `measure_cores` evenly.
+            0 for measuring in this process. Only for CPU
+        measure_timeout : float
+            Max seconds to measure one program in a worker
+        measure_mem_limit : int
+            Max bytes of the address space of a worker. 0 for unlimited
+        tuning_log : str or TuningLog, optional
+            Append every measured program to this log. Records in it of the
+            same program on the same target warm-start the search: they join
+            the population, and they train the cost model. See also
+            `apply_best_record`
+        timing : TimingOptions, optional
+            How to measure each program. By default, a program is measured for
+            5 to 50 rounds of at least 1 ms each, until the 95% confidence
+            interval of the time is within 2% of it, and ranked by the median
+        cost_model : str
+            "native" for the built-in gradient-boosted trees, which predict
+            without calling back into Python. "python" for calling `predict`
+            and `update` of this object, which use XGBoost by default and can
+            be overridden in a subclass
+        '''
         self.model = None
         self.xgb_params = {}
 
-        def predict_func(features):
-            return self.predict(features)
+        if cost_model == "native":
+            predict_func, update_func = None, None
+        elif cost_model == "python":
+
+            def predict_func(features):
+                return self.predict(features)
 
-        def update_func(features, times):
-            return self.update(features, times)
+            def update_func(features, times):
+                return self.update(features, times)
+        else:
+            raise ValueError("cost_model should be \"native\" or \"python\"")
 
         super(AutoSchedule, self).__init__(schedule, target, device, n_measured,
                                            predict_func, update_func, tag)
+        if isinstance(tuning_log, str):
+            tuning_log = TuningLog(tuning_log)
+        self.tuning_log = tuning_log
+        self.target_fingerprint = target_fingerprint(target)
+        if self.tuning_log is not None:
+            records = self.tuning_log.load(self.get_workload(),
+                                           self.target_fingerprint)
+            if records:
+                self.add_records(records)
+        if measure_workers > 0:
+            self.set_measure_workers(measure_workers, measure_timeout,
+                                     measure_mem_limit)
+        if measure_cores is not None:
+            self.set_measure_cores(list(measure_cores))
+        if timing is not None:
+            self.set_timing_options(timing)
 
     def set_params(self, *args, **kws):
         super(AutoSchedule, self).set_params(args, kws)
 
+    def search_one_round(self, n):
+        super(AutoSchedule, self).search_one_round(n)
+        if self.tuning_log is not None:
+            self.tuning_log.append(self.get_workload(), self.target_fingerprint,
+                                   self.pop_records())
+
+    def apply_best_record(self):
+        '''
+        Apply the schedules of the fastest program in the tuning log, without
+        searching or measuring
+
+        Returns
+        -------
+        Schedule or None
+            The scheduled program, or None if there is no successful record of
+            this program on this target
+        '''
+        if self.tuning_log is None:
+            return None
+        record = self.tuning_log.best(self.get_workload(),
+                                      self.target_fingerprint)
+        if record is None:
+            return None
+        return self.apply_record(record)
+
     def run(self, iteration):
         for i in range(iteration):
             print("iter ", i)
             self.search_one_round(64)
+        print("throughput: %.1f candidates/hour" % self.get_throughput())
         return self.get_best_schedule()
 
     def predict(self, features):
+        import xgboost as xgb
         if not self.model:
             return [1] * len(features)
         return self.model.predict(xgb.DMatrix(np.array(features), missing=-1))
 
     def update(self, features, times):
+        import xgboost as xgb
         dtrain = xgb.DMatrix(np.array(features), np.array(times), missing=-1)
         self.model = xgb.train(self.xgb_params, dtrain, xgb_model=self.model)
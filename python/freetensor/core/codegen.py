@@ -41,7 +41,7 @@ def codegen(ast=None,
             target = config.default_target()
 
         if target.type() == ffi.TargetType.CPU:
-            raw_code = ffi.code_gen_cpu(ast)
+            raw_code = ffi.code_gen_cpu(ast, target)
         elif target.type() == ffi.TargetType.GPU:
             raw_code = ffi.code_gen_cuda(ast)
         else:
@@ -18,6 +18,7 @@ def _import_func(f):
 
 
 with_mkl = _import_func(ffi.with_mkl)
+cpu_blas = _import_func(ffi.cpu_blas)
 
 with_cuda = _import_func(ffi.with_cuda)
 
@@ -30,6 +31,29 @@ print_all_id = _import_func(ffi.pretty_print)
 set_werror = _import_func(ffi.set_werror)
 werror = _import_func(ffi.werror)
 
+set_debug_binary = _import_func(ffi.set_debug_binary)
+debug_binary = _import_func(ffi.debug_binary)
+
+set_compile_cache = _import_func(ffi.set_compile_cache)
+compile_cache = _import_func(ffi.compile_cache)
+set_compile_cache_dir = _import_func(ffi.set_compile_cache_dir)
+compile_cache_dir = _import_func(ffi.compile_cache_dir)
+set_compile_cache_size = _import_func(ffi.set_compile_cache_size)
+compile_cache_size = _import_func(ffi.compile_cache_size)
+set_backend_compiler_jobs = _import_func(ffi.set_backend_compiler_jobs)
+backend_compiler_jobs = _import_func(ffi.backend_compiler_jobs)
+set_array_alignment = _import_func(ffi.set_array_alignment)
+array_alignment = _import_func(ffi.array_alignment)
+set_array_pool_size = _import_func(ffi.set_array_pool_size)
+array_pool_size = _import_func(ffi.array_pool_size)
+set_array_huge_pages = _import_func(ffi.set_array_huge_pages)
+array_huge_pages = _import_func(ffi.array_huge_pages)
+set_array_first_touch = _import_func(ffi.set_array_first_touch)
+array_first_touch = _import_func(ffi.array_first_touch)
+compile_cache_hits = _import_func(ffi.compile_cache_hits)
+compile_cache_misses = _import_func(ffi.compile_cache_misses)
+reset_compile_cache_stats = _import_func(ffi.reset_compile_cache_stats)
+
 set_default_target = _import_func(ffi.set_default_target)
 default_target = _import_func(ffi.default_target)
 
@@ -2,7 +2,10 @@ import freetensor_ffi as ffi
 import functools
 
 from typing import Optional, Sequence
-from freetensor_ffi import CPU, GPU, Array
+from freetensor_ffi import (CPU, GPU, ParallelRuntime, Array, TimingOptions,
+                            TimingResult, MeasureWorker, array_pool_stats,
+                            trim_array_pool, resident_library_count,
+                            resident_library_bytes)
 
 from . import config
 from .codegen import NativeCode
@@ -110,11 +113,19 @@ class Driver(ffi.Driver):
     def __init__(self,
                  func: ffi.Func,
                  src: str,
-                 device: Optional[Device] = None):
+                 device: Optional[Device] = None,
+                 async_build: bool = False,
+                 batch: Optional[ffi.BatchBinary] = None,
+                 index: int = 0):
         '''
         Compile a program using a backend compiler and load it into memory
 
-        This class is for internal use. Please consider using `build_binary`
+        This class is for internal use. Please consider using `build_binary` or
+        `build_binaries`
+
+        A Driver is not thread-safe: the arguments and the workspace for local
+        arrays are kept in the Driver. Do not invoke it from multiple threads
+        at the same time. Create a Driver for each thread instead
 
         Parameters
         ----------
@@ -126,11 +137,24 @@ class Driver(ffi.Driver):
         device : Device (Optional)
             The device to run the program. If omitted, use the default device
             in config
+        async_build : bool
+            If True, return immediately and build the program in the background.
+            The building is joined when running the program or calling `wait`,
+            where any compiling error is raised as a `DriverError`
+        batch : ffi.BatchBinary (Optional)
+            If set, run the `index`-th program in this already built (or being
+            built) batch, instead of building `src`. `device` and `async_build`
+            are ignored
+        index : int
+            Which program in `batch`
         '''
-        src = str(src)
-        if device is None:
-            device = config.default_device()
-        super(Driver, self).__init__(func, src, device)
+        if batch is not None:
+            super(Driver, self).__init__(func, batch, index)
+        else:
+            src = str(src)
+            if device is None:
+                device = config.default_device()
+            super(Driver, self).__init__(func, src, device, async_build)
         self.func = func
 
     def set_args(self, *args, **kws):
@@ -152,11 +176,32 @@ class Driver(ffi.Driver):
         elif len(values) == 1:
             return values[0]
         else:
-            return ReturnValuesPack(
-                map(
-                    lambda r: r.name,
-                    filter(lambda r: not r.is_in_closure or r.return_closure,
-                           self.func.returns)), values)
+            return ReturnValuesPack(self._return_names(), values)
+
+    def prepare(self, *args, **kws):
+        '''
+        Validate a binding of arguments once, for calling the program
+        repeatedly with a low overhead
+
+        The arguments are used to decide which parameters to bind, and to check
+        their types. The returned BoundCall takes the arguments positionally, in
+        the order of the bound parameters in the function signature. E.g.:
+
+        ```
+        call = driver.prepare(x=x, y=y)
+        for ...:
+            z = call(x, y)
+        ```
+        '''
+        return BoundCall(super(Driver, self).prepare(args, kws),
+                         self._return_names())
+
+    def _return_names(self):
+        return list(
+            map(
+                lambda r: r.name,
+                filter(lambda r: not r.is_in_closure or r.return_closure,
+                       self.func.returns)))
 
     def __call__(self, *args, **kws):
         '''
@@ -174,8 +219,33 @@ class Driver(ffi.Driver):
         return self.collect_returns()
 
 
+class BoundCall:
+    '''
+    A prepared invocation of a Driver. Please use `Driver.prepare` to create it
+
+    Calling it sets the arguments, executes the binary code, and collects the
+    returns, like calling a Driver. The arguments are only checked against
+    their data types and shapes in the previous call, which is much cheaper
+    than calling a Driver
+    '''
+
+    def __init__(self, bound: ffi.BoundCall, return_names):
+        self.bound = bound
+        self.return_names = return_names
+
+    def __call__(self, *args):
+        values = self.bound(args)
+        if len(values) == 0:
+            return None
+        elif len(values) == 1:
+            return values[0]
+        else:
+            return ReturnValuesPack(self.return_names, values)
+
+
 def build_binary(code: Optional[NativeCode] = None,
-                 device: Optional[Device] = None):
+                 device: Optional[Device] = None,
+                 async_build: bool = False):
     '''
     Compile a program using a backend compiler and load it into memory
 
@@ -187,6 +257,10 @@ def build_binary(code: Optional[NativeCode] = None,
     device : Device (Optional)
         The device to run the program. If omitted, use the default device
         in config
+    async_build : bool
+        If True, return the Driver immediately and build the program in the
+        background. Use `Driver.is_ready` to poll the building, and
+        `Driver.wait` to join it. Running the Driver joins it as well
     '''
 
     if code is not None:
@@ -196,9 +270,58 @@ def build_binary(code: Optional[NativeCode] = None,
             raise ffi.DriverError(
                 f"Codegen target ({code.target}) is inconsistent with device target ({device.target()})"
             )
-        return Driver(code.func, code.code, device)
+        return Driver(code.func, code.code, device, async_build)
     else:
         f = build_binary
         if device is not None:
             f = functools.partial(f, device=device)
+        if async_build:
+            f = functools.partial(f, async_build=async_build)
         return f
+
+
+def build_binaries(codes: Sequence[NativeCode],
+                   device: Optional[Device] = None,
+                   async_build: bool = False):
+    '''
+    Compile multiple programs into one binary using one backend compiler
+    invocation, and load it into memory
+
+    This is faster than calling `build_binary` for each program, because the
+    cost of launching the compiler and parsing the runtime headers is shared.
+    Only CPU programs can be batched. For other devices, each program is built
+    separately
+
+    Parameters
+    ----------
+    codes : Sequence[NativeCode]
+        Native code generated by `codegen`
+    device : Device (Optional)
+        The device to run the programs. If omitted, use the default device
+        in config
+    async_build : bool
+        If True, return the Drivers immediately and build the binary in the
+        background. Any of the Drivers joins the building when run
+
+    Returns
+    -------
+    List[Driver]
+        One Driver for each program, in the same order
+    '''
+
+    if device is None:
+        device = config.default_device()
+    for code in codes:
+        if device.target() != code.target:
+            raise ffi.DriverError(
+                f"Codegen target ({code.target}) is inconsistent with device target ({device.target()})"
+            )
+    if device.target().type() != ffi.TargetType.CPU:
+        return [
+            Driver(code.func, code.code, device, async_build) for code in codes
+        ]
+    batch = ffi.BatchBinary([code.code for code in codes], device, async_build)
+    return [
+        Driver(code.func, code.code, batch=batch, index=i)
+        for i, code in enumerate(codes)
+    ]
@@ -1,13 +1,111 @@
+import sys
+import collections
 import functools
 from typing import Optional, Callable
 
 import freetensor_ffi as ffi
 
+from . import config
 from .transformer import transform
 from .schedule import Schedule, schedule
 from .passes import lower
 from .codegen import codegen
-from .driver import Target, Device, build_binary
+from .driver import Target, Device, Driver, build_binary
+
+OptimizeCacheInfo = collections.namedtuple(
+    'OptimizeCacheInfo', ['hits', 'misses', 'maxsize', 'currsize'])
+
+
+def _config_key():
+    ''' Global configurations that change the result of building a program '''
+    return (config.debug_binary(), config.werror())
+
+
+class _OptimizeCache:
+    '''
+    Memoize `optimize` from a scheduled AST to its native code and, on CPU, the
+    loaded binary
+
+    Entries are bucketed by the structural hash of the scheduled AST, and
+    compared structurally inside a bucket, so ASTs built from different Python
+    objects (or with different statement IDs) but with the same structure share
+    one binary. The least recently used entry is dropped when full
+    '''
+
+    def __init__(self, maxsize: int = 128):
+        self.maxsize = maxsize
+        # hash -> [(ast, device, config key, code, batch)]
+        self.buckets = collections.OrderedDict()
+        self.currsize = 0
+        self.hits = 0
+        self.misses = 0
+
+    def lookup(self, ast, target, device, key):
+        h = ast.hash()
+        for (a, d, k, code, batch) in self.buckets.get(h, []):
+            if a.same_as(ast) and d.target() == target and d == device and \
+                    k == key:
+                self.buckets.move_to_end(h)
+                self.hits += 1
+                return code, batch
+        self.misses += 1
+        return None
+
+    def insert(self, ast, device, key, code, batch):
+        if self.maxsize <= 0:
+            return
+        h = ast.hash()
+        self.buckets.setdefault(h, []).append((ast, device, key, code, batch))
+        self.buckets.move_to_end(h)
+        self.currsize += 1
+        self.shrink()
+
+    def shrink(self):
+        while self.currsize > max(self.maxsize, 0):
+            oldest = next(iter(self.buckets))
+            self.buckets[oldest].pop(0)
+            if not self.buckets[oldest]:
+                del self.buckets[oldest]
+            self.currsize -= 1
+
+    def clear(self):
+        self.buckets.clear()
+        self.currsize = 0
+        self.hits = 0
+        self.misses = 0
+
+
+def _new_driver(code, batch, device):
+    if batch is not None:
+        return Driver(code.func, code.code, batch=batch, index=0)
+    return build_binary(code, device)
+
+
+_cache = _OptimizeCache()
+
+
+def optimize_cache_info() -> OptimizeCacheInfo:
+    '''
+    Get statistics of the memoization in `optimize`
+
+    Returns a named tuple of `hits`, `misses`, `maxsize` and `currsize`
+    '''
+    return OptimizeCacheInfo(_cache.hits, _cache.misses, _cache.maxsize,
+                             _cache.currsize)
+
+
+def clear_optimize_cache():
+    ''' Drop all memoized binaries in `optimize` and reset the statistics '''
+    _cache.clear()
+
+
+def set_optimize_cache_size(maxsize: int):
+    '''
+    Set how many binaries can be memoized in `optimize`. Set to 0 to disable
+    memoization
+    '''
+    _cache.maxsize = maxsize
+    _cache.shrink()
 
 
 def optimize(func=None,
@@ -50,19 +148,52 @@ def optimize(func=None,
         Where to run the program
     verbose : int (Optional)
         Verbosity level. Can be 0, 1 or 2
+
+    Binaries are memoized: if the scheduled AST is structurally identical to a
+    previous one, and the target, the device and the global configurations
+    affecting the building (`debug_binary` and `werror`) are the same, the
+    program is not lowered or compiled again. Functions with closures are not
+    memoized. See `optimize_cache_info` for the hit rate
+
+    Each call returns a new Driver, so the arguments set to, or prepared on, one
+    Driver do not affect another. On CPU, these Drivers share one loaded
+    binary, which is unloaded when all of them are gone. On other devices, a
+    new Driver loads the binary again, from the compilation cache if enabled
     '''
     if func is not None:
-        if target is None and device is not None:
-            target = device.target()
+        if target is None:
+            target = device.target(
+            ) if device is not None else config.default_target()
+        if device is None:
+            device = config.default_device()
 
         if not issubclass(type(func), ffi.AST):
             ast = transform(func, verbose=verbose, depth=2)
         else:
             ast = func
         ast = schedule(ast, schedule_callback, verbose=verbose)
-        ast = lower(ast, target, verbose=verbose)
-        code = codegen(ast, target, verbose=verbose)
-        exe = build_binary(code, device)
+
+        memoizable = ast.type() == ffi.ASTNodeType.Func and not any(
+            item.is_in_closure for item in list(ast.params) + list(ast.returns))
+        key = _config_key()
+        if memoizable:
+            hit = _cache.lookup(ast, target, device, key)
+            if hit is not None:
+                if verbose:
+                    print("Reusing a memoized binary", file=sys.stderr)
+                return _new_driver(*hit, device)
+
+        lowered = lower(ast, target, verbose=verbose)
+        code = codegen(lowered, target, verbose=verbose)
+        batch = None
+        if memoizable and device.target() == code.target and \
+                device.target().type() == ffi.TargetType.CPU:
+            # Built as a batch of one program, so later Drivers share it.
+            # `build_binary` reports an inconsistent target otherwise
+            batch = ffi.BatchBinary([code.code], device)
+        exe = _new_driver(code, batch, device)
+        if memoizable:
+            _cache.insert(ast, device, key, code, batch)
         return exe
 
     else:
@@ -21,6 +21,7 @@ from freetensor_ffi import make_1d_var
 from freetensor_ffi import use_builtin_div
 from freetensor_ffi import hoist_var_over_stmt_seq
 from freetensor_ffi import cpu_lower_parallel_reduction
+from freetensor_ffi import cpu_lower_vector
 from freetensor_ffi import gpu_lower_parallel_reduction
 from freetensor_ffi import gpu_make_sync
 from freetensor_ffi import gpu_multiplex_buffers
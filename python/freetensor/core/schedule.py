@@ -449,6 +449,12 @@ class Schedule(ffi.Schedule):
         """
         Mark a loop with a parallel implementation
 
+        An OpenMP scope may carry a schedule kind and a chunk size as
+        "openmp:<kind>[:<chunk>]", where `<kind>` is one of "static", "dynamic",
+        "guided" and "taskloop". E.g. "openmp:dynamic:16" suits a
+        load-imbalanced loop, and "openmp:taskloop" runs iterations as tasks
+        that idle threads can steal, which suits irregular nests
+
         Parameters
         ----------
         loop : str, ID or Stmt
@@ -489,6 +495,9 @@ class Schedule(ffi.Schedule):
         achitecture, the scheduler may or may not postpone it to the backend
         compiler. The vectorization is a best-effort schedule
 
+        On CPU, the loop is lowered to explicit SIMD code when lowering. If it
+        cannot be, a warning is printed and it is left to the backend compiler
+
         Parameters
         ----------
         loop : str, ID or Stmt
@@ -502,6 +511,31 @@ class Schedule(ffi.Schedule):
         """
         super(Schedule, self).vectorize(ID(loop))
 
+    def streaming_store(self, loop, var):
+        """
+        Write a variable with non-temporal (streaming) stores in a loop
+
+        A streaming store bypasses the cache. It saves the read-for-ownership of
+        a regular store and does not evict other data from the cache, which
+        pays off for large outputs written only once. The loop is followed by a
+        fence. Only CPU is supported
+
+        Parameters
+        ----------
+        loop : str, ID or Stmt
+            ID of the loop
+        var : str
+            Name of the variable. It should be defined outside the loop
+
+        Raises
+        ------
+        InvalidSchedule
+            if the loop is not found, the variable is not in `MemType.CPU`, the
+            variable is read anywhere in the program, or an element of it is
+            written more than once in the loop
+        """
+        super(Schedule, self).streaming_store(ID(loop), var)
+
     def separate_tail(self, noDuplicateVarDefs=False):
         """
         Seperate main iterations and tail iterations of a loop
@@ -563,6 +597,46 @@ class Schedule(ffi.Schedule):
         """
         super(Schedule, self).as_matmul(ID(loop))
 
+    def as_blocked_matmul(self, loop, target):
+        """
+        Transform nested loops of a matrix multiplication into a cache-blocked
+        GEMM written in FreeTensor IR, instead of an external call as
+        `as_matmul`
+
+        The result follows BLIS: B is packed into panels of NR columns for each
+        KC x NC block, A into panels of MR rows for each MC x KC block, and a
+        micro-kernel accumulates each MR x NR tile of C in a local buffer, whose
+        vectorized and unrolled loops are lowered to SIMD registers. MR and NR
+        are derived from the vector width of the target
+
+        Since the result is ordinary loops, it can be further scheduled together
+        with the surrounding code. Generated loops are named after `loop`:
+        `<loop>.jc`, `<loop>.pc` and `<loop>.ic` iterate over blocks of N, K and
+        M, `<loop>.jr` and `<loop>.ir` over register tiles, `<loop>.kr` is the
+        innermost reduction, and `<loop>.store` adds a tile to C.
+        `<loop>.pack_a` and `<loop>.pack_b` are packing loops. Loops used by all
+        of A, B and C are kept as batch loops outside
+
+        `<loop>.store` is inside `<loop>.pc`, so when K is longer than KC, it
+        adds a partial sum of each KC block to C, instead of writing the final
+        result. Therefore, an epilogue (e.g. an activation) can not be fused
+        into `<loop>.store`. Apply it after the whole `<loop>.jc` loop instead
+
+        Parameters
+        ----------
+        loop : str, ID or Stmt
+            ID of the loop
+        target : Target
+            Target architecture. Only CPU is supported
+
+        Raises
+        ------
+        InvalidSchedule
+            if the loop is not a matrix multiplication with exactly one loop in
+            each of the m, n and k axes
+        """
+        super(Schedule, self).as_blocked_matmul(ID(loop), target)
+
     def auto_schedule(self, target):
         """
         (Experimental) Automatic scheduling using some heuristics
@@ -629,6 +703,20 @@ class Schedule(ffi.Schedule):
         """
         super(Schedule, self).auto_unroll(target)
 
+    def auto_streaming_store(self, target):
+        """
+        (Experimental) Automatically use streaming stores for large outputs
+        written only once, using some heuristics
+
+        Not called by `auto_schedule`. Call it explicitly to opt in
+
+        Parameters
+        ----------
+        target : Target
+            Target architecture
+        """
+        super(Schedule, self).auto_streaming_store(target)
+
 
 def schedule(ast=None,
              callback: Callable[[Schedule], None] = None,
@@ -0,0 +1,100 @@
+import json
+import os
+
+import freetensor_ffi as ffi
+
+
+def target_fingerprint(target):
+    '''
+    A fingerprint of a target and the machine running it, to tell whether a
+    record is measured on the same kind of machine
+    '''
+    ret = str(target)
+    if target.use_native_arch():
+        ret += " native"
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    ret += " " + line.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    return ret
+
+
+class TuningLog:
+    '''
+    An append-only log of measured programs, in JSON Lines
+
+    Each line is a record of a program, containing the workload it belongs to
+    (see `AutoSchedule.get_workload`), the target fingerprint, the sketch and
+    the annotation to re-create the program, the schedules applied (for reading
+    only), the features for the cost model and the measured time in ms. A
+    record of a failed program has a time of 1e30
+
+    Parameters
+    ----------
+    path : str
+        Path of the log file. It is created when appending the first records
+    '''
+
+    def __init__(self, path):
+        self.path = path
+
+    def append(self, workload, fingerprint, records):
+        '''
+        Append records of a workload measured on a target
+        '''
+        lines = ""
+        for record in records:
+            lines += json.dumps({
+                "workload": workload,
+                "target": fingerprint,
+                "sketch": record.sketch,
+                "annotation": record.annotation,
+                "logs": record.logs,
+                "feature": record.feature,
+                "time": record.time,
+            }) + "\n"
+        if lines:
+            # Write all the lines at once, so concurrent runs appending to the
+            # same log don't interleave their records
+            with open(self.path, "a") as f:
+                f.write(lines)
+
+    def load(self, workload, fingerprint):
+        '''
+        Load all records of a workload measured on a target
+        '''
+        ret = []
+        if not os.path.exists(self.path):
+            return ret
+        with open(self.path) as f:
+            for line in f:
+                try:
+                    item = json.loads(line)
+                except json.JSONDecodeError:
+                    continue  # Possibly truncated by a crashed run
+                if item["workload"] != workload:
+                    continue
+                if item["target"] != fingerprint:
+                    continue
+                ret.append(
+                    ffi.TuningRecord(item["sketch"], item["annotation"],
+                                     item["logs"], item["feature"],
+                                     item["time"]))
+        return ret
+
+    def best(self, workload, fingerprint):
+        '''
+        The fastest record of a workload measured on a target, or None if there
+        is no successful one
+        '''
+        records = [
+            record for record in self.load(workload, fingerprint)
+            if record.time < 1e20
+        ]
+        if not records:
+            return None
+        return min(records, key=lambda record: record.time)
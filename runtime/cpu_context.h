@@ -1,17 +1,87 @@
 #ifndef CPU_CONTEXT_H
 #define CPU_CONTEXT_H
 
+#include <algorithm> // max
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <sys/resource.h> // rlimit
 
 #include "context.h"
+#include "cpu_thread_pool.h"
 
 class CPUContext : public Context {
     int64_t curStackSize_ = 0;
+    void *(*alloc_)(size_t);
+    void (*free_)(void *);
+    uint8_t *workspace_ = nullptr;
+    size_t workspaceSize_ = 0;
+    std::shared_ptr<ThreadPool> threadPool_;
+    std::shared_ptr<ThreadPool> (*getThreadPool_)(size_t, bool);
 
   public:
+    /**
+     * @param alloc, free : Allocator for return values and dynamic-sized local
+     * arrays. Return values are freed by the caller of the program with the
+     * matching deallocator
+     * @param getThreadPool : Get a process-wide thread pool, whose workers
+     * have at least the given stack size and are pinned or not as given. It
+     * should be implemented out of the programs, so the workers do not run
+     * code of a program being unloaded. If null, each context creates its own
+     */
+    CPUContext(void *(*alloc)(size_t), void (*free)(void *),
+               std::shared_ptr<ThreadPool> (*getThreadPool)(size_t,
+                                                            bool) = nullptr)
+        : alloc_(alloc), free_(free), getThreadPool_(getThreadPool) {}
+
+    ~CPUContext() {
+        if (workspace_ != nullptr) {
+            free_(workspace_);
+        }
+    }
+
+    CPUContext(const CPUContext &) = delete;
+    CPUContext &operator=(const CPUContext &) = delete;
+
+    void *alloc(size_t bytes) { return alloc_(bytes); }
+    void free(void *ptr) { free_(ptr); }
+
+    /**
+     * Make the workspace for local arrays at least `bytes` large. It is kept
+     * across invocations, so it is only allocated once
+     */
+    void reserveWorkspace(size_t bytes) {
+        if (bytes > workspaceSize_) {
+            if (workspace_ != nullptr) {
+                free_(workspace_);
+            }
+            workspace_ = (uint8_t *)alloc_(bytes);
+            workspaceSize_ = bytes;
+        }
+    }
+    uint8_t *workspace() const { return workspace_; }
+
+    /**
+     * Get the thread pool for parallel loops, if not got yet. It is kept
+     * across invocations, and got again only if the workers need a larger
+     * stack for `threadStackBytes` of local arrays, or if the pinning is
+     * changed
+     */
+    void initThreadPool(size_t threadStackBytes, bool pinned = false) {
+        size_t stackBytes =
+            std::max<size_t>(threadStackBytes + 1024 * 1024, 8192 * 1024);
+        if (threadPool_ == nullptr || threadPool_->stackBytes() < stackBytes ||
+            threadPool_->pinned() != pinned) {
+            threadPool_.reset(); // Join the old workers first, if not shared
+            threadPool_ = getThreadPool_ != nullptr
+                              ? getThreadPool_(stackBytes, pinned)
+                              : std::make_shared<ThreadPool>(0, stackBytes,
+                                                             pinned);
+        }
+    }
+    ThreadPool &threadPool() { return *threadPool_; }
+
     void setStackLim(int64_t bytes) {
         if (bytes > curStackSize_) {
             struct rlimit rlim;
@@ -0,0 +1,250 @@
+#ifndef CPU_GEMM_H
+#define CPU_GEMM_H
+
+#include <algorithm> // min, max
+#include <type_traits>
+
+#include <omp.h>
+
+#ifdef FT_WITH_CBLAS
+#include <cblas.h>
+#endif
+
+#include "cpu_context.h"
+#include "cpu_gemm_blocking.h"
+#include "cpu_vector.h"
+
+/**
+ * Batched strided GEMM used by MatMul nodes when FreeTensor is built without
+ * MKL. All matrices are row-major, and `transA` / `transB` means the
+ * corresponding operand is stored transposed, the same as
+ * `cblas_?gemm_batch_strided(CblasRowMajor, ...)`
+ *
+ * If FreeTensor is configured with an external CBLAS (OpenBLAS or BLIS, see
+ * `FT_CPU_BLAS` in CMake), each matrix in the batch is computed by
+ * `cblas_?gemm`. Otherwise, we use a built-in GEMM in the style of BLIS: the
+ * operands are packed into panels of `GEMM_MR` rows of A and `GEMM_NR` columns
+ * of B, and a register-blocked micro-kernel computes a `GEMM_MR x GEMM_NR` tile
+ * of C at a time. The packed blocks are allocated by the allocator of the
+ * `CPUContext` for each call, so nothing is kept alive after the call
+ *
+ * The built-in GEMM runs on at most `maxThreads` OpenMP threads. The generated
+ * code passes 1 inside a parallel loop, which may run on the thread pool
+ * instead of OpenMP, so the GEMM does not start one more team per thread
+ */
+
+#if defined(__AVX512F__)
+#define GEMM_VEC_BYTES 64
+#elif defined(__AVX__)
+#define GEMM_VEC_BYTES 32
+#else
+#define GEMM_VEC_BYTES 16
+#endif
+
+template <class T> struct GemmBlocking {
+    static constexpr GemmBlockSizes sizes =
+        gemmBlockSizes(GEMM_VEC_BYTES, sizeof(T));
+    static constexpr int VL = sizes.vl; // Vector length
+    static constexpr int MR = sizes.mr; // Rows of a micro tile
+    static constexpr int NR = sizes.nr; // Columns of a micro tile
+    static constexpr int KC = sizes.kc; // K of a packed block
+    static constexpr int MC = sizes.mc; // Rows of a packed block of A
+    static constexpr int NC = sizes.nc; // Columns of a packed block of B
+};
+
+/**
+ * Pack an `mc x kc` block of A, whose element (i, p) is at `a[i * rs + p *
+ * cs]`, into panels of `MR` rows. Rows beyond `mc` are padded with 0
+ */
+template <class T>
+void gemmPackA(int mc, int kc, const T *a, int rs, int cs, T *out) {
+    constexpr int MR = GemmBlocking<T>::MR;
+    for (int i0 = 0; i0 < mc; i0 += MR) {
+        for (int p = 0; p < kc; p++) {
+            for (int r = 0; r < MR; r++) {
+                *out++ = i0 + r < mc ? a[(i0 + r) * rs + p * cs] : T(0);
+            }
+        }
+    }
+}
+
+/**
+ * Pack a `kc x nc` block of B, whose element (p, j) is at `b[p * rs + j *
+ * cs]`, into panels of `NR` columns. Columns beyond `nc` are padded with 0
+ */
+template <class T>
+void gemmPackB(int kc, int nc, const T *b, int rs, int cs, T *out) {
+    constexpr int NR = GemmBlocking<T>::NR;
+    for (int j0 = 0; j0 < nc; j0 += NR) {
+        for (int p = 0; p < kc; p++) {
+            for (int j = 0; j < NR; j++) {
+                *out++ = j0 + j < nc ? b[p * rs + (j0 + j) * cs] : T(0);
+            }
+        }
+    }
+}
+
+/**
+ * C[0:mr, 0:nr] = alpha * A_panel * B_panel + beta * C[0:mr, 0:nr]
+ *
+ * C is not read if beta == 0, so it may be uninitialized
+ */
+template <class T>
+void gemmMicroKernel(int kc, T alpha, const T *a, const T *b, T beta, T *c,
+                     int ldc, int mr, int nr) {
+    constexpr int VL = GemmBlocking<T>::VL;
+    constexpr int MR = GemmBlocking<T>::MR;
+    constexpr int NR = GemmBlocking<T>::NR;
+    constexpr int NV = NR / VL;
+    typedef Vec<T, VL> V;
+
+    V acc[MR][NV];
+    for (int r = 0; r < MR; r++) {
+        for (int v = 0; v < NV; v++) {
+            acc[r][v] = vecBroadcast<T, VL>(0);
+        }
+    }
+    for (int p = 0; p < kc; p++) {
+        V bv[NV];
+        for (int v = 0; v < NV; v++) {
+            bv[v] = vecLoad<T, VL>(b + p * NR + v * VL);
+        }
+        for (int r = 0; r < MR; r++) {
+            V ar = vecBroadcast<T, VL>(a[p * MR + r]);
+            for (int v = 0; v < NV; v++) {
+                acc[r][v] += ar * bv[v];
+            }
+        }
+    }
+
+    V alphaV = vecBroadcast<T, VL>(alpha), betaV = vecBroadcast<T, VL>(beta);
+    if (mr == MR && nr == NR) {
+        for (int r = 0; r < MR; r++) {
+            for (int v = 0; v < NV; v++) {
+                T *cp = c + r * ldc + v * VL;
+                V res = alphaV * acc[r][v];
+                if (beta != T(0)) {
+                    res += betaV * vecLoad<T, VL>(cp);
+                }
+                vecStore<T, VL>(cp, res);
+            }
+        }
+    } else {
+        T tile[MR * NR];
+        for (int r = 0; r < MR; r++) {
+            for (int v = 0; v < NV; v++) {
+                vecStore<T, VL>(tile + r * NR + v * VL, acc[r][v]);
+            }
+        }
+        for (int r = 0; r < mr; r++) {
+            for (int j = 0; j < nr; j++) {
+                T &cr = c[r * ldc + j];
+                cr = beta == T(0) ? alpha * tile[r * NR + j]
+                                  : alpha * tile[r * NR + j] + beta * cr;
+            }
+        }
+    }
+}
+
+template <class T>
+void gemmBuiltin(bool transA, bool transB, int m, int n, int k, T alpha,
+                 const T *a, int lda, const T *b, int ldb, T beta, T *c,
+                 int ldc, CPUContext *ctx, int maxThreads) {
+    constexpr int MR = GemmBlocking<T>::MR;
+    constexpr int NR = GemmBlocking<T>::NR;
+    constexpr int KC = GemmBlocking<T>::KC;
+    constexpr int MC = GemmBlocking<T>::MC;
+    constexpr int NC = GemmBlocking<T>::NC;
+
+    if (k == 0) {
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                T &cr = c[i * ldc + j];
+                cr = beta == T(0) ? T(0) : beta * cr;
+            }
+        }
+        return;
+    }
+
+    int rsa = transA ? 1 : lda, csa = transA ? lda : 1;
+    int rsb = transB ? 1 : ldb, csb = transB ? ldb : 1;
+
+    // Parallelize over blocks of A
+    int nBlk = (m + MC - 1) / MC;
+    int nThreads = std::max(1, std::min(maxThreads, nBlk));
+
+    // The B block is shared by all threads working on this GEMM, while each
+    // thread packs its own A
+    size_t kcMax = std::min(KC, k);
+    size_t ncMax = std::min(NC, (n + NR - 1) / NR * NR);
+    size_t mcMax = std::min(MC, (m + MR - 1) / MR * MR);
+    T *pb = (T *)ctx->alloc(sizeof(T) * kcMax * ncMax);
+    T *packedA = (T *)ctx->alloc(sizeof(T) * mcMax * kcMax * nThreads);
+
+    for (int jc = 0; jc < n; jc += NC) {
+        int nc = std::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC) {
+            int kc = std::min(KC, k - pc);
+            T betaBlk = pc == 0 ? beta : T(1);
+            gemmPackB(kc, nc, b + pc * rsb + jc * csb, rsb, csb, pb);
+
+#pragma omp parallel for schedule(static) num_threads(nThreads)
+            for (int blk = 0; blk < nBlk; blk++) {
+                T *pa = packedA + omp_get_thread_num() * mcMax * kcMax;
+
+                int ic = blk * MC, mc = std::min(MC, m - ic);
+                gemmPackA(mc, kc, a + ic * rsa + pc * csa, rsa, csa, pa);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        gemmMicroKernel(kc, alpha, pa + ir * kc, pb + jr * kc,
+                                        betaBlk, c + (ic + ir) * ldc + jc + jr,
+                                        ldc, std::min(MR, mc - ir),
+                                        std::min(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+
+    ctx->free(pb);
+    ctx->free(packedA);
+}
+
+#ifdef FT_WITH_CBLAS
+inline void cblasGemm(bool transA, bool transB, int m, int n, int k,
+                      float alpha, const float *a, int lda, const float *b,
+                      int ldb, float beta, float *c, int ldc) {
+    cblas_sgemm(CblasRowMajor, transA ? CblasTrans : CblasNoTrans,
+                transB ? CblasTrans : CblasNoTrans, m, n, k, alpha, a, lda, b,
+                ldb, beta, c, ldc);
+}
+inline void cblasGemm(bool transA, bool transB, int m, int n, int k,
+                      double alpha, const double *a, int lda, const double *b,
+                      int ldb, double beta, double *c, int ldc) {
+    cblas_dgemm(CblasRowMajor, transA ? CblasTrans : CblasNoTrans,
+                transB ? CblasTrans : CblasNoTrans, m, n, k, alpha, a, lda, b,
+                ldb, beta, c, ldc);
+}
+#endif // FT_WITH_CBLAS
+
+template <class T>
+void gemmBatchStrided(bool transA, bool transB, int m, int n, int k, T alpha,
+                      const T *a, int lda, int stridea, const T *b, int ldb,
+                      int strideb, T beta, T *c, int ldc, int stridec,
+                      int batchSize, CPUContext *ctx, int maxThreads) {
+    for (int i = 0; i < batchSize; i++) {
+        const T *ai = a + i * stridea, *bi = b + i * strideb;
+        T *ci = c + i * stridec;
+#ifdef FT_WITH_CBLAS
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            cblasGemm(transA, transB, m, n, k, alpha, ai, lda, bi, ldb, beta,
+                      ci, ldc);
+            continue;
+        }
+#endif // FT_WITH_CBLAS
+        gemmBuiltin(transA, transB, m, n, k, alpha, ai, lda, bi, ldb, beta, ci,
+                    ldc, ctx, maxThreads);
+    }
+}
+
+#endif // CPU_GEMM_H
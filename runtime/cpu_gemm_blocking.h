@@ -0,0 +1,28 @@
+#ifndef CPU_GEMM_BLOCKING_H
+#define CPU_GEMM_BLOCKING_H
+
+/**
+ * Sizes of a BLIS-style blocked GEMM, shared by the built-in GEMM of the
+ * runtime (`cpu_gemm.h`) and the `asBlockedMatMul` schedule, which generates
+ * the same blocking in FreeTensor IR
+ *
+ * The register tile is MR x NR, and the packed blocks of A and B are MC x KC
+ * and KC x NC, respectively. NR is two vectors wide, so the MR x NR
+ * accumulators fit in vector registers. KC is chosen for L1, MC for L2 and NC
+ * for L3
+ */
+struct GemmBlockSizes {
+    int vl, mr, nr, kc, mc, nc;
+};
+
+/**
+ * @param vecBytes : Bytes of a SIMD vector of the target
+ * @param elemBytes : Bytes of an element of the matrices
+ */
+constexpr GemmBlockSizes gemmBlockSizes(int vecBytes, int elemBytes) {
+    int vl = vecBytes / elemBytes > 1 ? vecBytes / elemBytes : 1;
+    int mr = 6, nr = vl * 2;
+    return GemmBlockSizes{vl, mr, nr, 256, mr * 16, nr * 128};
+}
+
+#endif // CPU_GEMM_BLOCKING_H
@@ -0,0 +1,272 @@
+/**
+ * A worker process to measure CPU programs out of the process of FreeTensor, so
+ * a crashing or hanging program does not bring down the auto-scheduling. See
+ * `include/driver/measure_worker.h` for the protocol
+ *
+ * This file is compiled by the backend compiler on demand, not together with
+ * FreeTensor itself. The socket to FreeTensor is passed as stdin
+ */
+
+#include <algorithm> // max
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h> // setrlimit
+#include <unistd.h>
+#include <vector>
+
+#include "cpu_context.h"
+#include "timing.h"
+
+namespace {
+
+typedef void (*Entry)(void ** /* params */, void ** /* retRaw */,
+                      size_t ** /* retShapes */, size_t * /* retDims */,
+                      void * /* ctx */);
+
+void readAll(void *buf, size_t n) {
+    auto p = (uint8_t *)buf;
+    while (n > 0) {
+        auto k = read(STDIN_FILENO, p, n);
+        if (k == 0) {
+            exit(0); // FreeTensor has closed the socket
+        }
+        if (k < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            exit(1);
+        }
+        p += k, n -= k;
+    }
+}
+
+void writeAll(const void *buf, size_t n) {
+    auto p = (const uint8_t *)buf;
+    while (n > 0) {
+        auto k = write(STDIN_FILENO, p, n);
+        if (k < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            exit(1);
+        }
+        p += k, n -= k;
+    }
+}
+
+uint64_t readU64() {
+    uint64_t x;
+    readAll(&x, sizeof(x));
+    return x;
+}
+
+double readF64() {
+    double x;
+    readAll(&x, sizeof(x));
+    return x;
+}
+
+std::string readBytes() {
+    std::string s(readU64(), '\0');
+    readAll(s.data(), s.size());
+    return s;
+}
+
+void replyOk() { writeAll("K", 1); }
+
+void replyOk(const TimingResult &result) {
+    double stats[] = {result.mean_, result.median_, result.trimmedMean_,
+                      result.stddev_, result.relCI_};
+    uint64_t counts[] = {(uint64_t)result.rounds_, (uint64_t)result.repeats_};
+    writeAll("K", 1);
+    writeAll(stats, sizeof(stats));
+    writeAll(counts, sizeof(counts));
+}
+
+void replyError(const std::string &msg) {
+    uint64_t len = msg.size();
+    writeAll("E", 1);
+    writeAll(&len, sizeof(len));
+    writeAll(msg.data(), msg.size());
+}
+
+/**
+ * Align as `Array`s in FreeTensor, so vectorized programs behave the same
+ */
+void *alignedAlloc(size_t bytes) {
+    return aligned_alloc(64, std::max<size_t>((bytes + 63) / 64 * 64, 64));
+}
+
+void alignedFree(void *ptr) { free(ptr); }
+
+class Worker {
+    void *lib_ = nullptr;
+    std::unique_ptr<CPUContext> ctx_;
+    std::vector<void *> args_;
+
+  public:
+    ~Worker() {
+        unload();
+        setArgs({});
+    }
+
+    void unload() {
+        // Worker threads of the context may be running code of the library,
+        // so stop them first
+        ctx_ = nullptr;
+        if (lib_ != nullptr) {
+            dlclose(lib_);
+            lib_ = nullptr;
+        }
+    }
+
+    void load(const std::string &image) {
+        unload();
+
+        char path[] = "/tmp/ft_measure_XXXXXX.so";
+        int fd = mkstemps(path, 3);
+        if (fd == -1) {
+            throw std::runtime_error("Unable to create a temporary file");
+        }
+        bool ok = true;
+        for (size_t done = 0; ok && done < image.size();) {
+            auto k = write(fd, image.data() + done, image.size() - done);
+            if (k > 0) {
+                done += k;
+            } else if (k == -1 && errno != EINTR) {
+                ok = false;
+            }
+        }
+        close(fd);
+        if (ok) {
+            lib_ = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+        }
+        unlink(path);
+        if (!ok) {
+            throw std::runtime_error("Unable to write the binary to a "
+                                     "temporary file");
+        }
+        if (lib_ == nullptr) {
+            throw std::runtime_error((std::string) "Unable to load target "
+                                                   "code: " +
+                                     dlerror());
+        }
+
+        // Pin the OpenMP runtime, so it is never unloaded together with the
+        // library while its worker threads are still alive
+        if (auto sym = dlsym(lib_, "omp_get_num_threads"); sym != nullptr) {
+            Dl_info info;
+            if (dladdr(sym, &info) != 0 && info.dli_fname != nullptr) {
+                dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD | RTLD_NODELETE);
+            }
+        }
+
+        ctx_ = std::make_unique<CPUContext>(alignedAlloc, alignedFree);
+    }
+
+    void setArgs(const std::vector<std::string> &data) {
+        for (void *arg : args_) {
+            alignedFree(arg);
+        }
+        args_.clear();
+        for (auto &&item : data) {
+            args_.emplace_back(alignedAlloc(item.size()));
+            memcpy(args_.back(), item.data(), item.size());
+        }
+    }
+
+    TimingResult time(const std::string &entry, size_t nRets,
+                      const TimingOptions &options) {
+        if (lib_ == nullptr) {
+            throw std::runtime_error("No binary is loaded");
+        }
+        auto func = (Entry)dlsym(lib_, entry.c_str());
+        if (func == nullptr) {
+            throw std::runtime_error((std::string) "Target function not "
+                                                   "found: " +
+                                     dlerror());
+        }
+
+        std::vector<void *> rets(nRets, nullptr);
+        std::vector<size_t *> retShapes(nRets, nullptr);
+        std::vector<size_t> retDims(nRets, 0);
+        auto run = [&]() {
+            func(args_.data(), rets.data(), retShapes.data(), retDims.data(),
+                 ctx_.get());
+            // The return values are not needed
+            for (size_t i = 0; i < nRets; i++) {
+                alignedFree(rets[i]);
+                alignedFree(retShapes[i]);
+                rets[i] = nullptr;
+                retShapes[i] = nullptr;
+                retDims[i] = 0;
+            }
+        };
+
+        return measureTime(run, options);
+    }
+};
+
+} // Anonymous namespace
+
+int main(int argc, char **argv) {
+    // argv[1]: Limit of the address space in bytes, 0 for unlimited
+    if (argc > 1) {
+        if (rlim_t bytes = strtoull(argv[1], nullptr, 10); bytes > 0) {
+            struct rlimit rlim = {bytes, bytes};
+            setrlimit(RLIMIT_AS, &rlim);
+        }
+    }
+    // A crashing program is expected from time to time. Don't dump its core
+    struct rlimit noCore = {0, 0};
+    setrlimit(RLIMIT_CORE, &noCore);
+
+    Worker worker;
+    while (true) {
+        char kind;
+        readAll(&kind, 1);
+        try {
+            switch (kind) {
+            case 'L': {
+                auto image = readBytes();
+                worker.load(image);
+                replyOk();
+                break;
+            }
+            case 'A': {
+                std::vector<std::string> data(readU64());
+                for (auto &&item : data) {
+                    item = readBytes();
+                }
+                worker.setArgs(data);
+                replyOk();
+                break;
+            }
+            case 'T': {
+                auto entry = readBytes();
+                auto nRets = readU64();
+                TimingOptions options;
+                options.warmups_ = readU64();
+                options.minRounds_ = readU64();
+                options.maxRounds_ = readU64();
+                options.maxRelCI_ = readF64();
+                options.minRoundTime_ = readF64();
+                options.flushCache_ = readU64();
+                replyOk(worker.time(entry, nRets, options));
+                break;
+            }
+            default:
+                // We are out of sync with FreeTensor. Let it restart us
+                return 1;
+            }
+        } catch (const std::exception &e) {
+            replyError(e.what());
+        }
+    }
+}
@@ -15,6 +15,9 @@
 #endif
 
 #include "cpu_context.h"
+#include "cpu_gemm.h"
+#include "cpu_stream.h"
+#include "cpu_vector.h"
 
 #define restrict __restrict__
 #define __ByValArray std::array
@@ -39,6 +42,54 @@ T runtime_mod(T a, T b) {
     return m;
 }
 
+#ifdef FT_WITH_MKL
+
+/**
+ * Number of threads for a BLAS call inside an OpenMP loop of `outerLen`
+ * iterations. A short outer loop occupies only `outerLen` threads, so the
+ * remaining hardware threads are split among the inner calls
+ *
+ * `outerThreads` is the size of the team running the outer loop, which is
+ * the thread pool instead of OpenMP if it is used
+ */
+inline int innerBLASThreads(int64_t outerLen,
+                            int64_t outerThreads = omp_get_num_threads()) {
+    int64_t outer = std::min<int64_t>(outerThreads, outerLen);
+    outer = std::max<int64_t>(outer, 1);
+    return std::max<int64_t>(1, omp_get_num_procs() / outer);
+}
+
+/**
+ * Allow BLAS calls in an OpenMP loop to spawn their own threads, during the
+ * lifetime of this object. MKL uses only one thread in a parallel region
+ * unless dynamic adjustment is off and nested parallelism is enabled
+ *
+ * The settings are process-wide, so the old ones are restored on destruction,
+ * not to affect the BLAS calls of the user out of FreeTensor
+ */
+class NestedBLASGuard {
+    int oldDynamic_, oldMaxActiveLevels_;
+
+  public:
+    NestedBLASGuard()
+        : oldDynamic_(mkl_get_dynamic()),
+          oldMaxActiveLevels_(omp_get_max_active_levels()) {
+        mkl_set_dynamic(0);
+        if (oldMaxActiveLevels_ < 2) {
+            omp_set_max_active_levels(2);
+        }
+    }
+    ~NestedBLASGuard() {
+        mkl_set_dynamic(oldDynamic_);
+        omp_set_max_active_levels(oldMaxActiveLevels_);
+    }
+
+    NestedBLASGuard(const NestedBLASGuard &) = delete;
+    NestedBLASGuard &operator=(const NestedBLASGuard &) = delete;
+};
+
+#endif // FT_WITH_MKL
+
 template <class T> T runtime_square(T x) { return x * x; }
 
 template <class T> T runtime_sigmoid(T x) { return 1.0 / (1.0 + std::exp(-x)); }
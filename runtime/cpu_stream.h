@@ -0,0 +1,99 @@
+#ifndef CPU_STREAM_H
+#define CPU_STREAM_H
+
+#include <cstdint>
+#include <cstring> // memcpy
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "cpu_vector.h"
+
+/**
+ * Non-temporal (streaming) stores for variables marked with `streaming_store`.
+ * The data bypasses the cache, which saves the read-for-ownership of a regular
+ * store and keeps other data in the cache. A streaming store is weakly ordered,
+ * so a loop of streaming stores ends with `streamFence`
+ *
+ * On architectures or data types without streaming stores, they fall back to
+ * regular stores
+ */
+
+template <class T> void streamStore(T *p, T x) {
+#ifdef __SSE2__
+    if constexpr (sizeof(T) == 4) {
+        int bits;
+        memcpy(&bits, &x, 4);
+        _mm_stream_si32((int *)p, bits);
+        return;
+    }
+#endif
+#if defined(__SSE2__) && defined(__x86_64__)
+    if constexpr (sizeof(T) == 8) {
+        long long bits;
+        memcpy(&bits, &x, 8);
+        _mm_stream_si64((long long *)p, bits);
+        return;
+    }
+#endif
+    *p = x;
+}
+
+template <class T, int N> void vecStreamStore(T *p, const Vec<T, N> &v) {
+    // Vector streaming stores require aligned addresses. Otherwise, store the
+    // lanes one by one, which are still combined in the write-combining buffer
+    [[maybe_unused]] bool aligned = ((uintptr_t)p & (sizeof(v) - 1)) == 0;
+#ifdef __AVX512F__
+    if constexpr (sizeof(v) == 64) {
+        if (aligned) {
+            __m512i bits;
+            memcpy(&bits, &v, 64);
+            _mm512_stream_si512((__m512i *)p, bits);
+            return;
+        }
+    }
+#endif
+#ifdef __AVX__
+    if constexpr (sizeof(v) == 32) {
+        if (aligned) {
+            __m256i bits;
+            memcpy(&bits, &v, 32);
+            _mm256_stream_si256((__m256i *)p, bits);
+            return;
+        }
+    }
+#endif
+#ifdef __SSE2__
+    if constexpr (sizeof(v) == 16) {
+        if (aligned) {
+            __m128i bits;
+            memcpy(&bits, &v, 16);
+            _mm_stream_si128((__m128i *)p, bits);
+            return;
+        }
+    }
+#endif
+    for (int i = 0; i < N; i++) {
+        streamStore<T>(p + i, v[i]);
+    }
+}
+template <class T, int N>
+void vecStreamStoreN(T *p, const Vec<T, N> &v, int n) {
+    for (int i = 0; i < n; i++) {
+        streamStore<T>(p + i, v[i]);
+    }
+}
+
+/**
+ * Make streaming stores of this thread visible before later stores
+ */
+inline void streamFence() {
+#ifdef __SSE2__
+    _mm_sfence();
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif // CPU_STREAM_H
@@ -0,0 +1,266 @@
+#ifndef CPU_THREAD_POOL_H
+#define CPU_THREAD_POOL_H
+
+#include <algorithm> // min, max
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility> // pair
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h> // cpu_set_t
+
+/**
+ * A persistent pool of worker threads, used by parallel loops when the CPU
+ * target selects `ParallelRuntime::ThreadPool` instead of OpenMP
+ *
+ * The workers are created once and sleep between loops, so a loop only pays
+ * for a wake-up instead of forking a team. The iteration space of a loop is
+ * evenly split among the participating threads (the workers plus the calling
+ * thread). Each thread takes chunks from the front of its own range, and
+ * steals chunks from the ranges of the others after finishing its own, so a
+ * load-imbalanced loop is balanced without a central queue
+ *
+ * One pool is shared by all the programs in a process (see
+ * `CPUContext::initThreadPool`). Loops nested in a running loop, or started by
+ * another thread while a loop is running, are executed serially by the calling
+ * thread
+ *
+ * Optionally, the workers are pinned to cores, filling one socket after
+ * another, so consecutive ranges are processed on the same NUMA node
+ */
+class ThreadPool {
+    struct alignas(64) Range {
+        std::atomic<int64_t> next_;
+        int64_t end_;
+    };
+
+    typedef void (*Job)(void * /* fn */, int64_t /* begin */,
+                        int64_t /* end */);
+
+    std::vector<pthread_t> workers_;
+    std::unique_ptr<Range[]> ranges_; // One per thread, the caller is the last
+    size_t stackBytes_;
+    bool pinned_;
+
+    std::mutex lock_;
+    std::condition_variable wake_, done_;
+    uint64_t generation_ = 0;
+    int pending_ = 0; // Workers not finished with the current loop
+    bool stop_ = false;
+
+    std::atomic<bool> running_{false}; // Whether a loop is running
+    std::mutex reductionLock_;
+
+    // The current loop
+    Job job_ = nullptr;
+    void *fn_ = nullptr;
+    int64_t grain_ = 1;
+
+    /**
+     * CPUs we are allowed to run on, sorted by socket
+     */
+    static std::vector<int> cpusBySocket() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+            return {};
+        }
+        std::vector<std::pair<int, int>> cpus; // (socket, cpu)
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                int socket = 0;
+                auto path = "/sys/devices/system/cpu/cpu" +
+                            std::to_string(cpu) +
+                            "/topology/physical_package_id";
+                if (FILE *f = fopen(path.c_str(), "r"); f != nullptr) {
+                    if (fscanf(f, "%d", &socket) != 1) {
+                        socket = 0;
+                    }
+                    fclose(f);
+                }
+                cpus.emplace_back(socket, cpu);
+            }
+        }
+        std::stable_sort(cpus.begin(), cpus.end(),
+                         [](auto &&l, auto &&r) { return l.first < r.first; });
+        std::vector<int> ret;
+        for (auto &&[socket, cpu] : cpus) {
+            ret.emplace_back(cpu);
+        }
+        return ret;
+    }
+
+    static void *workerEntry(void *arg) {
+        auto *self = ((std::pair<ThreadPool *, int> *)arg)->first;
+        int id = ((std::pair<ThreadPool *, int> *)arg)->second;
+        delete (std::pair<ThreadPool *, int> *)arg;
+        self->workerLoop(id);
+        return nullptr;
+    }
+
+    void workerLoop(int id) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> guard(lock_);
+                wake_.wait(guard,
+                           [&]() { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            work(id);
+            std::lock_guard<std::mutex> guard(lock_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    /**
+     * Run chunks from our own range, and then from the others' ranges
+     */
+    void work(int id) {
+        int n = numThreads();
+        for (int k = 0; k < n; k++) {
+            auto &&range = ranges_[(id + k) % n];
+            while (true) {
+                int64_t begin = range.next_.fetch_add(
+                    grain_, std::memory_order_relaxed);
+                if (begin >= range.end_) {
+                    break;
+                }
+                job_(fn_, begin, std::min(begin + grain_, range.end_));
+            }
+        }
+    }
+
+  public:
+    /**
+     * @param nThreads : Number of threads including the caller. 0 = one per
+     * hardware thread
+     * @param stackBytes : Stack size of each worker. 0 = the system default
+     * @param pinned : Pin the workers to cores
+     */
+    explicit ThreadPool(int nThreads = 0, size_t stackBytes = 0,
+                        bool pinned = false)
+        : stackBytes_(stackBytes), pinned_(pinned) {
+        if (nThreads <= 0) {
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        ranges_ = std::make_unique<Range[]>(nThreads);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (stackBytes > 0) {
+            pthread_attr_setstacksize(&attr, stackBytes);
+        }
+        std::vector<int> cpus;
+        if (pinned) {
+            cpus = cpusBySocket();
+        }
+        for (int i = 0; i < nThreads - 1; i++) {
+            if (!cpus.empty()) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpus[i % cpus.size()], &set);
+                pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+            }
+            pthread_t thread;
+            auto *arg = new std::pair<ThreadPool *, int>(this, i);
+            if (pthread_create(&thread, &attr, workerEntry, arg) != 0) {
+                std::cerr << "Error creating a worker thread" << std::endl;
+                exit(-1);
+            }
+            workers_.emplace_back(thread);
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &&thread : workers_) {
+            pthread_join(thread, nullptr);
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int numThreads() const { return workers_.size() + 1; }
+    size_t stackBytes() const { return stackBytes_; }
+    bool pinned() const { return pinned_; }
+
+    /**
+     * Guards the final combination of private reduction buffers
+     */
+    std::mutex &reductionLock() { return reductionLock_; }
+
+    /**
+     * Call `fn(lo, hi)` for disjoint sub-ranges covering [begin, end)
+     *
+     * @param grain : Number of iterations in a chunk. 0 = choose
+     * automatically
+     */
+    template <class F>
+    void parallelFor(int64_t begin, int64_t end, int64_t grain, F &&fn) {
+        if (begin >= end) {
+            return;
+        }
+        int n = numThreads();
+        // No thread-local flag for nesting, or the flag would be a GNU_UNIQUE
+        // symbol, which prevents the program from being unloaded
+        if (n == 1 || running_.exchange(true, std::memory_order_acquire)) {
+            fn(begin, end);
+            return;
+        }
+
+        int64_t len = end - begin;
+        if (grain <= 0) {
+            // Several chunks per thread, so there is something to steal
+            grain = std::max<int64_t>(1, len / ((int64_t)n * 8));
+        }
+        for (int i = 0; i < n; i++) {
+            ranges_[i].next_.store(begin + len * i / n,
+                                   std::memory_order_relaxed);
+            ranges_[i].end_ = begin + len * (i + 1) / n;
+        }
+        job_ = [](void *f, int64_t lo, int64_t hi) {
+            (*(std::remove_reference_t<F> *)f)(lo, hi);
+        };
+        fn_ = (void *)&fn;
+        grain_ = grain;
+
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            pending_ = n - 1;
+            generation_++;
+        }
+        wake_.notify_all();
+
+        work(n - 1);
+
+        {
+            std::unique_lock<std::mutex> guard(lock_);
+            done_.wait(guard, [&]() { return pending_ == 0; });
+        }
+        running_.store(false, std::memory_order_release);
+    }
+};
+
+#endif // CPU_THREAD_POOL_H
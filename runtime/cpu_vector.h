@@ -0,0 +1,121 @@
+#ifndef CPU_VECTOR_H
+#define CPU_VECTOR_H
+
+#include <cstring> // memcpy
+
+/**
+ * Helpers for explicit SIMD code generated by pass/cpu/lower_vector, based on
+ * GCC vector extensions. Arithmetic and comparison operators work on the vector
+ * types directly. The backend compiler maps them to AVX2, AVX-512 or NEON
+ * instructions, depending on the target architecture
+ *
+ * Functions with an `N` suffix only touch the first `n` lanes, and are used for
+ * the tail of a loop whose length is not divisible by the vector length
+ */
+
+template <class T, int N> struct VecType {
+    typedef T type __attribute__((vector_size(N * sizeof(T))));
+};
+template <class T, int N> using Vec = typename VecType<T, N>::type;
+
+template <class T, int N> Vec<T, N> vecBroadcast(T x) {
+    Vec<T, N> ret;
+    for (int i = 0; i < N; i++) {
+        ret[i] = x;
+    }
+    return ret;
+}
+
+template <class T, int N> Vec<T, N> vecIota(T base) {
+    Vec<T, N> ret;
+    for (int i = 0; i < N; i++) {
+        ret[i] = base + i;
+    }
+    return ret;
+}
+
+template <class T, int N> Vec<T, N> vecLoad(const T *p) {
+    Vec<T, N> ret;
+    memcpy(&ret, p, sizeof(ret)); // No alignment required
+    return ret;
+}
+template <class T, int N> Vec<T, N> vecLoadN(const T *p, int n) {
+    Vec<T, N> ret = {};
+    for (int i = 0; i < n; i++) {
+        ret[i] = p[i];
+    }
+    return ret;
+}
+
+template <class T, int N> void vecStore(T *p, const Vec<T, N> &v) {
+    memcpy(p, &v, sizeof(v));
+}
+template <class T, int N> void vecStoreN(T *p, const Vec<T, N> &v, int n) {
+    for (int i = 0; i < n; i++) {
+        p[i] = v[i];
+    }
+}
+
+template <class T, int N, class I>
+Vec<T, N> vecGather(const T *p, const I &idx) {
+    Vec<T, N> ret;
+    for (int i = 0; i < N; i++) {
+        ret[i] = p[idx[i]];
+    }
+    return ret;
+}
+template <class T, int N, class I>
+Vec<T, N> vecGatherN(const T *p, const I &idx, int n) {
+    Vec<T, N> ret = {};
+    for (int i = 0; i < n; i++) {
+        ret[i] = p[idx[i]];
+    }
+    return ret;
+}
+
+template <class T, int N, class I>
+void vecScatter(T *p, const I &idx, const Vec<T, N> &v) {
+    for (int i = 0; i < N; i++) {
+        p[idx[i]] = v[i];
+    }
+}
+template <class T, int N, class I>
+void vecScatterN(T *p, const I &idx, const Vec<T, N> &v, int n) {
+    for (int i = 0; i < n; i++) {
+        p[idx[i]] = v[i];
+    }
+}
+
+template <class V> V vecMin(const V &a, const V &b) { return a < b ? a : b; }
+template <class V> V vecMax(const V &a, const V &b) { return a > b ? a : b; }
+
+template <class T, int N> T vecReduceAdd(const Vec<T, N> &v, int n = N) {
+    T ret = 0;
+    for (int i = 0; i < n; i++) {
+        ret += v[i];
+    }
+    return ret;
+}
+template <class T, int N> T vecReduceMul(const Vec<T, N> &v, int n = N) {
+    T ret = 1;
+    for (int i = 0; i < n; i++) {
+        ret *= v[i];
+    }
+    return ret;
+}
+template <class T, int N> T vecReduceMin(const Vec<T, N> &v, int n = N) {
+    T ret = v[0];
+    for (int i = 1; i < n; i++) {
+        ret = v[i] < ret ? v[i] : ret;
+    }
+    return ret;
+}
+template <class T, int N> T vecReduceMax(const Vec<T, N> &v, int n = N) {
+    T ret = v[0];
+    for (int i = 1; i < n; i++) {
+        ret = v[i] > ret ? v[i] : ret;
+    }
+    return ret;
+}
+
+#endif // CPU_VECTOR_H
@@ -0,0 +1,164 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <algorithm> // sort, max
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <unistd.h> // sysconf
+
+/**
+ * How to measure the time of a program
+ *
+ * A measurement consists of some rounds, each of which times one or more
+ * consecutive runs of the program. Rounds are repeated from `minRounds_` up to
+ * `maxRounds_`, until the time is stable enough
+ */
+struct TimingOptions {
+    int warmups_ = 3;    /// Rounds to run before measuring
+    int minRounds_ = 10; /// Measure at least this amount of rounds
+    int maxRounds_ = 10; /// Measure at most this amount of rounds
+
+    /// Stop measuring once the half width of the 95% confidence interval of
+    /// the mean time, relative to the mean, is below this. 0 for always
+    /// measuring `maxRounds_` rounds
+    double maxRelCI_ = 0;
+
+    /// Min time of a round in ms. A faster program is run repeatedly in a
+    /// round, and the time is divided, so the resolution of the clock and the
+    /// overhead of timing do not matter. Not applied with `flushCache_`
+    double minRoundTime_ = 0;
+
+    /// Evict the caches before each round, and run the program only once in a
+    /// round, to measure it with cold caches
+    bool flushCache_ = false;
+};
+
+/**
+ * Statistics of the time of a program over all rounds, in ms per run
+ */
+struct TimingResult {
+    double mean_ = 0, median_ = 0;
+    double trimmedMean_ = 0; /// Mean without the top and bottom 10% rounds
+    double stddev_ = 0;      /// Standard deviation of the rounds
+    double relCI_ = 0; /// Half width of the 95% CI of the mean, over the mean
+    int rounds_ = 0;   /// Rounds measured
+    int repeats_ = 1;  /// Runs in each round
+};
+
+/**
+ * Evict the CPU caches by writing through a buffer larger than the last level
+ * cache
+ */
+inline void flushCPUCache() {
+    static std::vector<uint8_t> buf = []() {
+        long llc = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+        if (llc <= 0) {
+            llc = 64l << 20; // Unknown. Assume a large one
+        }
+        return std::vector<uint8_t>(llc * 2);
+    }();
+    volatile uint8_t *p = buf.data();
+    for (size_t i = 0, n = buf.size(); i < n; i += 64) {
+        p[i]++;
+    }
+}
+
+/**
+ * Two-sided 95% quantile of Student's t-distribution
+ */
+inline double tQuantile95(int df) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571,
+                                   2.447,  2.365, 2.306, 2.262, 2.228};
+    if (df <= 0) {
+        return INFINITY;
+    }
+    if (df <= 10) {
+        return table[df - 1];
+    }
+    return 1.96 + 2.4 / df; // Within 1% for df > 10
+}
+
+/**
+ * Measure the time of a program
+ *
+ * @param run : Run the program once, and wait for it to finish
+ * @param options : How to measure
+ * @param flush : Evict the caches. Defaults to `flushCPUCache`
+ */
+inline TimingResult measureTime(const std::function<void()> &run,
+                                const TimingOptions &options,
+                                const std::function<void()> &flush = nullptr) {
+    namespace ch = std::chrono;
+    auto timeOf = [&](int repeats) {
+        if (options.flushCache_) {
+            flush ? flush() : flushCPUCache();
+        }
+        auto beg = ch::steady_clock::now();
+        for (int i = 0; i < repeats; i++) {
+            run();
+        }
+        auto end = ch::steady_clock::now();
+        return ch::duration_cast<ch::duration<double>>(end - beg).count() *
+               1000 / repeats; // ms
+    };
+
+    TimingResult ret;
+    double last = 0;
+    for (int i = 0; i < options.warmups_; i++) {
+        last = timeOf(1);
+    }
+    if (options.minRoundTime_ > 0 && !options.flushCache_) {
+        if (options.warmups_ == 0) {
+            last = timeOf(1);
+        }
+        // Calibrate with the last warmup round
+        ret.repeats_ = std::max(
+            1, (int)std::ceil(options.minRoundTime_ / std::max(last, 1e-6)));
+    }
+
+    std::vector<double> times;
+    double sum = 0, sqSum = 0;
+    int maxRounds = std::max(options.maxRounds_, options.minRounds_);
+    while ((int)times.size() < maxRounds) {
+        double t = timeOf(ret.repeats_);
+        times.emplace_back(t);
+        sum += t, sqSum += t * t;
+
+        int n = times.size();
+        ret.mean_ = sum / n;
+        ret.stddev_ =
+            n > 1 ? std::sqrt(std::max(0., (sqSum - sum * ret.mean_) / (n - 1)))
+                  : 0;
+        ret.relCI_ = n > 1 && ret.mean_ > 0 ? tQuantile95(n - 1) * ret.stddev_ /
+                                                  std::sqrt(n) / ret.mean_
+                                            : INFINITY;
+        if (n >= options.minRounds_ && options.maxRelCI_ > 0 &&
+            ret.relCI_ <= options.maxRelCI_) {
+            break;
+        }
+    }
+    ret.rounds_ = times.size();
+    if (times.empty()) {
+        return ret;
+    }
+
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+    ret.median_ = n % 2 == 1 ? times[n / 2]
+                             : (times[n / 2 - 1] + times[n / 2]) / 2;
+    size_t trim = n / 10;
+    double trimmedSum = 0;
+    for (size_t i = trim; i < n - trim; i++) {
+        trimmedSum += times[i];
+    }
+    ret.trimmedMean_ = trimmedSum / (n - 2 * trim);
+    return ret;
+}
+
+#endif // TIMING_H
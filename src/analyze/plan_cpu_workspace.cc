@@ -0,0 +1,138 @@
+#include <algorithm>
+
+#include <analyze/plan_cpu_workspace.h>
+
+namespace freetensor {
+
+void FindWorkspaceLiveRanges::access(const std::string &var) {
+    auto it = nameToCandidate_.find(var);
+    if (it == nameToCandidate_.end() || it->second.empty() ||
+        it->second.back() == -1) {
+        return;
+    }
+    int i = it->second.back();
+    auto &&c = candidates_[i];
+    size_t depth = defDepth_.at(i);
+    if (loops_.size() > depth) {
+        // Accessed in a loop inside the scope of the VarDef. Keep it alive in
+        // the whole loop
+        auto &&[loop, begin] = loops_[depth];
+        c.begin_ = std::min(c.begin_, begin);
+        extendToLoopEnd_[loop->id()].emplace_back(i);
+    } else {
+        c.begin_ = std::min(c.begin_, now_);
+        c.end_ = std::max(c.end_, now_);
+    }
+}
+
+void FindWorkspaceLiveRanges::visitStmt(const Stmt &op) {
+    now_++;
+    Visitor::visitStmt(op);
+}
+
+void FindWorkspaceLiveRanges::visit(const VarDef &op) {
+    int i = -1;
+    auto &&tensor = op->buffer_->tensor();
+    if (op->buffer_->atype() == AccessType::Cache &&
+        op->buffer_->mtype() == MemType::CPU && !inParallel_ &&
+        !tensor->shape().empty()) {
+        size_t size = sizeOf(tensor->dtype());
+        for (auto &&dim : tensor->shape()) {
+            if (dim->nodeType() != ASTNodeType::IntConst) {
+                size = 0;
+                break;
+            }
+            size *= dim.as<IntConstNode>()->val_;
+        }
+        if (size > 0 && size >= minSize_) {
+            i = candidates_.size();
+            candidates_.push_back({op->id(), size});
+            defDepth_[i] = loops_.size();
+        }
+    }
+
+    nameToCandidate_[op->name_].emplace_back(i);
+    Visitor::visit(op);
+    nameToCandidate_[op->name_].pop_back();
+}
+
+void FindWorkspaceLiveRanges::visit(const For &op) {
+    bool oldInParallel = inParallel_;
+    if (std::holds_alternative<OpenMPScope>(op->property_->parallel_)) {
+        inParallel_ = true;
+    }
+    loops_.emplace_back(op, now_);
+    Visitor::visit(op);
+    loops_.pop_back();
+    inParallel_ = oldInParallel;
+
+    if (auto it = extendToLoopEnd_.find(op->id());
+        it != extendToLoopEnd_.end()) {
+        for (int i : it->second) {
+            candidates_[i].end_ = std::max(candidates_[i].end_, now_);
+        }
+        extendToLoopEnd_.erase(it);
+    }
+}
+
+void FindWorkspaceLiveRanges::visit(const Load &op) {
+    Visitor::visit(op);
+    access(op->var_);
+}
+
+void FindWorkspaceLiveRanges::visit(const Store &op) {
+    Visitor::visit(op);
+    access(op->var_);
+}
+
+void FindWorkspaceLiveRanges::visit(const ReduceTo &op) {
+    Visitor::visit(op);
+    access(op->var_);
+}
+
+WorkspacePlan planCPUWorkspace(const Stmt &op, size_t minSize, size_t align) {
+    FindWorkspaceLiveRanges finder(minSize);
+    finder(op);
+
+    std::vector<FindWorkspaceLiveRanges::Candidate> todo;
+    for (auto &&c : finder.candidates()) {
+        if (c.begin_ <= c.end_) { // Skip unused buffers
+            todo.emplace_back(c);
+        }
+    }
+    std::stable_sort(todo.begin(), todo.end(),
+                     [](const auto &lhs, const auto &rhs) {
+                         return lhs.size_ > rhs.size_;
+                     });
+
+    WorkspacePlan plan;
+    std::vector<std::pair<size_t, size_t>> placed; // (offset, index in todo)
+    for (size_t i = 0, n = todo.size(); i < n; i++) {
+        auto &&c = todo[i];
+
+        // Occupied ranges of buffers alive at the same time, by offset
+        std::vector<std::pair<size_t, size_t>> busy;
+        for (auto &&[offset, j] : placed) {
+            if (todo[j].begin_ <= c.end_ && c.begin_ <= todo[j].end_) {
+                busy.emplace_back(offset, offset + todo[j].size_);
+            }
+        }
+        std::sort(busy.begin(), busy.end());
+
+        // First fit
+        size_t offset = 0;
+        for (auto &&[lo, hi] : busy) {
+            if (offset + c.size_ <= lo) {
+                break;
+            }
+            offset = std::max(offset, (hi + align - 1) / align * align);
+        }
+
+        placed.emplace_back(offset, i);
+        plan.offsets_[c.id_] = offset;
+        plan.size_ = std::max(plan.size_, offset + c.size_);
+    }
+    return plan;
+}
+
+} // namespace freetensor
@@ -1,4 +1,5 @@
 #include <cmath>
+#include <sstream>
 
 #include <analyze/find_elementwise.h>
 #include <analyze/fixed_length_feature.h>
@@ -15,6 +16,9 @@
 #include <codegen/code_gen_cpu.h>
 #include <codegen/code_gen_cuda.h>
 #include <driver.h>
+#include <driver/build_pool.h>
+#include <driver/compiler_job.h>
+#include <hash_combine.h>
 #include <lower.h>
 #include <queue>
 #include <utility>
@@ -30,7 +34,13 @@ AutoSchedule::AutoSchedule(
     : original_(schedule.clone()), target_(target), device_(device),
       measuredSize_(measuredSize), paramsSet_(false),
       predictFunc_(std::move(predictFunc)), updateFunc_(std::move(updateFunc)),
-      tag_(std::move(tag)) {
+      tag_(std::move(tag)), pipeline_(std::make_unique<MeasurePipeline>()) {
+    timingOptions_.warmups_ = 5;
+    timingOptions_.minRounds_ = 5;
+    timingOptions_.maxRounds_ = 50;
+    timingOptions_.maxRelCI_ = 0.02;
+    timingOptions_.minRoundTime_ = 1;
+
     flop_ = 0;
     auto opCnt =
         structuralFeature(original_.ast())[original_.ast()->id()].opCnt_;
@@ -61,49 +71,225 @@ void AutoSchedule::setParams(
     args_ = args;
     kws_ = kws;
     paramsSet_ = true;
+    measureArgs_ = nullptr; // Packed again when needed
 }
 
-std::vector<double> AutoSchedule::measure(std::vector<Ref<Sketch>> &sketches) {
-    // Compile in parallel, and measure sequentially
-    // TODO: Parallel among computing nodes
-
-    size_t n = sketches.size();
+/**
+ * Build a batch of CPU programs into one binary
+ *
+ * A failing program fails its whole batch, so the programs in a failed batch
+ * are rebuilt one by one. A program failing by itself gets a null `Driver`
+ */
+static std::vector<Ref<Driver>> buildBatch(const std::vector<Func> &funcs,
+                                           const std::vector<std::string> &srcs,
+                                           const Ref<Device> &device) {
+    size_t n = funcs.size();
     std::vector<Ref<Driver>> drivers(n);
-#pragma omp parallel for
+    Ref<BatchBinary> batch;
+    try {
+        batch = Ref<BatchBinary>::make(srcs, device);
+    } catch (const DriverError &) {
+        // Rebuild below
+    }
     for (size_t i = 0; i < n; i++) {
         try {
-            drivers[i] = Ref<Driver>::make(sketches[i]->lowered(),
-                                           sketches[i]->code(), device_);
+            drivers[i] = batch.isValid()
+                             ? Ref<Driver>::make(funcs[i], batch, i)
+                             : Ref<Driver>::make(funcs[i], srcs[i], device);
         } catch (const std::exception &e) {
-            // OpenMP threads won't report an exception message
             std::cerr << "ERROR measure: " << e.what() << std::endl;
             drivers[i] = nullptr;
         }
     }
+    return drivers;
+}
 
-    std::vector<double> times;
-    times.reserve(n);
+/**
+ * Build a batch of CPU programs into one binary for a `MeasureWorker`
+ *
+ * Same as `buildBatch`, but the binaries are not loaded in this process.
+ * Returns the binary and the entrance of each program
+ */
+static std::vector<std::pair<Ref<MeasureImage>, std::string>>
+buildBatchImage(const std::vector<std::string> &srcs,
+                const Ref<Device> &device) {
+    size_t n = srcs.size();
+    std::vector<std::pair<Ref<MeasureImage>, std::string>> images(n);
+    try {
+        auto batch = Ref<MeasureImage>::make(
+            Driver::buildImage(BatchBinary::source(srcs), device).first);
+        for (size_t i = 0; i < n; i++) {
+            images[i] = {batch, BatchBinary::entry(i)};
+        }
+        return images;
+    } catch (const DriverError &) {
+        // Rebuild below
+    }
     for (size_t i = 0; i < n; i++) {
-        std::cout << "measure " << i << std::endl;
-        ASSERT(paramsSet_);
         try {
-            if (!drivers[i].isValid()) {
-                times.emplace_back(1e30);
-                continue;
-            }
-            drivers[i]->setArgs(args_, kws_);
-            double t = drivers[i]->time(5, 20);
-            times.emplace_back(t);
+            images[i] = {Ref<MeasureImage>::make(
+                             Driver::buildImage(srcs[i], device).first),
+                         "run"};
         } catch (const std::exception &e) {
-            // OpenMP threads won't report an exception message
             std::cerr << "ERROR measure: " << e.what() << std::endl;
-            std::cerr << toString(sketches[i]->code()) << std::endl;
-            times.emplace_back(1e30);
+            images[i] = {nullptr, ""};
+        }
+    }
+    return images;
+}
+
+std::vector<std::future<double>>
+AutoSchedule::measureInWorkers(std::vector<Ref<Sketch>> &sketches) {
+    typedef std::shared_future<
+        std::vector<std::pair<Ref<MeasureImage>, std::string>>>
+        Building;
+
+    size_t n = sketches.size();
+    if (n == 0) {
+        return {};
+    }
+    if (!measureArgs_.isValid()) {
+        // All the programs share the signature of the original one
+        measureArgs_ = MeasureArgs::pack(sketches.front()->lowered(), args_,
+                                         kws_);
+    }
+
+    std::vector<std::future<double>> times;
+    times.reserve(n);
+    size_t nBatches = std::min(n, maxCompilerJobs());
+    for (size_t b = 0; b < nBatches; b++) {
+        size_t begin = n * b / nBatches, end = n * (b + 1) / nBatches;
+        std::vector<std::string> srcs;
+        srcs.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            srcs.emplace_back(sketches[i]->code());
+        }
+        Building building =
+            BuildPool::getInstance()
+                .submit([srcs = std::move(srcs), device = device_]() {
+                    return buildBatchImage(srcs, device);
+                })
+                .share();
+        for (size_t i = begin; i < end; i++) {
+            times.emplace_back(pipeline_->submit(
+                [i, building, index = i - begin, args = measureArgs_,
+                 nRets = sketches[i]->lowered()->returns_.size(),
+                 options = timingOptions_](MeasureWorker *worker) {
+                    std::cout << "measure " << i << std::endl;
+                    auto &&[image, entry] = building.get()[index];
+                    if (!image.isValid()) {
+                        return 1e30;
+                    }
+                    return worker->time(image, entry, args, nRets, options)
+                        .median_;
+                }));
+        }
+    }
+    return times;
+}
+
+std::vector<std::future<double>>
+AutoSchedule::measure(std::vector<Ref<Sketch>> &sketches) {
+    // Compile in the background, and measure sequentially in the measurement
+    // thread. A program is measured as soon as it is compiled, so compiling the
+    // later programs overlaps measuring the earlier ones. CPU programs are
+    // compiled in batches, one for each backend compiler job, so the cost of
+    // launching the compiler and loading the binary is shared
+    // TODO: Parallel among computing nodes
+    ASSERT(paramsSet_);
+    if (nMeasureWorkers_ > 0) {
+        return measureInWorkers(sketches);
+    }
+
+    typedef std::shared_future<std::vector<Ref<Driver>>> Building;
+    size_t n = sketches.size();
+    std::vector<std::pair<Building, size_t>> drivers(
+        n); // (batch, index in the batch)
+    if (device_->type() == TargetType::CPU) {
+        size_t nBatches = std::min(n, maxCompilerJobs());
+        for (size_t b = 0; b < nBatches; b++) {
+            size_t begin = n * b / nBatches, end = n * (b + 1) / nBatches;
+            std::vector<Func> funcs;
+            std::vector<std::string> srcs;
+            funcs.reserve(end - begin);
+            srcs.reserve(end - begin);
+            for (size_t i = begin; i < end; i++) {
+                funcs.emplace_back(sketches[i]->lowered());
+                srcs.emplace_back(sketches[i]->code());
+            }
+            auto building =
+                BuildPool::getInstance()
+                    .submit([funcs = std::move(funcs), srcs = std::move(srcs),
+                             device = device_]() {
+                        return buildBatch(funcs, srcs, device);
+                    })
+                    .share();
+            for (size_t i = begin; i < end; i++) {
+                drivers[i] = {building, i - begin};
+            }
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            std::promise<std::vector<Ref<Driver>>> built;
+            try {
+                built.set_value({Ref<Driver>::make(sketches[i]->lowered(),
+                                                   sketches[i]->code(), device_,
+                                                   true /* asyncBuild */)});
+            } catch (const std::exception &e) {
+                std::cerr << "ERROR measure: " << e.what() << std::endl;
+                built.set_value({nullptr});
+            }
+            drivers[i] = {built.get_future().share(), 0};
         }
     }
+
+    std::vector<std::future<double>> times;
+    times.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        times.emplace_back(pipeline_->submit(
+            [this, i, building = drivers[i].first, index = drivers[i].second,
+             options = timingOptions_](MeasureWorker *) {
+                std::cout << "measure " << i << std::endl;
+                auto &&driver = building.get()[index];
+                if (!driver.isValid()) {
+                    return 1e30;
+                }
+                driver->wait();
+                driver->setArgs(args_, kws_);
+                return driver->benchmark(options).median_;
+            }));
+    }
     return times;
 }
 
+void AutoSchedule::setMeasureCores(const std::vector<int> &cores) {
+    pipeline_ = std::make_unique<MeasurePipeline>(cores, nMeasureWorkers_,
+                                                  measureWorkerOptions_);
+    measureCores_ = cores;
+}
+
+void AutoSchedule::setMeasureWorkers(size_t n, double timeout,
+                                     size_t memLimit) {
+    if (n > 0 && device_->type() != TargetType::CPU) {
+        throw DriverError("Measurement workers only support CPU");
+    }
+    MeasureWorkerOptions options;
+    options.timeout_ = timeout;
+    options.memLimit_ = memLimit;
+    pipeline_ = std::make_unique<MeasurePipeline>(measureCores_, n, options);
+    nMeasureWorkers_ = n;
+    measureWorkerOptions_ = options;
+}
+
+double AutoSchedule::getThroughput() const {
+    if (nMeasured_ == 0) {
+        return 0;
+    }
+    std::chrono::duration<double, std::ratio<3600>> hours =
+        std::chrono::steady_clock::now() - tuneBegin_;
+    return nMeasured_ / hours.count();
+}
+
 void AutoSchedule::searchOneRound(size_t n) {
     bool firstTime = false;
     if (baseSketches_.empty()) {
@@ -115,17 +301,25 @@ void AutoSchedule::searchOneRound(size_t n) {
         std::vector<Ref<Sketch>> init = getInitPopulation(n);
         std::cout << "evolutionary search" << std::endl;
         std::vector<Ref<Sketch>> best = evolutionarySearch(init, n * 0.9);
-        testAndAdd(best);
+        auto pendingBest = submitTest(best);
+        // The random population does not depend on the measured results, so
+        // it is generated and compiled while the best ones are being measured
+        std::vector<Ref<Sketch>> rand = getRandPopulation(n - size_t(n * 0.9));
+        auto pendingRand = submitTest(rand);
+        finishTest(std::move(pendingBest));
+        finishTest(std::move(pendingRand));
+    } else {
+        std::vector<Ref<Sketch>> rand = getRandPopulation(n);
+        testAndAdd(rand);
     }
-    std::vector<Ref<Sketch>> rand =
-        getRandPopulation(firstTime ? n : n - size_t(n * 0.9));
-    testAndAdd(rand);
     auto bs = getBestSchedule();
     auto logs = bs.logs();
     for (auto log : logs) {
         std::cout << log << std::endl;
     }
     std::cout << "now best: " << toString(bs.ast()) << std::endl;
+    std::cout << "throughput: " << getThroughput() << " candidates/hour"
+              << std::endl;
 }
 
 std::vector<std::vector<double>>
@@ -148,10 +342,11 @@ AutoSchedule::genFeatures(std::vector<Ref<Sketch>> &sketches) {
     return featureList;
 }
 
-std::vector<double>
-AutoSchedule::testAndAdd(std::vector<Ref<Sketch>> &sketches_in) {
+AutoSchedule::PendingTest
+AutoSchedule::submitTest(std::vector<Ref<Sketch>> &sketches_in) {
     std::cout << "schedule" << std::endl;
-    std::vector<Ref<Sketch>> sketches;
+    PendingTest pending;
+    auto &&sketches = pending.sketches_;
     size_t nIn = sketches_in.size();
 #pragma omp parallel for
     for (size_t i = 0; i < nIn; i++) {
@@ -166,18 +361,56 @@ AutoSchedule::testAndAdd(std::vector<Ref<Sketch>> &sketches_in) {
         }
     }
     std::cout << "feature" << std::endl;
-    auto features = genFeatures(sketches);
+    pending.features_ = genFeatures(sketches);
+    if (nMeasured_ == 0) {
+        tuneBegin_ = std::chrono::steady_clock::now();
+    }
+    // Mark them as measured now, so a batch prepared during the measurement
+    // does not contain them again
+    for (auto &&sketch : sketches) {
+        measuredHashes_.insert(sketch->hash());
+    }
+    pending.times_ = measure(sketches);
+    return pending;
+}
+
+std::vector<double>
+AutoSchedule::testAndAdd(std::vector<Ref<Sketch>> &sketches_in) {
+    return finishTest(submitTest(sketches_in));
+}
+
+std::vector<double> AutoSchedule::finishTest(PendingTest &&pending) {
+    auto &&sketches = pending.sketches_;
+    auto &&features = pending.features_;
     size_t n = sketches.size();
-    ASSERT(sketches.size() == n);
-    std::vector<double> times = measure(sketches);
+    std::vector<double> times;
+    times.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        try {
+            times.emplace_back(pending.times_[i].get());
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR measure: " << e.what() << std::endl;
+            std::cerr << toString(sketches[i]->code()) << std::endl;
+            times.emplace_back(1e30);
+        }
+    }
+    nMeasured_ += n;
+    Features okFeatures;
     std::vector<double> flopsList;
     for (size_t i = 0; i < times.size(); i++) {
         if (times[i] > 1e20) {
             continue;
         }
+        okFeatures.emplace_back(features[i]);
         flopsList.emplace_back(flop_ / times[i]);
     }
-    updateFunc_(features, flopsList);
+    updateModel(okFeatures, flopsList);
+    for (size_t i = 0; i < n; i++) {
+        newRecords_.push_back({sketches[i]->structure(),
+                               sketches[i]->getAnnotation(),
+                               sketches[i]->genSchedule().logs(), features[i],
+                               times[i]});
+    }
     auto cmp = [](const Ref<Sketch> &a, const Ref<Sketch> &b) {
         return *a < *b;
     };
@@ -191,20 +424,7 @@ AutoSchedule::testAndAdd(std::vector<Ref<Sketch>> &sketches_in) {
         cnt++;
         avg += times[i];
         mn = std::min(mn, times[i]);
-        if (measuredSketches_.size() < measuredSize_) {
-            measuredSketches_.emplace_back(sketches[i]);
-            measuredSketches_.back()->setTime(times[i]);
-            std::push_heap(measuredSketches_.begin(), measuredSketches_.end(),
-                           cmp);
-        } else if (times[i] < measuredSketches_[0]->time()) {
-            std::pop_heap(measuredSketches_.begin(), measuredSketches_.end(),
-                          cmp);
-            measuredSketches_.back() = sketches[i];
-            measuredSketches_.back()->setTime(times[i]);
-            std::push_heap(measuredSketches_.begin(), measuredSketches_.end(),
-                           cmp);
-        }
-        measuredHashes_.insert(sketches[i]->hash());
+        pushMeasured(sketches[i], times[i]);
     }
     avg /= cnt;
     std::sort(measuredSketches_.begin(), measuredSketches_.end(), cmp);
@@ -214,6 +434,97 @@ AutoSchedule::testAndAdd(std::vector<Ref<Sketch>> &sketches_in) {
     return times;
 }
 
+void AutoSchedule::updateModel(const Features &features,
+                               const Predicts &flops) {
+    if (updateFunc_) {
+        updateFunc_(features, flops);
+    } else {
+        costModel_.update(features, flops);
+    }
+}
+
+void AutoSchedule::pushMeasured(const Ref<Sketch> &sketch, double time) {
+    auto cmp = [](const Ref<Sketch> &a, const Ref<Sketch> &b) {
+        return *a < *b;
+    };
+    if (measuredSketches_.size() < measuredSize_) {
+        measuredSketches_.emplace_back(sketch);
+        measuredSketches_.back()->setTime(time);
+        std::push_heap(measuredSketches_.begin(), measuredSketches_.end(), cmp);
+    } else if (time < measuredSketches_[0]->time()) {
+        std::pop_heap(measuredSketches_.begin(), measuredSketches_.end(), cmp);
+        measuredSketches_.back() = sketch;
+        measuredSketches_.back()->setTime(time);
+        std::push_heap(measuredSketches_.begin(), measuredSketches_.end(), cmp);
+    }
+}
+
+Ref<Sketch> AutoSchedule::restoreSketch(const TuningRecord &record) {
+    if (baseSketches_.empty()) {
+        genSketches();
+    }
+    for (auto &&base : baseSketches_) {
+        if (base->structure() == record.sketch_) {
+            auto sketch = Ref<Sketch>::make(base->clone());
+            if (sketch->setAnnotation(record.annotation_)) {
+                return sketch;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::string AutoSchedule::getWorkload() const {
+    std::ostringstream os;
+    // A stable hash, because the workload is saved in tuning logs
+    os << std::hex << fnv1a(toString(original_.ast()));
+    return os.str();
+}
+
+std::vector<TuningRecord> AutoSchedule::popRecords() {
+    auto ret = std::move(newRecords_);
+    newRecords_.clear();
+    return ret;
+}
+
+Schedule AutoSchedule::applyRecord(const TuningRecord &record) {
+    auto sketch = restoreSketch(record);
+    if (!sketch.isValid()) {
+        throw InvalidSchedule("The tuning record does not match any sketch of "
+                              "the program");
+    }
+    return sketch->genSchedule();
+}
+
+void AutoSchedule::addRecords(const std::vector<TuningRecord> &records) {
+    auto cmp = [](const Ref<Sketch> &a, const Ref<Sketch> &b) {
+        return *a < *b;
+    };
+    std::make_heap(measuredSketches_.begin(), measuredSketches_.end(), cmp);
+    Features features;
+    std::vector<double> flopsList;
+    for (auto &&record : records) {
+        auto sketch = restoreSketch(record);
+        if (!sketch.isValid()) {
+            continue;
+        }
+        // Failed ones are not to be measured again, either
+        measuredHashes_.insert(sketch->hash());
+        if (record.time_ > 1e20) {
+            continue;
+        }
+        pushMeasured(sketch, record.time_);
+        if (!record.feature_.empty()) {
+            features.emplace_back(record.feature_);
+            flopsList.emplace_back(flop_ / record.time_);
+        }
+    }
+    std::sort(measuredSketches_.begin(), measuredSketches_.end(), cmp);
+    if (!features.empty()) {
+        updateModel(features, flopsList);
+    }
+}
+
 Schedule AutoSchedule::getBestSchedule() {
     if (measuredSketches_.empty()) {
         return {};
@@ -396,7 +707,8 @@ AutoSchedule::getPrediction(std::vector<Ref<Sketch>> &sketches_in) {
     std::cout << "get prediction" << std::endl;
     auto featureList = genFeatures(sketches);
     std::cout << "got prediction" << std::endl;
-    auto predList = predictFunc_(featureList);
+    auto predList = predictFunc_ ? predictFunc_(featureList)
+                                 : costModel_.predict(featureList);
     for (size_t i = 0; i < predList.size(); i++) {
         ret[index[i]] = predList[i];
     }
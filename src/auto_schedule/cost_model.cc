@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <auto_schedule/cost_model.h>
+#include <except.h>
+
+namespace freetensor {
+
+double CostModel::eval(const Tree &tree, const std::vector<double> &feature) {
+    int i = 0;
+    while (tree[i].feature_ != -1) {
+        i = feature[tree[i].feature_] <= tree[i].threshold_ ? tree[i].left_
+                                                            : tree[i].right_;
+    }
+    return tree[i].value_;
+}
+
+double CostModel::predictLog(const std::vector<double> &feature) const {
+    double ret = base_;
+    for (auto &&tree : trees_) {
+        ret += eval(tree, feature);
+    }
+    return ret;
+}
+
+CostModel::Tree CostModel::grow(const std::vector<std::vector<double>> &cuts,
+                                const std::vector<uint8_t> &bins) const {
+    size_t n = samples_.size(), nFeat = cuts.size();
+    std::vector<double> grad(n);
+    for (size_t i = 0; i < n; i++) {
+        grad[i] = preds_[i] - labels_[i];
+    }
+
+    struct Task {
+        int node_;
+        std::vector<size_t> samples_;
+        int depth_;
+    };
+    std::vector<size_t> all(n);
+    std::iota(all.begin(), all.end(), 0);
+    Tree tree(1);
+    std::vector<Task> stack = {{0, std::move(all), 0}};
+    while (!stack.empty()) {
+        auto task = std::move(stack.back());
+        stack.pop_back();
+        auto &&idx = task.samples_;
+        double sum = 0;
+        for (size_t i : idx) {
+            sum += grad[i];
+        }
+        double cnt = idx.size();
+        tree[task.node_].value_ =
+            -options_.learningRate_ * sum / (cnt + options_.lambda_);
+        if (task.depth_ >= options_.maxDepth_ ||
+            idx.size() < 2 * options_.minLeaf_) {
+            continue;
+        }
+
+        // Best split of each feature on the histogram
+        double parentScore = sum * sum / (cnt + options_.lambda_);
+        std::vector<double> bestGain(nFeat, 0);
+        std::vector<int> bestBin(nFeat, -1);
+#pragma omp parallel for
+        for (size_t f = 0; f < nFeat; f++) {
+            size_t nBins = cuts[f].size() + 1;
+            if (nBins == 1) {
+                continue;
+            }
+            std::vector<double> histSum(nBins, 0);
+            std::vector<size_t> histCnt(nBins, 0);
+            for (size_t i : idx) {
+                auto b = bins[i * nFeat + f];
+                histSum[b] += grad[i];
+                histCnt[b]++;
+            }
+            double lSum = 0;
+            size_t lCnt = 0;
+            for (size_t b = 0; b + 1 < nBins; b++) {
+                lSum += histSum[b];
+                lCnt += histCnt[b];
+                size_t rCnt = idx.size() - lCnt;
+                if (lCnt < options_.minLeaf_) {
+                    continue;
+                }
+                if (rCnt < options_.minLeaf_) {
+                    break;
+                }
+                double rSum = sum - lSum;
+                double gain = lSum * lSum / (lCnt + options_.lambda_) +
+                              rSum * rSum / (rCnt + options_.lambda_) -
+                              parentScore;
+                if (gain > bestGain[f]) {
+                    bestGain[f] = gain;
+                    bestBin[f] = b;
+                }
+            }
+        }
+        int f = std::max_element(bestGain.begin(), bestGain.end()) -
+                bestGain.begin();
+        if (bestBin[f] == -1 || bestGain[f] <= 1e-12) {
+            continue;
+        }
+
+        std::vector<size_t> lIdx, rIdx;
+        for (size_t i : idx) {
+            (bins[i * nFeat + f] <= bestBin[f] ? lIdx : rIdx).emplace_back(i);
+        }
+        int left = tree.size(), right = left + 1;
+        tree.resize(tree.size() + 2);
+        tree[task.node_].feature_ = f;
+        tree[task.node_].threshold_ = cuts[f][bestBin[f]];
+        tree[task.node_].left_ = left;
+        tree[task.node_].right_ = right;
+        stack.push_back({left, std::move(lIdx), task.depth_ + 1});
+        stack.push_back({right, std::move(rIdx), task.depth_ + 1});
+    }
+    return tree;
+}
+
+CostModel::Predicts CostModel::predict(const Features &features) const {
+    Predicts ret(features.size(), 1);
+    if (!trained()) {
+        return ret;
+    }
+#pragma omp parallel for
+    for (size_t i = 0; i < features.size(); i++) {
+        ret[i] = std::exp(predictLog(features[i]));
+    }
+    return ret;
+}
+
+void CostModel::update(const Features &features, const Predicts &flops) {
+    ASSERT(features.size() == flops.size());
+    size_t nOld = samples_.size();
+    for (size_t i = 0; i < features.size(); i++) {
+        if (flops[i] > 0) {
+            ASSERT(samples_.empty() ||
+                   features[i].size() == samples_.front().size());
+            samples_.emplace_back(features[i]);
+            labels_.emplace_back(std::log(flops[i]));
+        }
+    }
+    if (samples_.size() == nOld) {
+        return;
+    }
+    if (trees_.empty()) {
+        base_ = std::accumulate(labels_.begin(), labels_.end(), 0.) /
+                labels_.size();
+    }
+    preds_.resize(samples_.size());
+#pragma omp parallel for
+    for (size_t i = nOld; i < samples_.size(); i++) {
+        preds_[i] = predictLog(samples_[i]);
+    }
+    if (samples_.size() > options_.maxSamples_) {
+        size_t drop = samples_.size() - options_.maxSamples_;
+        samples_.erase(samples_.begin(), samples_.begin() + drop);
+        labels_.erase(labels_.begin(), labels_.begin() + drop);
+        preds_.erase(preds_.begin(), preds_.begin() + drop);
+    }
+
+    // Bucket the features by their quantiles in the training set
+    size_t n = samples_.size(), nFeat = samples_.front().size();
+    std::vector<std::vector<double>> cuts(nFeat);
+    std::vector<uint8_t> bins(n * nFeat);
+#pragma omp parallel for
+    for (size_t f = 0; f < nFeat; f++) {
+        std::vector<double> values(n);
+        for (size_t i = 0; i < n; i++) {
+            values[i] = samples_[i][f];
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        size_t nBins = std::min<size_t>(values.size(), options_.nBins_);
+        for (size_t b = 1; b < nBins; b++) {
+            cuts[f].emplace_back(values[b * values.size() / nBins - 1]);
+        }
+        for (size_t i = 0; i < n; i++) {
+            bins[i * nFeat + f] =
+                std::lower_bound(cuts[f].begin(), cuts[f].end(),
+                                 samples_[i][f]) -
+                cuts[f].begin();
+        }
+    }
+
+    int nTrees = options_.treesPerUpdate_;
+    if ((int)trees_.size() + nTrees > options_.maxTrees_) {
+        trees_.clear();
+        base_ = std::accumulate(labels_.begin(), labels_.end(), 0.) /
+                labels_.size();
+        std::fill(preds_.begin(), preds_.end(), base_);
+        nTrees = std::max(nTrees, options_.maxTrees_ / 2);
+    }
+    for (int t = 0; t < nTrees; t++) {
+        auto tree = grow(cuts, bins);
+#pragma omp parallel for
+        for (size_t i = 0; i < n; i++) {
+            preds_[i] += eval(tree, samples_[i]);
+        }
+        trees_.emplace_back(std::move(tree));
+    }
+}
+
+} // namespace freetensor
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <memory>
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h>   // cpu_set_t
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <auto_schedule/measure_pipeline.h>
+#include <except.h>
+
+namespace freetensor {
+
+MeasurePipeline::MeasurePipeline(const std::vector<int> &cores,
+                                 size_t nWorkers,
+                                 const MeasureWorkerOptions &options) {
+    size_t nThreads = std::max<size_t>(nWorkers, 1);
+    if (!cores.empty() && cores.size() < nThreads) {
+        throw DriverError("Unable to split " + std::to_string(cores.size()) +
+                          " cores among " + std::to_string(nThreads) +
+                          " measurement workers");
+    }
+    for (size_t t = 0; t < nThreads; t++) {
+        std::vector<int> myCores(cores.begin() + cores.size() * t / nThreads,
+                                 cores.begin() +
+                                     cores.size() * (t + 1) / nThreads);
+        threads_.emplace_back([this, myCores, nWorkers, options]() {
+            if (!myCores.empty()) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int core : myCores) {
+                    CPU_SET(core, &set);
+                }
+                if (pthread_setaffinity_np(pthread_self(), sizeof(set),
+                                           &set) != 0) {
+                    WARNING("Unable to pin the measurement thread");
+                }
+#ifdef _OPENMP
+                omp_set_num_threads(myCores.size());
+#endif
+            }
+            // Spawned from this thread, so it inherits the pinning
+            std::unique_ptr<MeasureWorker> worker;
+            if (nWorkers > 0) {
+                worker = std::make_unique<MeasureWorker>(options);
+            }
+            while (true) {
+                std::function<void(MeasureWorker *)> job;
+                {
+                    std::unique_lock<std::mutex> guard(lock_);
+                    cv_.wait(guard,
+                             [this]() { return stop_ || !jobs_.empty(); });
+                    if (stop_) {
+                        return;
+                    }
+                    job = std::move(jobs_.front());
+                    jobs_.pop();
+                }
+                job(worker.get()); // Exceptions are caught by packaged_task
+            }
+        });
+    }
+}
+
+MeasurePipeline::~MeasurePipeline() {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stop_ = true; // Pending jobs are dropped, and their futures are broken
+    }
+    cv_.notify_all();
+    for (auto &&thread : threads_) {
+        thread.join();
+    }
+}
+
+std::future<double>
+MeasurePipeline::submit(std::function<double(MeasureWorker *)> job) {
+    auto task = std::make_shared<std::packaged_task<double(MeasureWorker *)>>(
+        std::move(job));
+    auto ret = task->get_future();
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        jobs_.emplace([task](MeasureWorker *worker) { (*task)(worker); });
+    }
+    cv_.notify_one();
+    return ret;
+}
+
+} // namespace freetensor
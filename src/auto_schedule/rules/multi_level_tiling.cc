@@ -130,6 +130,22 @@ std::vector<int> MultiLevelTilingPart::getAnnotation() const {
     return ret;
 }
 
+void MultiLevelTilingPart::setAnnotation(const std::vector<int> &annotation) {
+    ASSERT(annotation.size() == annotationSize());
+    auto it = annotation.begin();
+    annotation_.spaceLoopTiling.clear();
+    for (size_t i = 0, n = target_.spaceLoops.size(); i < n; i++) {
+        annotation_.spaceLoopTiling.emplace_back(it, it + spaceLoopTimes_);
+        it += spaceLoopTimes_;
+    }
+    annotation_.reductionLoopTiling.clear();
+    for (size_t i = 0, n = target_.reductionLoops.size(); i < n; i++) {
+        annotation_.reductionLoopTiling.emplace_back(it,
+                                                     it + reductionLoopTimes_);
+        it += reductionLoopTimes_;
+    }
+}
+
 size_t MultiLevelTilingPart::hash() const {
     size_t h = std::hash<ForsWithDataReuse>{}(target_);
     h = hashCombine(h, std::hash<MultiLevelTilingAnnotation>{}(annotation_));
@@ -5,6 +5,15 @@
 
 namespace freetensor {
 
+const std::vector<OpenMPScope> ParallelizePart::candidateScopes_ = {
+    OpenMPScope{},
+    OpenMPScope{OpenMPScope::Static, 1},
+    OpenMPScope{OpenMPScope::Dynamic, 1},
+    OpenMPScope{OpenMPScope::Dynamic, 16},
+    OpenMPScope{OpenMPScope::Guided},
+    OpenMPScope{OpenMPScope::TaskLoop},
+};
+
 void ParallelizePart::apply(Schedule &schedule, SketchTarget &target) {
     Ref<MultiLevelTilingPart> part =
         target.getPart(SketchPartType::MultiLevelTiling)
@@ -29,15 +38,20 @@ void ParallelizePart::apply(Schedule &schedule, SketchTarget &target) {
         return;
     }
     lastParallelizedID_ = mergeLoops(schedule, toFuse);
-    schedule.parallelize(lastParallelizedID_, OpenMPScope{});
+    schedule.parallelize(lastParallelizedID_, candidateScopes_.at(scopeIdx_));
 }
 
 void ParallelizePart::genRandAnnotation(std::default_random_engine &gen) {
     parallelSize_ = randomInt(maxSize_ - 1, gen) + 1;
+    scopeIdx_ = randomInt(candidateScopes_.size() - 1, gen);
 }
 
 bool ParallelizePart::mutate(std::default_random_engine &gen) {
-    parallelSize_ = randomInt(maxSize_ - 1, gen) + 1;
+    if (randomInt(1, gen)) {
+        parallelSize_ = randomInt(maxSize_ - 1, gen) + 1;
+    } else {
+        scopeIdx_ = randomInt(candidateScopes_.size() - 1, gen);
+    }
     return true;
 }
 bool ParallelizePart::crossover(const SketchPart &part,
@@ -45,6 +59,7 @@ bool ParallelizePart::crossover(const SketchPart &part,
     if (auto p = part.as<ParallelizePart>();
         p.isValid() && p->partType() == SketchPartType::Parallelize) {
         parallelSize_ = p->parallelSize_;
+        scopeIdx_ = p->scopeIdx_;
         return true;
     }
     return false;
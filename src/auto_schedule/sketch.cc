@@ -84,6 +84,36 @@ std::vector<int> Sketch::getAnnotation() const {
     return ret;
 }
 
+bool Sketch::setAnnotation(const std::vector<int> &annotation) {
+    size_t n = 0;
+    for (const auto &target : targets_) {
+        for (const auto &part : target.parts) {
+            n += part.second->annotationSize();
+        }
+    }
+    if (n != annotation.size()) {
+        return false;
+    }
+    auto begin = annotation.begin();
+    for (auto &target : targets_) {
+        for (auto &part : target.parts) {
+            auto end = begin + part.second->annotationSize();
+            part.second->setAnnotation(std::vector<int>(begin, end));
+            begin = end;
+        }
+    }
+    scheduleGenerated_ = false;
+    return true;
+}
+
+std::string Sketch::structure() const {
+    std::string ret;
+    for (const auto &target : targets_) {
+        ret += target.log + "|\n";
+    }
+    return ret;
+}
+
 size_t Sketch::hash() const {
     size_t h = 0;
     for (const auto &target : targets_) {
@@ -104,7 +134,7 @@ std::string Sketch::genCode(const Ref<Target> &target) {
     if (target->type() == TargetType::GPU)
         code_ = codeGenCUDA(lowered_);
     else
-        code_ = codeGenCPU(lowered_);
+        code_ = codeGenCPU(lowered_, target.as<CPU>());
     return code_;
 }
 std::vector<double> &Sketch::genFeature() {
@@ -2,6 +2,7 @@
 
 #include <codegen/code_gen_cpu.h>
 #include <pass/simplify.h>
+#include <reduce_op.h>
 #include <serialize/mangle.h>
 
 #include "detail/code_gen_c.h"
@@ -28,10 +29,11 @@ void CodeGenCPU::genAlloc(const Ref<Tensor> &tensor, const std::string &rawPtr,
                           const std::string &dimPtr) {
     auto ndim = tensor->shape().size();
     makeIndent();
-    os() << shapePtr << " = " << ndim << " > 0 ? (size_t*)malloc((" << dimPtr
-         << " = " << ndim << ") * sizeof(size_t)) : NULL;" << std::endl;
+    os() << shapePtr << " = " << ndim << " > 0 ? (size_t*)_ctx->alloc(("
+         << dimPtr << " = " << ndim << ") * sizeof(size_t)) : NULL;"
+         << std::endl;
     makeIndent();
-    os() << rawPtr << " = malloc(";
+    os() << rawPtr << " = _ctx->alloc(";
     for (auto &&[i, dim] : iter::enumerate(tensor->shape())) {
         os() << "(" << shapePtr << "[" << i << "] = ";
         (*this)(dim);
@@ -40,10 +42,92 @@ void CodeGenCPU::genAlloc(const Ref<Tensor> &tensor, const std::string &rawPtr,
     os() << "sizeof(" << gen(tensor->dtype()) << "));" << std::endl;
 }
 
+void CodeGenCPU::genHeapLocal(const VarDef &op) {
+    // e.g.
+    // float (*restrict x)[n] = (float(*)[n])_ctx->alloc((m) * (n) * 4);
+    // ...
+    // _ctx->free(x);
+    markDefBuffer(op);
+
+    auto &&tensor = op->buffer_->tensor();
+    auto &&shape = tensor->shape();
+    auto name = mangle(op->name_);
+    auto genInnerDims = [&]() {
+        for (size_t i = 1, n = shape.size(); i < n; i++) { // No shape[0]
+            os() << "[";
+            (*this)(shape[i]);
+            os() << "]";
+        }
+    };
+    makeIndent();
+    os() << gen(tensor->dtype()) << " (*restrict " << name << ")";
+    genInnerDims();
+    os() << " = (" << gen(tensor->dtype()) << "(*)";
+    genInnerDims();
+    os() << ")_ctx->alloc(";
+    for (auto &&dim : shape) {
+        os() << "(";
+        (*this)(dim);
+        os() << ") * ";
+    }
+    os() << "sizeof(" << gen(tensor->dtype()) << "));" << std::endl;
+
+    (*this)(op->body_);
+
+    makeIndent();
+    os() << "_ctx->free(" << name << ");" << std::endl;
+
+    markUndefBuffer(op);
+}
+
+void CodeGenCPU::genWorkspaceLocal(const VarDef &op, size_t offset) {
+    // e.g.
+    // float (*x)[5] = (float(*)[5])(_ctx->workspace() + 4096);
+    //
+    // No `restrict` here, because buffers with disjoint live ranges may
+    // overlap in the workspace
+    markDefBuffer(op);
+
+    auto &&tensor = op->buffer_->tensor();
+    auto &&shape = tensor->shape();
+    auto name = mangle(op->name_);
+    auto genInnerDims = [&]() {
+        for (size_t i = 1, n = shape.size(); i < n; i++) { // No shape[0]
+            os() << "[";
+            (*this)(shape[i]);
+            os() << "]";
+        }
+    };
+    makeIndent();
+    os() << gen(tensor->dtype()) << " (*" << name << ")";
+    genInnerDims();
+    os() << " = (" << gen(tensor->dtype()) << "(*)";
+    genInnerDims();
+    os() << ")(_ctx->workspace() + " << offset << ");" << std::endl;
+
+    (*this)(op->body_);
+
+    markUndefBuffer(op);
+}
+
 void CodeGenCPU::visit(const VarDef &op) {
     if (op->buffer_->atype() == AccessType::Cache) {
         auto &&tensor = op->buffer_->tensor();
         auto &&shape = tensor->shape();
+        if (auto it = workspace_.offsets_.find(op->id());
+            it != workspace_.offsets_.end()) {
+            genWorkspaceLocal(op, it->second);
+            return;
+        }
+        if (op->buffer_->mtype() == MemType::CPU &&
+            std::any_of(shape.begin(), shape.end(), [](const Expr &dim) {
+                return dim->nodeType() != ASTNodeType::IntConst;
+            })) {
+            // The size is unknown at compile time, so we can neither set a
+            // stack limit for it, nor be sure it fits in the stack
+            genHeapLocal(op);
+            return;
+        }
         int64_t size = sizeOf(tensor->dtype());
         for (auto &&dim : shape) {
             if (dim->nodeType() == ASTNodeType::IntConst) {
@@ -73,6 +157,22 @@ void CodeGenCPU::visit(const VarDef &op) {
     }
 }
 
+void CodeGenCPU::visit(const Store &op) {
+    if (!streaming_.count(op->var_) || op->indices_.empty()) {
+        CodeGenC::visit(op);
+        return;
+    }
+    // e.g. streamStore<float>(&y[i][j], ...);
+    markUseBuffer(op->var_);
+    makeIndent();
+    os() << "streamStore<" << gen(buffer(op->var_)->tensor()->dtype())
+         << ">(&";
+    genScalar(op);
+    os() << ", ";
+    (*this)(op->expr_);
+    os() << ");" << std::endl;
+}
+
 void CodeGenCPU::visit(const ReduceTo &op) {
     if (op->atomic_) {
         os() << "#pragma omp atomic" << std::endl;
@@ -81,10 +181,188 @@ void CodeGenCPU::visit(const ReduceTo &op) {
     CodeGenC::visit(op);
 }
 
+void CodeGenCPU::genThreadPoolFor(const For &op) {
+    // e.g.
+    // _ctx->threadPool().parallelFor(0, n, 0, [&](int64_t _lo, int64_t _hi) {
+    //   auto &x_shared = x;
+    //   {
+    //     float x[4]; // Shadows the shared one
+    //     for (...) x[...] = 0;
+    //     for (int64_t i_cnt = _lo; i_cnt < _hi; i_cnt++) {
+    //       int i = begin + i_cnt * step;
+    //       ...
+    //     }
+    //     std::lock_guard<std::mutex> _guard(...);
+    //     for (...) x_shared[...] += x[...];
+    //   }
+    // });
+    //
+    // Directly nested parallel loops are run serially in each chunk, instead
+    // of being collapsed
+    for (Stmt inner = op->body_;
+         inner->nodeType() == ASTNodeType::For &&
+         std::holds_alternative<OpenMPScope>(
+             inner.as<ForNode>()->property_->parallel_);
+         inner = inner.as<ForNode>()->body_) {
+        collapsed_.insert(inner.as<ForNode>());
+    }
+    usedThreadPool_ = true;
+
+    auto &&reductions = op->property_->reductions_;
+    auto genIndices = [&](const std::vector<Expr> &shape) {
+        for (size_t i = 0, n = shape.size(); i < n; i++) {
+            os() << "[_r" << i << "]";
+        }
+    };
+    auto genElemLoops = [&](const std::vector<Expr> &shape, auto &&genBody) {
+        for (size_t i = 0, n = shape.size(); i < n; i++) {
+            makeIndent();
+            os() << "for (int64_t _r" << i << " = 0; _r" << i << " < ";
+            (*this)(shape[i]);
+            os() << "; _r" << i << "++) ";
+            beginBlock();
+        }
+        makeIndent();
+        genBody();
+        os() << ";" << std::endl;
+        for (size_t i = 0, n = shape.size(); i < n; i++) {
+            endBlock();
+        }
+    };
+
+    makeIndent();
+    os() << "_ctx->threadPool().parallelFor(0, ";
+    (*this)(op->len_);
+    os() << ", " << std::get<OpenMPScope>(op->property_->parallel_).chunk_
+         << ", [&](int64_t _lo, int64_t _hi) ";
+    beginBlock();
+    for (auto &&r : reductions) {
+        makeIndent();
+        os() << "auto &" << mangle(r->var_ + ".shared") << " = "
+             << mangle(r->var_) << ";" << std::endl;
+    }
+    makeIndent();
+    beginBlock();
+    for (auto &&r : reductions) {
+        // After `cpu::lowerParallelReduction`, each reduction is on a whole
+        // workspace starting from 0
+        auto dtype = buffer(r->var_)->tensor()->dtype();
+        makeIndent();
+        os() << gen(dtype) << " " << mangle(r->var_);
+        for (auto &&dim : r->ends_) {
+            os() << "[";
+            (*this)(dim);
+            os() << "]";
+        }
+        os() << ";" << std::endl;
+        genElemLoops(r->ends_, [&]() {
+            os() << mangle(r->var_);
+            genIndices(r->ends_);
+            os() << " = ";
+            (*this)(neutralVal(dtype, r->op_));
+        });
+    }
+
+    markDefIter(op);
+    auto iterCnt = mangle(op->iter_ + ".cnt");
+    makeIndent();
+    os() << "for (int64_t " << iterCnt << " = _lo; " << iterCnt << " < _hi; "
+         << iterCnt << "++) ";
+    beginBlock();
+    makeIndent();
+    os() << "int " << mangle(op->iter_) << " = ";
+    (*this)(op->begin_);
+    os() << " + " << iterCnt << " * ";
+    (*this)(op->step_);
+    os() << ";" << std::endl;
+    bool oldInParallel = inParallel_;
+    Expr oldParallelLen = parallelLen_;
+    inParallel_ = true;
+    parallelLen_ = op->len_;
+    (*this)(op->body_);
+    inParallel_ = oldInParallel;
+    parallelLen_ = oldParallelLen;
+    endBlock();
+    markUndefIter(op);
+
+    if (!reductions.empty()) {
+        makeIndent();
+        os() << "std::lock_guard<std::mutex> _guard(_ctx->threadPool()."
+                "reductionLock());"
+             << std::endl;
+    }
+    for (auto &&r : reductions) {
+        auto dtype = buffer(r->var_)->tensor()->dtype();
+        auto shared = mangle(r->var_ + ".shared"), priv = mangle(r->var_);
+        genElemLoops(r->ends_, [&]() {
+            os() << shared;
+            genIndices(r->ends_);
+            switch (r->op_) {
+            case ReduceOp::Add:
+                os() << " += " << priv;
+                break;
+            case ReduceOp::Mul:
+                os() << " *= " << priv;
+                break;
+            case ReduceOp::Min:
+            case ReduceOp::Max:
+                os() << " = std::" << (r->op_ == ReduceOp::Min ? "min" : "max")
+                     << "<" << gen(dtype) << ">(" << shared;
+                genIndices(r->ends_);
+                os() << ", " << priv;
+                break;
+            case ReduceOp::LAnd:
+                os() << " &= (bool)(" << priv;
+                break;
+            case ReduceOp::LOr:
+                os() << " |= (bool)(" << priv;
+                break;
+            default:
+                ASSERT(false);
+            }
+            genIndices(r->ends_);
+            if (r->op_ != ReduceOp::Add && r->op_ != ReduceOp::Mul) {
+                os() << ")";
+            }
+        });
+    }
+    endBlock();
+    nIndent()--;
+    makeIndent();
+    os() << "});" << std::endl;
+}
+
 void CodeGenCPU::visit(const For &op) {
+    auto &&streaming = op->property_->streamingStores_;
+    for (auto &&var : streaming) {
+        streaming_.insert(var);
+    }
+    genFor(op);
+    for (auto &&var : streaming) {
+        streaming_.erase(streaming_.find(var));
+    }
+    needStreamFence_ |= !streaming.empty();
+
+    // Streaming stores are weakly ordered. If the loop is parallel, stores of
+    // the other threads are ordered by the barrier at the end of the loop,
+    // which is made of locked instructions. Loops collapsed into an outer loop
+    // should be perfectly nested, so the fence is postponed after the outer one
+    if (needStreamFence_ && !collapsed_.count(op)) {
+        makeIndent();
+        os() << "streamFence();" << std::endl;
+        needStreamFence_ = false;
+    }
+}
+
+void CodeGenCPU::genFor(const For &op) {
     if (std::holds_alternative<OpenMPScope>(op->property_->parallel_) &&
         !collapsed_.count(op)) {
+        if (useThreadPool_) {
+            genThreadPoolFor(op);
+            return;
+        }
         int collapse = 1;
+        Expr parallelLen = op->len_;
         for (Stmt inner = op->body_;
              inner->nodeType() == ASTNodeType::For &&
              std::holds_alternative<OpenMPScope>(
@@ -92,9 +370,49 @@ void CodeGenCPU::visit(const For &op) {
              inner = inner.as<ForNode>()->body_) {
             collapse++;
             collapsed_.insert(inner.as<ForNode>());
+            parallelLen = makeMul(parallelLen, inner.as<ForNode>()->len_);
         }
 
-        os() << "#pragma omp parallel for";
+        auto &&scope = std::get<OpenMPScope>(op->property_->parallel_);
+        switch (scope.kind_) {
+        case OpenMPScope::TaskLoop:
+            // Tasks are created by one thread and stolen by the others
+            os() << "#pragma omp parallel";
+            if (pinThreads_) {
+                os() << " proc_bind(spread)";
+            }
+            os() << std::endl;
+            os() << "#pragma omp single" << std::endl;
+            os() << "#pragma omp taskloop";
+            if (scope.chunk_ > 0) {
+                os() << " grainsize(" << scope.chunk_ << ")";
+            }
+            break;
+        case OpenMPScope::Static:
+            os() << "#pragma omp parallel for";
+            if (scope.chunk_ > 0) {
+                os() << " schedule(static, " << scope.chunk_ << ")";
+            }
+            break;
+        case OpenMPScope::Dynamic:
+        case OpenMPScope::Guided:
+            os() << "#pragma omp parallel for schedule("
+                 << (scope.kind_ == OpenMPScope::Dynamic ? "dynamic"
+                                                         : "guided");
+            if (scope.chunk_ > 0) {
+                os() << ", " << scope.chunk_;
+            }
+            os() << ")";
+            break;
+        default:
+            ASSERT(false);
+        }
+        if (pinThreads_ && scope.kind_ != OpenMPScope::TaskLoop) {
+            // Consecutive threads, which get consecutive parts of a static
+            // partition, are spread over the sockets in order. See
+            // `ArrayPool::firstTouch`
+            os() << " proc_bind(spread)";
+        }
         if (collapse > 1) {
             os() << " collapse(" << collapse << ")";
         }
@@ -152,9 +470,12 @@ void CodeGenCPU::visit(const For &op) {
         }
         os() << std::endl;
         bool oldInParallel = inParallel_;
+        Expr oldParallelLen = parallelLen_;
         inParallel_ = true;
+        parallelLen_ = parallelLen;
         CodeGenC::visit(op);
         inParallel_ = oldInParallel;
+        parallelLen_ = oldParallelLen;
         return;
     } else if (op->property_->vectorize_) {
         os() << "#pragma omp simd" << std::endl;
@@ -165,20 +486,27 @@ void CodeGenCPU::visit(const For &op) {
 }
 
 void CodeGenCPU::visit(const MatMul &op) {
+    auto d = dtype(op->c_);
+    if (dtype(op->a_) != d || dtype(op->b_) != d) {
+        throw InvalidProgram(
+            "MatMul requires all matrices have the same data type");
+    }
+
 #ifdef FT_WITH_MKL
     makeIndent();
     if (inParallel_) {
-        os() << "mkl_set_num_threads_local(1);" << std::endl;
-        // TODO: set it to max(1, cpu_count / outer_threads_count)
+        // Give the hardware threads not used by the outer loop to MKL
+        os() << "mkl_set_num_threads_local(innerBLASThreads(";
+        (*this)(parallelLen_);
+        if (useThreadPool_) {
+            os() << ", _ctx->threadPool().numThreads()";
+        }
+        os() << "));" << std::endl;
+        nestedBLAS_ = true;
     } else {
         os() << "mkl_set_num_threads_local(0); // 0 == reset" << std::endl;
     }
-
-    auto d = dtype(op->c_);
-    if (dtype(op->a_) != d || dtype(op->b_) != d) {
-        throw InvalidProgram(
-            "MKL requires all matrices have the same data type");
-    }
+#endif // FT_WITH_MKL
 
     bool transA = !op->aIsRowMajor_, transB = !op->bIsRowMajor_;
     Expr a = op->a_, b = op->b_, c = op->c_;
@@ -196,10 +524,18 @@ void CodeGenCPU::visit(const MatMul &op) {
     }
 
     makeIndent();
+#ifdef FT_WITH_MKL
     os() << "cblas_" << genMKLTypeMark(d)
          << "gemm_batch_strided(CblasRowMajor, "
          << (transA ? "CblasTrans" : "CblasNoTrans") << ", "
          << (transB ? "CblasTrans" : "CblasNoTrans") << ", ";
+#else
+    // Dispatched to OpenBLAS, BLIS or our built-in GEMM, depending on the
+    // build. See runtime/cpu_gemm.h
+    os() << "gemmBatchStrided<" << gen(d) << ">("
+         << (transA ? "true" : "false") << ", "
+         << (transB ? "true" : "false") << ", ";
+#endif // FT_WITH_MKL
     (*this)(m);
     os() << ", ";
     (*this)(n);
@@ -229,15 +565,18 @@ void CodeGenCPU::visit(const MatMul &op) {
     (*this)(stridec);
     os() << ", ";
     (*this)(op->batchSize_);
+#ifndef FT_WITH_MKL
+    // Inside a parallel loop, whether run by OpenMP or by the thread pool, each
+    // thread already does its own GEMM
+    os() << ", _ctx, " << (inParallel_ ? "1" : "omp_get_max_threads()");
+#endif // FT_WITH_MKL
     os() << ");" << std::endl;
-#else
-    ERROR("Configuring with MKL is needed");
-#endif
 }
 
-std::string codeGenCPU(const Func &func) {
-    CodeGenCPU visitor(func->params_, func->returns_);
+std::string codeGenCPU(const Func &func, const Ref<CPU> &target) {
     auto &&op = func->body_;
+    CodeGenCPU visitor(func->params_, func->returns_, planCPUWorkspace(op),
+                       target);
     visitor.beginBlock();
     visitor(op);
     visitor.endBlock();
@@ -255,16 +594,30 @@ extern "C" {
     auto body = visitor.toString([&](const CodeGenStream &stream) {
         std::string s =
             "void __attribute__ ((noinline)) _run(void **_params, "
-            "void **_returns, size_t **_retShapes, size_t *_retDims) " +
+            "void **_returns, size_t **_retShapes, size_t *_retDims, "
+            "CPUContext_t _ctx) " +
             stream.os_.str();
         s += "\n";
         s += "void run(void **_params, void **_returns, size_t **_retShapes, "
              "size_t *_retDims, CPUContext_t _ctx) {\n";
+        if (visitor.nestedBLAS()) {
+            // Restored when `run` returns
+            s += "  NestedBLASGuard _nestedBLAS;\n";
+        }
         s += "  _ctx->setStackLim(" +
              std::to_string(visitor.sharedStackSize()) +
              " + omp_get_num_threads() * " +
              std::to_string(visitor.threadStackSize()) + ");\n";
-        s += "  _run(_params, _returns, _retShapes, _retDims);\n";
+        if (visitor.usedThreadPool()) {
+            s += "  _ctx->initThreadPool(" +
+                 std::to_string(visitor.threadStackSize()) + ", " +
+                 (visitor.pinThreads() ? "true" : "false") + ");\n";
+        }
+        if (visitor.workspaceSize() > 0) {
+            s += "  _ctx->reserveWorkspace(" +
+                 std::to_string(visitor.workspaceSize()) + ");\n";
+        }
+        s += "  _run(_params, _returns, _retShapes, _retDims, _ctx);\n";
         s += "}";
         return s;
     });
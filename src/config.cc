@@ -31,10 +31,47 @@ static Opt<bool> getBoolEnv(const char *name) {
     }
 }
 
+static Opt<std::string> getStrEnv(const char *name) {
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock); // getenv is not thread safe
+    char *_env = getenv(name);
+    if (_env == nullptr) {
+        return nullptr;
+    }
+    return Opt<std::string>::make(std::string(_env));
+}
+
+static Opt<size_t> getSizeEnv(const char *name) {
+    auto env = getStrEnv(name);
+    if (!env.isValid()) {
+        return nullptr;
+    }
+    try {
+        size_t pos;
+        auto ret = std::stoull(*env, &pos);
+        if (pos == env->length()) {
+            return Opt<size_t>::make(ret);
+        }
+    } catch (const std::logic_error &e) {
+        // Fall through
+    }
+    ERROR((std::string) "Value of " + name + " must be a non-negative integer");
+}
+
 bool Config::prettyPrint_ = false;
 bool Config::printAllId_ = false;
 bool Config::werror_ = false;
 bool Config::debugBinary_ = false;
+bool Config::compileCache_ = true;
+std::string Config::compileCacheDir_;
+size_t Config::compileCacheSize_ = (size_t)1 << 30; // 1 GiB
+size_t Config::backendCompilerJobs_ = 0;
+size_t Config::arrayAlignment_ = 64; // Cache line
+size_t Config::arrayPoolSize_ = (size_t)1 << 30; // 1 GiB
+bool Config::arrayHugePages_ = false;
+bool Config::arrayFirstTouch_ = false;
+std::atomic<size_t> Config::compileCacheHits_ = 0,
+                    Config::compileCacheMisses_ = 0;
 Ref<Target> Config::defaultTarget_;
 Ref<Device> Config::defaultDevice_;
 
@@ -53,10 +90,44 @@ void Config::init() {
     if (auto flag = getBoolEnv("FT_DEBUG_BINARY"); flag.isValid()) {
         Config::setDebugBinary(*flag);
     }
+    if (auto flag = getBoolEnv("FT_COMPILE_CACHE"); flag.isValid()) {
+        Config::setCompileCache(*flag);
+    }
+    if (auto dir = getStrEnv("FT_COMPILE_CACHE_DIR"); dir.isValid()) {
+        Config::setCompileCacheDir(*dir);
+    } else if (auto home = getStrEnv("HOME"); home.isValid()) {
+        Config::setCompileCacheDir(*home + "/.freetensor/cache");
+    }
+    if (auto size = getSizeEnv("FT_COMPILE_CACHE_SIZE"); size.isValid()) {
+        Config::setCompileCacheSize(*size);
+    }
+    if (auto n = getSizeEnv("FT_BACKEND_COMPILER_JOBS"); n.isValid()) {
+        Config::setBackendCompilerJobs(*n);
+    }
+    if (auto bytes = getSizeEnv("FT_ARRAY_ALIGNMENT"); bytes.isValid()) {
+        Config::setArrayAlignment(*bytes);
+    }
+    if (auto size = getSizeEnv("FT_ARRAY_POOL_SIZE"); size.isValid()) {
+        Config::setArrayPoolSize(*size);
+    }
+    if (auto flag = getBoolEnv("FT_ARRAY_HUGE_PAGES"); flag.isValid()) {
+        Config::setArrayHugePages(*flag);
+    }
+    if (auto flag = getBoolEnv("FT_ARRAY_FIRST_TOUCH"); flag.isValid()) {
+        Config::setArrayFirstTouch(*flag);
+    }
     Config::setDefaultTarget(Ref<CPU>::make());
     Config::setDefaultDevice(Ref<Device>::make(Ref<CPU>::make()));
 }
 
+void Config::setArrayAlignment(size_t bytes) {
+    if (bytes < sizeof(void *) || (bytes & (bytes - 1)) != 0) {
+        throw DriverError("Alignment must be a power of 2 and at least " +
+                             std::to_string(sizeof(void *)));
+    }
+    arrayAlignment_ = bytes;
+}
+
 std::string Config::withMKL() {
 #ifdef FT_WITH_MKL
     return NAME(FT_WITH_MKL);
@@ -65,6 +136,16 @@ std::string Config::withMKL() {
 #endif
 }
 
+std::string Config::cpuBLAS() {
+#if defined(FT_WITH_MKL)
+    return "mkl";
+#elif defined(FT_CPU_BLAS)
+    return NAME(FT_CPU_BLAS);
+#else
+    return "builtin";
+#endif
+}
+
 bool Config::withCUDA() {
 #ifdef FT_WITH_CUDA
     return true;
@@ -1,9 +1,11 @@
 #include <chrono>
 #include <cstdio>  // remove
-#include <cstdlib> // mkdtemp, system
+#include <cstdlib> // mkdtemp
 #include <cstring> // memset
-#include <dlfcn.h> // dlopen
+#include <dlfcn.h> // dlerror
 #include <fstream>
+#include <mutex>
+#include <sstream>
 #include <sys/stat.h> // mkdir
 #include <unistd.h>   // rmdir
 
@@ -13,6 +15,11 @@
 #include <config.h>
 #include <debug.h>
 #include <driver.h>
+#include <driver/array_pool.h>
+#include <driver/build_pool.h>
+#include <driver/compile_cache.h>
+#include <driver/compiler_job.h>
+#include <driver/precompiled_header.h>
 #include <except.h>
 #ifdef FT_WITH_CUDA
 #include <driver/gpu.h>
@@ -23,6 +30,28 @@
 
 namespace freetensor {
 
+/**
+ * Name of the host CPU, used to tell apart binaries built with `-march=native`
+ * on different machines sharing one cache directory
+ */
+static const std::string &hostCPUName() {
+    static std::string name = []() {
+        std::ifstream is("/proc/cpuinfo");
+        std::string line, ret;
+        while (std::getline(is, line)) {
+            if (line.empty()) {
+                break; // Only the first processor
+            }
+            if (line.rfind("model name", 0) == 0 ||
+                line.rfind("flags", 0) == 0) {
+                ret += line + "\n";
+            }
+        }
+        return ret;
+    }();
+    return name;
+}
+
 static void *requestPtr(const Ref<Array> &arr, const Ref<Device> &device,
                         const Ref<Device> &hostDevice, MemType mtype,
                         AccessType atype) {
@@ -59,12 +88,70 @@ static void *requestPtr(const Ref<Array> &arr, const Ref<Device> &device,
     }
 }
 
+BatchBinary::BatchBinary(const std::vector<std::string> &srcs,
+                         const Ref<Device> &dev, bool asyncBuild)
+    : srcs_(srcs), dev_(dev) {
+    if (dev->type() != TargetType::CPU) {
+        throw DriverError("Only CPU programs can be built in a batch");
+    }
+
+    auto src = source(srcs);
+    if (asyncBuild) {
+        building_ = BuildPool::getInstance()
+                        .submit([src = std::move(src), dev]() {
+                            return Driver::buildAndLoad(src, dev);
+                        })
+                        .share();
+    } else {
+        std::promise<std::pair<Ref<Library>, double>> built;
+        built.set_value(Driver::buildAndLoad(src, dev));
+        building_ = built.get_future().share();
+    }
+}
+
+std::string BatchBinary::source(const std::vector<std::string> &srcs) {
+    // Include the runtime first, so the precompiled header can be used. Each
+    // program is then guarded by the runtime's include guard
+    std::string src = "#include <cpu_runtime.h>\n";
+    for (size_t i = 0, n = srcs.size(); i < n; i++) {
+        src += "#define run " + entry(i) + "\n";
+        src += "#define _run _" + entry(i) + "\n";
+        src += srcs[i];
+        src += "\n#undef run\n#undef _run\n";
+    }
+    return src;
+}
+
 Driver::Driver(const Func &f, const std::string &src, const Ref<Device> &dev,
+               const Ref<Device> &hostDev, bool asyncBuild)
+    : Driver(f, src, dev, hostDev, DeferBuild{}) {
+    if (asyncBuild) {
+        building_ = BuildPool::getInstance()
+                        .submit([src = src_, dev = dev_]() {
+                            return buildAndLoad(src, dev);
+                        })
+                        .share();
+    } else {
+        auto [lib, compileTime] = buildAndLoad(src_, dev_);
+        load(lib);
+        compileTime_ = compileTime;
+    }
+}
+
+Driver::Driver(const Func &f, const Ref<BatchBinary> &batch, size_t index,
                const Ref<Device> &hostDev)
+    : Driver(f, batch->src(index), batch->device(), hostDev, DeferBuild{}) {
+    entry_ = BatchBinary::entry(index);
+    batch_ = batch;
+    building_ = batch->building_; // Joined in `wait`
+}
+
+Driver::Driver(const Func &f, const std::string &src, const Ref<Device> &dev,
+               const Ref<Device> &hostDev, DeferBuild)
     : f_(f), src_(src), args_(f->params_.size(), nullptr),
       rawArgs(f->params_.size(), nullptr), rawRets(f->returns_.size(), nullptr),
       retShapes_(f->returns_.size(), nullptr), retDims_(f->returns_.size(), 0),
-      dev_(dev), hostDev_(hostDev) {
+      ret2param_(f->returns_.size(), -1), dev_(dev), hostDev_(hostDev) {
     auto nParams = f->params_.size();
     name2param_.reserve(nParams);
     name2buffer_.reserve(nParams);
@@ -82,21 +169,18 @@ Driver::Driver(const Func &f, const std::string &src, const Ref<Device> &dev,
         name2buffer_[f->params_[i].name_] =
             nodes.front().as<VarDefNode>()->buffer_;
     }
-    buildAndLoad();
+    for (size_t i = 0, n = f->returns_.size(); i < n; i++) {
+        if (auto it = name2param_.find(f->returns_[i].name_);
+            it != name2param_.end()) {
+            ret2param_[i] = it->second;
+        }
+    }
 }
 
-void Driver::buildAndLoad() {
-    std::string home = getenv("HOME");
-    mkdir((home + "/.freetensor").c_str(), 0755);
-    std::string path_string = home + "/.freetensor/XXXXXX";
-    char path[64];
-    ASSERT(path_string.size() < 64);
-    strncpy(path, path_string.c_str(), 63);
-    auto mkdtempPtr = mkdtemp(path);
-    ASSERT(mkdtempPtr != nullptr);
-
+double Driver::build(const std::string &src, const Ref<Device> &dev,
+                     const std::function<void(const std::string &)> &use) {
     std::string srcSuffix;
-    switch (dev_->type()) {
+    switch (dev->type()) {
     case TargetType::CPU:
         srcSuffix = ".cpp";
         break;
@@ -107,88 +191,135 @@ void Driver::buildAndLoad() {
         ASSERT(false);
     }
 
-    auto cpp = (std::string)path + "/run" + srcSuffix;
-    auto so = (std::string)path + "/run.so";
-    {
-        std::ofstream f(cpp);
-        f << src_;
-    }
-    std::string cmd;
+    std::vector<std::string> cmd, linkFlags;
     // We enable fast-math because our own transformations do not preserve
     // strict floating point rounding order either
-    switch (dev_->type()) {
+    switch (dev->type()) {
     case TargetType::CPU:
-        cmd = "c++ -I" NAME(FT_RUNTIME_DIR) " -std=c++17 -shared -O3 -fPIC "
-                                            "-Wall -fopenmp -ffast-math";
-        cmd += " -o " + so + " " + cpp;
+        // No GNU_UNIQUE symbols, e.g. static locals in inline functions of the
+        // runtime, or the binary would be marked NODELETE and never unloaded
+        cmd = {"c++",    "-I" NAME(FT_RUNTIME_DIR),
+               "-std=c++17", "-shared",
+               "-O3",    "-fPIC",
+               "-Wall",  "-fopenmp",
+               "-ffast-math", "-fno-gnu-unique"};
 #ifdef FT_WITH_MKL
-        cmd += " -I\"" NAME(FT_WITH_MKL) "/include\"";
-        cmd += " -Wl,--start-group";
-        cmd += " \"" NAME(FT_WITH_MKL) "/lib/intel64/libmkl_intel_lp64.a\"";
-        cmd += " \"" NAME(FT_WITH_MKL) "/lib/intel64/libmkl_gnu_thread.a\"";
-        cmd += " \"" NAME(FT_WITH_MKL) "/lib/intel64/libmkl_core.a\"";
-        cmd += " -Wl,--end-group";
-        cmd += " -DFT_WITH_MKL=\"" NAME(FT_WITH_MKL) "\"";
+        cmd.insert(cmd.end(), {"-I" NAME(FT_WITH_MKL) "/include",
+                               "-DFT_WITH_MKL=" NAME(FT_WITH_MKL)});
         // Link statically, or there will be dlopen issues
         // Generated with MKL Link Line Advisor
+        linkFlags = {"-Wl,--start-group",
+                     NAME(FT_WITH_MKL) "/lib/intel64/libmkl_intel_lp64.a",
+                     NAME(FT_WITH_MKL) "/lib/intel64/libmkl_gnu_thread.a",
+                     NAME(FT_WITH_MKL) "/lib/intel64/libmkl_core.a",
+                     "-Wl,--end-group"};
+#elif defined(FT_WITH_CBLAS)
+        cmd.insert(cmd.end(), {"-I" NAME(FT_CBLAS_INCLUDE_DIR),
+                               "-DFT_WITH_CBLAS=" NAME(FT_WITH_CBLAS)});
+        linkFlags = {NAME(FT_WITH_CBLAS),
+                     "-Wl,-rpath," NAME(FT_CBLAS_LIBRARY_DIR)};
 #endif // FT_WITH_MKL
-        if (dev_->target()->useNativeArch()) {
-            cmd += " -march=native";
+        if (dev->target()->useNativeArch()) {
+            cmd.emplace_back("-march=native");
         }
         if (Config::debugBinary()) {
-            cmd += " -g";
+            cmd.emplace_back("-g");
         }
         break;
 #ifdef FT_WITH_CUDA
     case TargetType::GPU:
-        cmd = "nvcc -I" NAME(FT_RUNTIME_DIR) " -std=c++17 -shared -Xcompiler "
-                                             "-fPIC,-Wall,-O3 --use_fast_math";
-        cmd += " -o " + so + " " + cpp;
-        cmd += " -lcublas";
-        if (auto arch = dev_->target().as<GPU>()->computeCapability();
+        cmd = {"nvcc",       "-I" NAME(FT_RUNTIME_DIR), "-std=c++17", "-shared",
+               "-Xcompiler", "-fPIC,-Wall,-O3",          "--use_fast_math"};
+        linkFlags = {"-lcublas"};
+        if (auto arch = dev->target().as<GPU>()->computeCapability();
             arch.isValid()) {
-            cmd += " -arch sm_" + std::to_string(arch->first) +
-                   std::to_string(arch->second);
-        } else if (dev_->target()->useNativeArch()) {
+            cmd.insert(cmd.end(),
+                       {"-arch", "sm_" + std::to_string(arch->first) +
+                                     std::to_string(arch->second)});
+        } else if (dev->target()->useNativeArch()) {
             int major, minor;
             checkCudaError(cudaDeviceGetAttribute(
-                &major, cudaDevAttrComputeCapabilityMajor, dev_->num()));
+                &major, cudaDevAttrComputeCapabilityMajor, dev->num()));
             checkCudaError(cudaDeviceGetAttribute(
-                &minor, cudaDevAttrComputeCapabilityMinor, dev_->num()));
-            cmd += " -arch sm_" + std::to_string(major) + std::to_string(minor);
+                &minor, cudaDevAttrComputeCapabilityMinor, dev->num()));
+            cmd.insert(cmd.end(), {"-arch", "sm_" + std::to_string(major) +
+                                                std::to_string(minor)});
         } else {
             WARNING("GPU arch not specified, which may result in suboptimal "
                     "performance ");
         }
         if (Config::debugBinary()) {
-            cmd += " -g";
+            cmd.emplace_back("-g");
         }
         break;
 #endif // FT_WITH_CUDA
     default:
         ASSERT(false);
     }
-    if (Config::debugBinary()) {
-        WARNING("debug-binary mode on. Compiling with " + cmd);
-    }
-    auto compilerErr = system(cmd.c_str());
-    if (compilerErr != 0) {
-        throw DriverError("Backend compiler reports error");
+
+    bool useCache = Config::compileCache() && !Config::debugBinary() &&
+                    !Config::compileCacheDir().empty();
+    // `-march=native` is resolved by the compiler on the current machine, so
+    // the host CPU must be part of the keys as well
+    auto hostKey = dev->target()->useNativeArch() ? " " + hostCPUName() : "";
+    std::string cacheKey;
+    if (useCache) {
+        cacheKey = CompileCache::key(src, joinCommand(cmd) + " " +
+                                              joinCommand(linkFlags) + hostKey);
+        if (auto cached = CompileCache::lookup(cacheKey); cached.isValid()) {
+            try {
+                use(*cached);
+                Config::countCompileCacheHit(); // Only if actually used
+                return 0;
+            } catch (const DriverError &) {
+                // It has just been evicted. Build it again
+            }
+        }
+        Config::countCompileCacheMiss();
     }
 
-    dlHandle_ = dlopen(so.c_str(), RTLD_NOW);
-    if (!dlHandle_) {
-        throw DriverError((std::string) "Unable to load target code: " +
-                          dlerror());
+    std::string home = getenv("HOME");
+    mkdir((home + "/.freetensor").c_str(), 0755);
+    std::string path_string = home + "/.freetensor/XXXXXX";
+    char path[64];
+    ASSERT(path_string.size() < 64);
+    strncpy(path, path_string.c_str(), 63);
+    auto mkdtempPtr = mkdtemp(path);
+    ASSERT(mkdtempPtr != nullptr);
+
+    auto cpp = (std::string)path + "/run" + srcSuffix;
+    auto so = (std::string)path + "/run.so";
+    {
+        std::ofstream f(cpp);
+        f << src;
+    }
+    if (useCache && dev->type() == TargetType::CPU) {
+        // The precompiled header only depends on the compiling flags
+        auto pchKey = CompileCache::key("", joinCommand(cmd) + hostKey);
+        if (auto pchDir = precompiledCPURuntime(cmd, pchKey);
+            pchDir.isValid()) {
+            // Must be searched before FT_RUNTIME_DIR
+            cmd.insert(cmd.begin() + 1, "-I" + *pchDir);
+        }
+    }
+    cmd.insert(cmd.end(), linkFlags.begin(), linkFlags.end());
+    cmd.insert(cmd.end(), {"-o", so, cpp});
+    if (Config::debugBinary()) {
+        WARNING("debug-binary mode on. Compiling with " + joinCommand(cmd));
     }
+    double compileTime = runCompilerJob(cmd);
 
-    func_ = (void (*)(void **, void **, size_t **, size_t *, void *))dlsym(
-        dlHandle_, "run");
-    if (!func_) {
-        throw DriverError((std::string) "Target function not found: " +
-                          dlerror());
+    if (useCache) {
+        try {
+            CompileCache::insert(cacheKey, so);
+        } catch (const DriverError &e) {
+            WARNING((std::string) "Unable to cache the compiled binary: " +
+                    e.what());
+        }
     }
 
+    use(so);
+
     if (!Config::debugBinary()) {
         remove(cpp.c_str());
         remove(so.c_str());
@@ -198,10 +329,76 @@ void Driver::buildAndLoad() {
                               "saved in " +
                 path);
     }
+    return compileTime;
+}
+
+std::pair<Ref<Library>, double>
+Driver::buildAndLoad(const std::string &src, const Ref<Device> &dev) {
+    Ref<Library> lib;
+    double compileTime = build(src, dev, [&](const std::string &path) {
+        lib = Library::open(path);
+    });
+    return {lib, compileTime};
+}
+
+std::pair<std::string, double>
+Driver::buildImage(const std::string &src, const Ref<Device> &dev) {
+    std::string image;
+    double compileTime = build(src, dev, [&](const std::string &path) {
+        std::ifstream is(path, std::ios::binary);
+        if (!is.is_open()) {
+            throw DriverError("Unable to read " + path);
+        }
+        std::ostringstream os;
+        os << is.rdbuf();
+        image = os.str();
+    });
+    return {image, compileTime};
+}
+
+/**
+ * Allocator for return values and dynamic-sized locals of the generated code on
+ * CPU. Return values end up in `Array`s, which release them to the same pool
+ */
+static void *poolAlloc(size_t bytes) {
+    return ArrayPool::getInstance().alloc(bytes);
+}
+static void poolFree(void *ptr) { ArrayPool::getInstance().free(ptr); }
+
+/**
+ * One thread pool for parallel loops of all the programs on CPU. It is created
+ * here instead of in the programs, so its workers never run code of an unloaded
+ * program. It is re-created when a program needs a larger stack or a different
+ * pinning, and the old one is kept until no program uses it
+ */
+static std::shared_ptr<ThreadPool> sharedThreadPool(size_t stackBytes,
+                                                    bool pinned) {
+    static std::mutex lock;
+    static std::shared_ptr<ThreadPool> pool;
+    std::lock_guard<std::mutex> guard(lock);
+    if (pool == nullptr || pool->stackBytes() < stackBytes ||
+        pool->pinned() != pinned) {
+        if (pool != nullptr) {
+            stackBytes = std::max(stackBytes, pool->stackBytes());
+        }
+        pool = std::make_shared<ThreadPool>(0, stackBytes, pinned);
+    }
+    return pool;
+}
+
+void Driver::load(const Ref<Library> &lib) {
+    lib_ = lib;
+    func_ = (void (*)(void **, void **, size_t **, size_t *, void *))
+        lib_->symbol(entry_);
+    if (!func_) {
+        throw DriverError((std::string) "Target function not found: " +
+                          dlerror());
+    }
 
     switch (dev_->type()) {
     case TargetType::CPU:
-        ctx_ = std::make_unique<CPUContext>();
+        ctx_ = std::make_unique<CPUContext>(poolAlloc, poolFree,
+                                            sharedThreadPool);
         break;
 #ifdef FT_WITH_CUDA
     case TargetType::GPU:
@@ -283,7 +480,33 @@ void Driver::setArgs(const std::vector<Ref<Array>> &args,
     }
 }
 
+void Driver::wait() {
+    if (building_.valid()) {
+        // Keep the future if the building failed, so every later call
+        // rethrows the error, instead of running a program not loaded
+        auto [lib, compileTime] = building_.get();
+        load(lib);
+        compileTime_ = compileTime;
+        building_ = {};
+    }
+}
+
+double Driver::compileTime() {
+    wait();
+    return compileTime_;
+}
+
+bool Driver::isReady() const {
+    return !building_.valid() ||
+           building_.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+}
+
 void Driver::run() {
+    wait();
+    if (func_ == nullptr) {
+        throw DriverError("No binary is loaded");
+    }
 #ifdef FT_WITH_CUDA
     if (dev_->type() == TargetType::GPU) {
         checkCudaError(cudaSetDevice(dev_->num()));
@@ -300,15 +523,19 @@ std::vector<Ref<Array>> Driver::collectReturns() {
     for (size_t i = 0, n = f_->returns_.size(); i < n; i++) {
         auto &&[name, dtype, closure, returnClosure] = f_->returns_[i];
         Ref<Array> val;
-        if (name2param_.count(name)) {
+        if (ret2param_[i] != -1) {
             // Returning an argument
-            val = args_.at(name2param_.at(name));
+            val = args_.at(ret2param_[i]);
         } else {
             std::vector<size_t> shape(retShapes_[i],
                                       retShapes_[i] + retDims_[i]);
             val = Ref<Array>::make(rawRets[i], shape, dtype, dev_);
             if (retShapes_[i] != nullptr) {
-                free(retShapes_[i]);
+                if (dev_->type() == TargetType::CPU) {
+                    poolFree(retShapes_[i]);
+                } else {
+                    free(retShapes_[i]);
+                }
             }
             rawRets[i] = nullptr;
             retShapes_[i] = nullptr;
@@ -331,61 +558,145 @@ std::vector<Ref<Array>> Driver::collectReturns() {
     return ret;
 }
 
-double Driver::time(int rounds, int warmups) {
-    namespace ch = std::chrono;
-
-    double tot = 0;
-    auto tgtType = dev_->type();
-    for (int i = 0; i < warmups; i++) {
-        run();
-        switch (tgtType) {
+TimingResult Driver::benchmark(const TimingOptions &options) {
+    std::function<void()> flush;
 #ifdef FT_WITH_CUDA
-        case TargetType::GPU:
+    std::unique_ptr<void, cudaError_t (*)(void *)> flushBuf(nullptr,
+                                                            cudaFree);
+    int flushBytes = 0;
+    if (dev_->type() == TargetType::GPU && options.flushCache_) {
+        // Evict the L2 cache by writing through a buffer twice as large
+        checkCudaError(cudaDeviceGetAttribute(
+            &flushBytes, cudaDevAttrL2CacheSize, dev_->num()));
+        flushBytes = std::max(flushBytes, 1 << 20) * 2;
+        void *ptr;
+        checkCudaError(cudaMalloc(&ptr, flushBytes));
+        flushBuf.reset(ptr);
+        flush = [&]() {
+            checkCudaError(cudaMemset(flushBuf.get(), 0, flushBytes));
             checkCudaError(cudaDeviceSynchronize());
-#endif // FT_WITH_CUDA
-        default:;
-        }
+        };
     }
-    for (int i = 0; i < rounds; i++) {
-#ifdef FT_WITH_CUDA
-        auto cudaErr = cudaSuccess;
 #endif // FT_WITH_CUDA
 
-        auto beg = ch::high_resolution_clock::now();
+    auto tgtType = dev_->type();
+    auto runAndSync = [&]() {
         run();
         switch (tgtType) {
 #ifdef FT_WITH_CUDA
         case TargetType::GPU:
-            cudaErr = cudaDeviceSynchronize();
+            checkCudaError(cudaDeviceSynchronize());
 #endif // FT_WITH_CUDA
         default:;
         }
-        auto end = ch::high_resolution_clock::now();
-        double dur =
-            ch::duration_cast<ch::duration<double>>(end - beg).count() *
-            1000; // ms
+    };
 
-#ifdef FT_WITH_CUDA
-        if (cudaErr) {
-            throw DriverError(cudaGetErrorString(cudaErr));
+    return measureTime(runAndSync, options, flush);
+}
+
+double Driver::time(int rounds, int warmups) {
+    TimingOptions options;
+    options.warmups_ = warmups;
+    options.minRounds_ = options.maxRounds_ = rounds;
+    return benchmark(options).mean_;
+}
+
+BoundCall Driver::prepare(
+    const std::vector<Ref<Array>> &args,
+    const std::unordered_map<std::string, Ref<Array>> &kws) {
+    return BoundCall(*this, args, kws);
+}
+
+BoundCall::BoundCall(Driver &driver, const std::vector<Ref<Array>> &args,
+                     const std::unordered_map<std::string, Ref<Array>> &kws)
+    : driver_(driver) {
+    driver_.setArgs(args, kws); // Full validation
+    auto &&params = driver_.f_->params_;
+    for (size_t i = 0, n = params.size(); i < n; i++) {
+        if (driver_.args_[i].isValid()) {
+            auto &&buffer = driver_.name2buffer_.at(params[i].name_);
+            slots_.push_back({i, params[i].name_, buffer->mtype(),
+                              buffer->atype(), params[i].updateClosure_,
+                              driver_.args_[i]->dtype(),
+                              driver_.args_[i]->shape()});
+        } else {
+            ASSERT(params[i].isInClosure());
+            closures_.emplace_back(i);
         }
-#endif // FT_WITH_CUDA
+    }
+    // Release the arguments, as `collectReturns` does
+    std::fill(driver_.args_.begin(), driver_.args_.end(), nullptr);
+    std::fill(driver_.rawArgs.begin(), driver_.rawArgs.end(), nullptr);
+}
 
-        tot += dur;
+std::vector<Ref<Array>>
+BoundCall::operator()(const std::vector<Ref<Array>> &args) {
+    auto &d = driver_;
+    if (args.size() != slots_.size()) {
+        throw DriverError("Expected " + std::to_string(slots_.size()) +
+                          " arguments, but " + std::to_string(args.size()) +
+                          " are given");
     }
-    return tot / rounds;
+
+    bool match = true;
+    for (auto &&[slot, arg] : iter::zip(slots_, args)) {
+        if (arg->dtype() != slot.dtype_ || arg->shape() != slot.shape_) {
+            match = false;
+            break;
+        }
+    }
+
+    if (match) {
+        // Fast path
+        for (auto &&[slot, arg] : iter::zip(slots_, args)) {
+            d.args_[slot.param_] = arg;
+            d.rawArgs[slot.param_] = requestPtr(arg, d.dev_, d.hostDev_,
+                                                slot.mtype_, slot.atype_);
+            if (slot.updateClosure_) {
+                *d.f_->params_[slot.param_].closure_ = arg;
+            }
+        }
+        for (size_t i : closures_) {
+            auto &&param = d.f_->params_[i];
+            if (!param.closure_->isValid()) {
+                throw DriverError("Closure variable " + param.name_ +
+                                  " is not set");
+            }
+            auto &&buffer = d.name2buffer_.at(param.name_);
+            d.rawArgs[i] = requestPtr(*param.closure_, d.dev_, d.hostDev_,
+                                      buffer->mtype(), buffer->atype());
+        }
+    } else {
+        std::unordered_map<std::string, Ref<Array>> kws;
+        for (auto &&[slot, arg] : iter::zip(slots_, args)) {
+            kws[slot.name_] = arg;
+        }
+        d.setArgs(kws);
+        for (auto &&[slot, arg] : iter::zip(slots_, args)) {
+            slot.dtype_ = arg->dtype();
+            slot.shape_ = arg->shape();
+        }
+    }
+
+    d.run();
+    return d.collectReturns();
 }
 
 void Driver::unload() {
     func_ = nullptr;
-    // FIXME: How to safely close it? OpenMP won't kill its worker threads
-    // before it ends
-    /*if (dlHandle_) {
-        auto err = dlclose(dlHandle_);
-        if (err) {
-            WARNING("Unable to unload target code");
-        }
-    }*/
+    if (lib_.isValid() && dev_->type() != TargetType::CPU) {
+        // Kernels launched from the library may be still running
+        try {
+            dev_->sync();
+        } catch (const std::exception &e) {
+            WARNING((std::string) "Unable to sync before unloading: " +
+                    e.what());
+        }
+    }
+    // Worker threads of the context may be running code of the library, so
+    // stop them first
+    ctx_ = nullptr;
+    lib_ = nullptr; // Unloaded when no other Driver is using it
 }
 
 } // namespace freetensor
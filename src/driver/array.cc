@@ -2,6 +2,7 @@
 
 #include <config.h>
 #include <driver/array.h>
+#include <driver/array_pool.h>
 #include <except.h>
 #ifdef FT_WITH_CUDA
 #include <driver/gpu.h>
@@ -9,11 +10,23 @@
 
 namespace freetensor {
 
+/**
+ * Whether two devices share the same memory, so an Array needs only one copy
+ * of its data for both. Devices are compared by value, not by the `Ref`, so
+ * equal `Device` objects created separately do not cause a copy
+ */
+static bool sameMemory(const Ref<Device> &lhs, const Ref<Device> &rhs) {
+    if (lhs->type() == TargetType::CPU && rhs->type() == TargetType::CPU) {
+        return true; // All CPU devices use the host memory
+    }
+    return *lhs == *rhs;
+}
+
 static uint8_t *allocOn(size_t size, const Ref<Device> &device) {
     uint8_t *ptr = nullptr;
     switch (device->type()) {
     case TargetType::CPU:
-        ptr = new uint8_t[size];
+        ptr = (uint8_t *)ArrayPool::getInstance().alloc(size);
         break;
 #ifdef FT_WITH_CUDA
     case TargetType::GPU:
@@ -30,7 +43,7 @@ static void freeFrom(uint8_t *&ptr, const Ref<Device> &device) {
     if (ptr != nullptr) {
         switch (device->type()) {
         case TargetType::CPU:
-            delete[] ptr;
+            ArrayPool::getInstance().free(ptr);
             ptr = nullptr;
             break;
 #ifdef FT_WITH_CUDA
@@ -107,18 +120,32 @@ Array::Array(void *ptr, const std::vector<size_t> &shape, DataType dtype,
     size_ = nElem_ * sizeOf(dtype_);
 }
 
+Array::Array(void *ptr, const std::vector<size_t> &shape, DataType dtype,
+             const Ref<Device> &device, const std::shared_ptr<void> &owner)
+    : Array(shape, dtype, device) {
+    if (device->type() != TargetType::CPU) {
+        throw DriverError("Only CPU memory can be borrowed");
+    }
+    ptrs_ = {{device, (uint8_t *)ptr}};
+    borrowed_ = (uint8_t *)ptr;
+    borrowedOwner_ = owner;
+}
+
 Array::~Array() {
     for (auto &&[device, ptr] : ptrs_) {
-        freeFrom(ptr, device);
+        release(ptr, device);
     }
 }
 
 Array::Array(Array &&other)
     : ptrs_(std::move(other.ptrs_)), size_(other.size_), nElem_(other.nElem_),
       shape_(std::move(other.shape_)), dtype_(other.dtype_),
-      preferDevice_(std::move(other.preferDevice_)) {
+      preferDevice_(std::move(other.preferDevice_)),
+      borrowed_(other.borrowed_),
+      borrowedOwner_(std::move(other.borrowedOwner_)) {
     other.ptrs_.clear(); // MUST!
     other.size_ = 0;
+    other.borrowed_ = nullptr;
 }
 
 Array &Array::operator=(Array &&other) {
@@ -127,14 +154,27 @@ Array &Array::operator=(Array &&other) {
     nElem_ = other.nElem_;
     dtype_ = other.dtype_;
     preferDevice_ = std::move(other.preferDevice_);
+    borrowed_ = other.borrowed_;
+    borrowedOwner_ = std::move(other.borrowedOwner_);
     other.ptrs_.clear(); // MUST!
     other.size_ = 0;
+    other.borrowed_ = nullptr;
     return *this;
 }
 
+void Array::release(uint8_t *&ptr, const Ref<Device> &device) {
+    if (ptr != nullptr && ptr == borrowed_) {
+        ptr = nullptr;
+        borrowed_ = nullptr;
+        borrowedOwner_ = nullptr; // Not freed by us
+    } else {
+        freeFrom(ptr, device);
+    }
+}
+
 void *Array::rawSharedTo(const Ref<Device> &device) {
     for (auto &&[d, p] : ptrs_) {
-        if (d == device) {
+        if (sameMemory(d, device)) {
             return p;
         }
     }
@@ -161,10 +201,10 @@ done:
 
 void *Array::rawMovedTo(const Ref<Device> &device) {
     for (auto [d, p] : ptrs_) {
-        if (d == device) {
+        if (sameMemory(d, device)) {
             for (auto &&[_d, _p] : ptrs_) {
                 if (_p != p) {
-                    freeFrom(_p, _d);
+                    release(_p, _d);
                 }
             }
             ptrs_ = {{d, p}};
@@ -189,7 +229,7 @@ void *Array::rawMovedTo(const Ref<Device> &device) {
     }
 done:
     for (auto &&[d, p] : ptrs_) {
-        freeFrom(p, d);
+        release(p, d);
     }
     ptrs_ = {{device, ptr}};
     return ptr;
@@ -197,10 +237,10 @@ done:
 
 void *Array::rawInitTo(const Ref<Device> &device) {
     for (auto [d, p] : ptrs_) {
-        if (d == device) {
+        if (sameMemory(d, device)) {
             for (auto &&[_d, _p] : ptrs_) {
                 if (_p != p) {
-                    freeFrom(_p, _d);
+                    release(_p, _d);
                 }
             }
             ptrs_ = {{d, p}};
@@ -209,12 +249,23 @@ void *Array::rawInitTo(const Ref<Device> &device) {
     }
     auto ptr = allocOn(size_, device);
     for (auto &&[d, p] : ptrs_) {
-        freeFrom(p, d);
+        release(p, d);
     }
     ptrs_ = {{device, ptr}};
     return ptr;
 }
 
+void *Array::rawSharedToCPU() {
+    for (auto &&[d, p] : ptrs_) {
+        if (d->type() == TargetType::CPU) {
+            return p;
+        }
+    }
+    return rawSharedTo(preferDevice_->type() == TargetType::CPU
+                           ? preferDevice_
+                           : Ref<Device>::make(Ref<CPU>::make()));
+}
+
 void Array::fromCPU(const void *other, size_t size) {
     ASSERT(size == size_);
     copyFromCPU(rawInitTo(preferDevice_), other, size_, preferDevice_);
@@ -0,0 +1,150 @@
+#include <algorithm>  // min
+#include <cstdlib>    // aligned_alloc, free
+#include <omp.h>
+#include <sys/mman.h> // madvise
+#include <unistd.h>   // sysconf
+
+#include <config.h>
+#include <driver/array_pool.h>
+#include <except.h>
+
+namespace freetensor {
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+size_t ArrayPool::sizeClass(size_t size) {
+    if (size <= 64) {
+        return 64;
+    }
+    // Round up to a multiple of 1/8 of the power of 2 above it, so less than
+    // 25% is wasted
+    size_t step = 1;
+    while (step * 8 < size) {
+        step <<= 1;
+    }
+    return (size + step - 1) / step * step;
+}
+
+void *ArrayPool::sysAlloc(size_t size, size_t align, size_t used) {
+    // `aligned_alloc` requires the size to be a multiple of the alignment
+    void *ptr = aligned_alloc(align, (size + align - 1) / align * align);
+    if (ptr == nullptr) {
+        throw DriverError("Out of memory allocating " + std::to_string(size) +
+                          " bytes");
+    }
+    if (align >= HUGE_PAGE_SIZE) {
+        madvise(ptr, size, MADV_HUGEPAGE); // Only a hint
+    }
+    if (Config::arrayFirstTouch()) {
+        firstTouch(ptr, used, align >= HUGE_PAGE_SIZE);
+    }
+    return ptr;
+}
+
+void ArrayPool::firstTouch(void *ptr, size_t size, bool hugePages) {
+    // Linux places a page on the NUMA node of the thread touching it first.
+    // Split the bytes in use, not the whole size class, among the threads as
+    // a statically scheduled `parallel for` in generated code splits its
+    // iterations, and let each thread touch the pages starting in its part.
+    // The threads are also bound with `proc_bind(spread)`, as if the target
+    // pins threads
+    size_t page = hugePages ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+    auto bytes = (volatile uint8_t *)ptr;
+#pragma omp parallel proc_bind(spread) if (size >= 64 * page)
+    {
+        // The same partition as `schedule(static)` of libgomp
+        size_t n = omp_get_num_threads(), t = omp_get_thread_num();
+        size_t q = size / n, r = size % n;
+        size_t begin = t * q + std::min(t, r), end = begin + q + (t < r);
+        for (size_t p = (begin + page - 1) / page; p * page < end; p++) {
+            bytes[p * page] = 0;
+        }
+    }
+}
+
+void *ArrayPool::alloc(size_t size) {
+    size_t used = size;
+    size = sizeClass(size);
+    size_t align = Config::arrayAlignment();
+    if (Config::arrayHugePages() && size >= HUGE_PAGE_SIZE) {
+        align = std::max(align, HUGE_PAGE_SIZE);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (auto it = cache_.find(size); it != cache_.end()) {
+            auto &&list = it->second;
+            // Only reuse a block with the current alignment, in case the
+            // configuration has changed
+            for (size_t i = list.size(); i > 0; i--) {
+                if (auto [ptr, blockAlign] = list[i - 1]; blockAlign == align) {
+                    list.erase(list.begin() + (i - 1));
+                    stats_.cachedBytes_ -= size;
+                    stats_.liveBytes_ += size;
+                    stats_.hits_++;
+                    live_[ptr] = {size, align};
+                    return ptr;
+                }
+            }
+        }
+    }
+
+    void *ptr = sysAlloc(size, align, used);
+    std::lock_guard<std::mutex> guard(lock_);
+    stats_.liveBytes_ += size;
+    stats_.misses_++;
+    live_[ptr] = {size, align};
+    return ptr;
+}
+
+void ArrayPool::free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = live_.find(ptr);
+    if (it == live_.end()) {
+        // Not from `alloc`, e.g., allocated by a program with `malloc`. We
+        // don't know its size, so just release it. Throwing is no better here,
+        // because we are usually called from a destructor
+        ::free(ptr);
+        return;
+    }
+    auto [size, align] = it->second;
+    live_.erase(it);
+    stats_.liveBytes_ -= size;
+    if (stats_.cachedBytes_ + size <= Config::arrayPoolSize()) {
+        cache_[size].emplace_back(ptr, align);
+        stats_.cachedBytes_ += size;
+    } else {
+        ::free(ptr);
+    }
+}
+
+void ArrayPool::trimTo(size_t maxBytes) {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto it = cache_.begin();
+         it != cache_.end() && stats_.cachedBytes_ > maxBytes;) {
+        auto &&[size, list] = *it;
+        while (!list.empty() && stats_.cachedBytes_ > maxBytes) {
+            ::free(list.back().first);
+            list.pop_back();
+            stats_.cachedBytes_ -= size;
+        }
+        it = list.empty() ? cache_.erase(it) : std::next(it);
+    }
+}
+
+ArrayPool::Stats ArrayPool::stats() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return stats_;
+}
+
+ArrayPool &ArrayPool::getInstance() {
+    // Never destroyed, because Arrays held by Python may be freed after static
+    // destructors
+    static ArrayPool *instance = new ArrayPool();
+    return *instance;
+}
+
+} // namespace freetensor
@@ -0,0 +1,46 @@
+#include <algorithm>
+
+#include <driver/build_pool.h>
+
+namespace freetensor {
+
+BuildPool::BuildPool(size_t nThreads) {
+    workers_.reserve(nThreads);
+    for (size_t i = 0; i < nThreads; i++) {
+        workers_.emplace_back([this]() {
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> guard(lock_);
+                    cv_.wait(guard,
+                             [this]() { return stop_ || !jobs_.empty(); });
+                    if (stop_) {
+                        return;
+                    }
+                    job = std::move(jobs_.front());
+                    jobs_.pop();
+                }
+                job(); // Exceptions are caught by std::packaged_task
+            }
+        });
+    }
+}
+
+BuildPool::~BuildPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stop_ = true; // Pending jobs are dropped, and their futures are broken
+    }
+    cv_.notify_all();
+    for (auto &&worker : workers_) {
+        worker.join();
+    }
+}
+
+BuildPool &BuildPool::getInstance() {
+    static BuildPool instance(
+        std::max(1u, std::thread::hardware_concurrency()));
+    return instance;
+}
+
+} // namespace freetensor
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstdlib> // mkstemp
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unistd.h> // close
+
+#include <config.h>
+#include <debug.h>
+#include <driver/compile_cache.h>
+#include <except.h>
+#include <hash_combine.h>
+
+#define NAME_(macro) #macro
+#define NAME(macro) NAME_(macro)
+
+namespace freetensor {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string toHex(uint64_t x) {
+    std::ostringstream os;
+    os << std::hex;
+    os.width(16);
+    os.fill('0');
+    os << x;
+    return os.str();
+}
+
+/**
+ * Hash all the runtime headers, so a modification to the runtime invalidates
+ * the cache
+ */
+const std::string &runtimeFingerprint() {
+    static std::string fingerprint = []() {
+        std::vector<fs::path> files;
+        std::error_code ec;
+        for (auto &&entry :
+             fs::directory_iterator(NAME(FT_RUNTIME_DIR), ec)) {
+            if (entry.is_regular_file()) {
+                files.emplace_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        std::string content;
+        for (auto &&file : files) {
+            std::ifstream is(file);
+            std::ostringstream os;
+            os << is.rdbuf();
+            content += file.filename().string() + "\n" + os.str() + "\n";
+        }
+        return toHex(fnv1a(content));
+    }();
+    return fingerprint;
+}
+
+fs::path entryPath(const std::string &key) {
+    return fs::path(Config::compileCacheDir()) / (key + ".so");
+}
+
+} // Anonymous namespace
+
+std::string CompileCache::key(const std::string &src, const std::string &cmd) {
+    auto content = runtimeFingerprint() + "\n" + cmd + "\n" + src;
+    // Two independent hashes, to make collisions negligible
+    return toHex(fnv1a(content)) +
+           toHex(fnv1a(content, 0x84222325cbf29ce4ull));
+}
+
+Opt<std::string> CompileCache::lookup(const std::string &key) {
+    auto path = entryPath(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return nullptr;
+    }
+    // Mark as recently used. If the entry is evicted concurrently, this fails
+    // silently, and the caller will fail to load it and rebuild
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return Opt<std::string>::make(path.string());
+}
+
+std::string CompileCache::insert(const std::string &key,
+                                 const std::string &path) {
+    auto dir = fs::path(Config::compileCacheDir());
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        throw DriverError("Unable to create the compilation cache directory " +
+                          dir.string() + ": " + ec.message());
+    }
+
+    // Write to a temporary file in the same directory, and then rename it, so
+    // other processes never see an incomplete file
+    auto tmp = (dir / (key + ".so.XXXXXX")).string();
+    int fd = mkstemp(tmp.data());
+    if (fd == -1) {
+        throw DriverError("Unable to create a file in " + dir.string());
+    }
+    close(fd);
+    fs::copy_file(path, tmp, fs::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        fs::rename(tmp, entryPath(key), ec);
+    }
+    if (ec) {
+        std::error_code ec1; // Keep the first error to report
+        fs::remove(tmp, ec1);
+        throw DriverError("Unable to insert into the compilation cache: " +
+                          ec.message());
+    }
+
+    evict(Config::compileCacheSize());
+    return entryPath(key).string();
+}
+
+void CompileCache::evict(size_t maxBytes) {
+    struct Entry {
+        fs::path path_;
+        fs::file_time_type time_;
+        size_t size_;
+    };
+    std::vector<Entry> entries;
+    size_t total = 0;
+    auto dir = fs::path(Config::compileCacheDir());
+    std::error_code ec;
+
+    // Binaries of programs, each in a file
+    for (auto &&item : fs::directory_iterator(dir, ec)) {
+        if (item.path().extension() != ".so") {
+            continue; // Including temporary files being written
+        }
+        std::error_code ec1, ec2;
+        auto time = item.last_write_time(ec1);
+        auto size = item.file_size(ec2);
+        if (ec1 || ec2) {
+            continue; // Evicted by another process
+        }
+        entries.push_back({item.path(), time, size});
+        total += size;
+    }
+
+    // Precompiled headers and measurement workers, each in a directory named
+    // by its key, which is marked as recently used when used
+    for (auto &&sub : {"pch", "measure_worker"}) {
+        for (auto &&item : fs::directory_iterator(dir / sub, ec)) {
+            if (item.path().has_extension()) {
+                continue; // Temporary directories being written
+            }
+            std::error_code ec1, ec2;
+            auto time = item.last_write_time(ec1);
+            size_t size = 0;
+            for (auto &&file :
+                 fs::recursive_directory_iterator(item.path(), ec2)) {
+                std::error_code ec3;
+                if (!file.is_symlink(ec3) && file.is_regular_file(ec3)) {
+                    auto fileSize = file.file_size(ec3);
+                    size += ec3 ? 0 : fileSize;
+                }
+            }
+            if (ec1 || ec2) {
+                continue; // Evicted by another process
+            }
+            entries.push_back({item.path(), time, size});
+            total += size;
+        }
+    }
+
+    if (total <= maxBytes) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &lhs, const Entry &rhs) {
+                  return lhs.time_ < rhs.time_;
+              });
+    for (auto &&entry : entries) {
+        if (total <= maxBytes) {
+            break;
+        }
+        // Removing a loaded binary or a running worker is safe, because the
+        // mapped pages are kept until it is unloaded. A precompiled header or
+        // a worker removed from under its user in this process is built again
+        // on its next use
+        fs::remove_all(entry.path_, ec);
+        total -= entry.size_;
+    }
+}
+
+} // namespace freetensor
@@ -0,0 +1,151 @@
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring> // strerror
+#include <fcntl.h> // O_CLOEXEC
+#include <mutex>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <config.h>
+#include <driver/compiler_job.h>
+#include <except.h>
+
+extern char **environ;
+
+namespace freetensor {
+
+namespace {
+
+/**
+ * Limit the number of concurrent compiler processes
+ *
+ * We do not use `std::counting_semaphore`, because the limit is set at run
+ * time
+ */
+class CompilerSlots {
+    std::mutex lock_;
+    std::condition_variable cv_;
+    size_t running_ = 0;
+
+  public:
+    void acquire() {
+        std::unique_lock<std::mutex> guard(lock_);
+        cv_.wait(guard, [this]() { return running_ < maxCompilerJobs(); });
+        running_++;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            running_--;
+        }
+        cv_.notify_one();
+    }
+
+    static CompilerSlots &getInstance() {
+        static CompilerSlots instance;
+        return instance;
+    }
+};
+
+class CompilerSlotGuard {
+  public:
+    CompilerSlotGuard() { CompilerSlots::getInstance().acquire(); }
+    ~CompilerSlotGuard() { CompilerSlots::getInstance().release(); }
+};
+
+} // Anonymous namespace
+
+size_t maxCompilerJobs() {
+    if (auto n = Config::backendCompilerJobs(); n > 0) {
+        return n;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+double runCompilerJob(const std::vector<std::string> &argv) {
+    namespace ch = std::chrono;
+
+    ASSERT(!argv.empty());
+    std::vector<char *> cArgv;
+    cArgv.reserve(argv.size() + 1);
+    for (auto &&arg : argv) {
+        cArgv.emplace_back(const_cast<char *>(arg.c_str()));
+    }
+    cArgv.emplace_back(nullptr);
+
+    CompilerSlotGuard slot;
+
+    // Set O_CLOEXEC, or a child spawned by another thread concurrently will
+    // inherit our pipe, and we will not see EOF until that child ends
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        throw DriverError("Unable to create a pipe for the backend compiler");
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+
+    auto beg = ch::high_resolution_clock::now();
+    pid_t pid;
+    int err = posix_spawnp(&pid, cArgv[0], &actions, nullptr, cArgv.data(),
+                           environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (err != 0) {
+        close(fds[0]);
+        throw DriverError("Unable to start the backend compiler " + argv[0] +
+                          ": " + strerror(err));
+    }
+
+    std::string output;
+    char buf[4096];
+    while (true) {
+        auto n = read(fds[0], buf, sizeof(buf));
+        if (n > 0) {
+            output.append(buf, n);
+        } else if (n == 0 || errno != EINTR) {
+            break;
+        }
+    }
+    close(fds[0]);
+
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            throw DriverError("Unable to wait for the backend compiler");
+        }
+    }
+    auto end = ch::high_resolution_clock::now();
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw DriverError("Backend compiler reports error. Command: " +
+                          joinCommand(argv) + "\n" + output);
+    }
+    if (Config::debugBinary() && !output.empty()) {
+        WARNING("Backend compiler output:\n" + output);
+    }
+    return ch::duration_cast<ch::duration<double>>(end - beg).count() *
+           1000; // ms
+}
+
+std::string joinCommand(const std::vector<std::string> &argv) {
+    std::string ret;
+    for (auto &&arg : argv) {
+        if (!ret.empty()) {
+            ret += " ";
+        }
+        if (arg.find_first_of(" \"'\\$") != std::string::npos) {
+            ret += "'" + arg + "'";
+        } else {
+            ret += arg;
+        }
+    }
+    return ret;
+}
+
+} // namespace freetensor
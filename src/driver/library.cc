@@ -0,0 +1,122 @@
+#include <dlfcn.h>
+#include <link.h> // dl_iterate_phdr
+#include <mutex>
+#include <unordered_map>
+
+#include <debug.h>
+#include <driver/library.h>
+#include <except.h>
+
+namespace freetensor {
+
+namespace {
+
+std::mutex registryLock;
+std::unordered_map<void *, Weak<Library>> registry; // Guarded by registryLock
+size_t residentCount_ = 0, residentBytes_ = 0;      // Guarded by registryLock
+
+/**
+ * Sum up the sizes of the loadable segments of a loaded binary
+ */
+size_t mappedBytes(void *handle) {
+    struct link_map *map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) != 0 || map == nullptr) {
+        return 0;
+    }
+    struct Query {
+        ElfW(Addr) base_;
+        size_t bytes_;
+    } query{map->l_addr, 0};
+    dl_iterate_phdr(
+        [](struct dl_phdr_info *info, size_t, void *data) {
+            auto query = (Query *)data;
+            if (info->dlpi_addr != query->base_) {
+                return 0;
+            }
+            for (int i = 0; i < info->dlpi_phnum; i++) {
+                if (info->dlpi_phdr[i].p_type == PT_LOAD) {
+                    query->bytes_ += info->dlpi_phdr[i].p_memsz;
+                }
+            }
+            return 1;
+        },
+        &query);
+    return query.bytes_;
+}
+
+/**
+ * Pin the OpenMP runtime used by a binary, so it is never unloaded together
+ * with the binary while its worker threads are still alive
+ */
+void pinOpenMPRuntime(void *handle) {
+    static std::once_flag flag;
+    if (auto sym = dlsym(handle, "omp_get_num_threads"); sym != nullptr) {
+        std::call_once(flag, [sym]() {
+            Dl_info info;
+            if (dladdr(sym, &info) != 0 && info.dli_fname != nullptr) {
+                // RTLD_NODELETE keeps it even after all references are closed
+                dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD | RTLD_NODELETE);
+            }
+        });
+    }
+}
+
+} // Anonymous namespace
+
+Library::Library(void *handle, const std::string &path)
+    : handle_(handle), path_(path), bytes_(mappedBytes(handle)) {}
+
+Library::~Library() {
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+        // The handle may have been opened again after our reference count
+        // dropped to 0. Only remove the entry if it is ours
+        if (auto it = registry.find(handle_);
+            it != registry.end() && !it->second.lock().isValid()) {
+            registry.erase(it);
+        }
+        residentCount_--;
+        residentBytes_ -= bytes_;
+    }
+    if (dlclose(handle_) != 0) {
+        WARNING("Unable to unload " + path_);
+    }
+}
+
+Ref<Library> Library::open(const std::string &path) {
+    void *handle = dlopen(path.c_str(), RTLD_NOW);
+    if (handle == nullptr) {
+        throw DriverError((std::string) "Unable to load target code: " +
+                          dlerror());
+    }
+    pinOpenMPRuntime(handle);
+
+    std::lock_guard<std::mutex> guard(registryLock);
+    if (auto it = registry.find(handle); it != registry.end()) {
+        if (auto lib = it->second.lock(); lib.isValid()) {
+            dlclose(handle); // Drop the extra reference in the dynamic loader
+            return lib;
+        }
+    }
+    auto lib = Ref<Library>::make(handle, path);
+    registry[handle] = lib;
+    residentCount_++;
+    residentBytes_ += lib->bytes();
+    return lib;
+}
+
+void *Library::symbol(const std::string &name) const {
+    return dlsym(handle_, name.c_str());
+}
+
+size_t Library::residentCount() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    return residentCount_;
+}
+
+size_t Library::residentBytes() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    return residentBytes_;
+}
+
+} // namespace freetensor
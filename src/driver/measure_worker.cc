@@ -0,0 +1,321 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring> // strerror, strsignal
+#include <filesystem>
+#include <mutex>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <config.h>
+#include <driver/compile_cache.h>
+#include <driver/compiler_job.h>
+#include <driver/measure_worker.h>
+#include <except.h>
+
+#define NAME_(macro) #macro
+#define NAME(macro) NAME_(macro)
+
+extern char **environ;
+
+namespace freetensor {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<size_t> nextId{1};
+
+void appendU64(std::string &msg, uint64_t x) {
+    msg.append((const char *)&x, sizeof(x));
+}
+
+void appendF64(std::string &msg, double x) {
+    msg.append((const char *)&x, sizeof(x));
+}
+
+void appendBytes(std::string &msg, const std::string &bytes) {
+    appendU64(msg, bytes.size());
+    msg += bytes;
+}
+
+/**
+ * Get the worker executable, and build it if not built yet
+ *
+ * It is stored in `<compileCacheDir>/measure_worker/<key>/`, where the key
+ * covers the runtime sources, and published by atomically renaming a complete
+ * directory, as the precompiled header is
+ *
+ * Returned by value, because the path is reassigned once it is evicted and
+ * rebuilt, which may happen while another thread is starting a worker
+ */
+std::string measureWorkerPath() {
+    static std::mutex lock;
+    static std::string path;
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::error_code ec;
+    // Build again if it has been evicted from the cache since
+    if (!path.empty() && fs::is_regular_file(path, ec)) {
+        // Mark as recently used, for `CompileCache::evict`
+        fs::last_write_time(fs::path(path).parent_path(),
+                            fs::file_time_type::clock::now(), ec);
+        return path;
+    }
+
+    std::vector<std::string> cmd = {
+        "c++",         "-I" NAME(FT_RUNTIME_DIR), "-std=c++17", "-O2", "-Wall",
+        "-pthread",    NAME(FT_RUNTIME_DIR) "/cpu_measure_worker.cc",
+        "-ldl"};
+    auto root = Config::compileCacheDir().empty()
+                    ? fs::temp_directory_path() / "freetensor"
+                    : fs::path(Config::compileCacheDir());
+    auto dir = root / "measure_worker" /
+               CompileCache::key("", joinCommand(cmd));
+    auto exe = dir / "ft_measure_worker";
+
+    if (!fs::is_regular_file(exe, ec)) {
+        fs::create_directories(dir.parent_path(), ec);
+        if (ec) {
+            throw DriverError("Unable to create " +
+                              dir.parent_path().string() + ": " +
+                              ec.message());
+        }
+        auto tmp = dir.string() + ".XXXXXX";
+        if (mkdtemp(tmp.data()) == nullptr) {
+            throw DriverError("Unable to create a directory in " +
+                              dir.parent_path().string());
+        }
+        cmd.insert(cmd.end(),
+                   {"-o", (fs::path(tmp) / exe.filename()).string()});
+        try {
+            runCompilerJob(cmd);
+        } catch (const DriverError &e) {
+            fs::remove_all(tmp, ec);
+            throw DriverError((std::string) "Unable to build the measurement "
+                                            "worker: " +
+                              e.what());
+        }
+        fs::rename(tmp, dir, ec);
+        if (ec) {
+            // Probably another process has published it first
+            fs::remove_all(tmp, ec);
+        }
+    } else {
+        fs::last_write_time(dir, fs::file_time_type::clock::now(), ec);
+    }
+    return path = exe.string();
+}
+
+} // Anonymous namespace
+
+MeasureImage::MeasureImage(std::string bytes)
+    : id_(nextId++), bytes_(std::move(bytes)) {}
+
+MeasureArgs::MeasureArgs(std::vector<std::string> bytes)
+    : id_(nextId++), bytes_(std::move(bytes)) {}
+
+Ref<MeasureArgs>
+MeasureArgs::pack(const Func &func, const std::vector<Ref<Array>> &args,
+                  const std::unordered_map<std::string, Ref<Array>> &kws) {
+    std::vector<std::string> bytes;
+    bytes.reserve(func->params_.size());
+    auto nextArg = args.begin();
+    for (auto &&param : func->params_) {
+        Ref<Array> arr;
+        if (!param.isInClosure() || param.updateClosure_) {
+            if (nextArg != args.end()) {
+                arr = *nextArg++;
+            }
+        }
+        if (auto it = kws.find(param.name_); it != kws.end()) {
+            arr = it->second;
+        }
+        if (!arr.isValid() && param.isInClosure()) {
+            arr = *param.closure_;
+        }
+        if (!arr.isValid()) {
+            throw DriverError("Parameter " + param.name_ + " is missing");
+        }
+        auto &&item = bytes.emplace_back(arr->size(), '\0');
+        arr->toCPU(item.data(), item.size());
+    }
+    if (nextArg != args.end()) {
+        throw DriverError("More arguments are given than required");
+    }
+    return Ref<MeasureArgs>::make(std::move(bytes));
+}
+
+void MeasureWorker::start() {
+    auto path = measureWorkerPath();
+    std::vector<std::string> argv = {path, std::to_string(options_.memLimit_)};
+    std::vector<char *> cArgv;
+    for (auto &&arg : argv) {
+        cArgv.emplace_back(const_cast<char *>(arg.c_str()));
+    }
+    cArgv.emplace_back(nullptr);
+
+    // A socket instead of a pipe, so we can send with MSG_NOSIGNAL, and get an
+    // error instead of a SIGPIPE if the worker has died. Set SOCK_CLOEXEC, or
+    // other children will inherit it and hide the death of the worker
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        throw DriverError("Unable to create a socket for the measurement "
+                          "worker");
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDIN_FILENO);
+    int err = posix_spawn(&pid_, cArgv[0], &actions, nullptr, cArgv.data(),
+                          environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (err != 0) {
+        close(fds[0]);
+        pid_ = -1;
+        throw DriverError("Unable to start the measurement worker " + path +
+                          ": " + strerror(err));
+    }
+    sock_ = fds[0];
+    imageId_ = argsId_ = 0;
+}
+
+void MeasureWorker::stop() {
+    if (pid_ == -1) {
+        return;
+    }
+    close(sock_);
+    kill(pid_, SIGKILL);
+    while (waitpid(pid_, nullptr, 0) == -1 && errno == EINTR)
+        ;
+    pid_ = -1;
+    sock_ = -1;
+}
+
+void MeasureWorker::fail(const std::string &reason) {
+    stop();
+    throw DriverError("Measurement worker " + reason);
+}
+
+std::string MeasureWorker::request(const std::string &msg, size_t replyBytes) {
+    namespace ch = std::chrono;
+
+    for (size_t done = 0; done < msg.size();) {
+        auto n = send(sock_, msg.data() + done, msg.size() - done,
+                      MSG_NOSIGNAL);
+        if (n >= 0) {
+            done += n;
+        } else if (errno != EINTR) {
+            break; // The worker has died. We will see EOF below
+        }
+    }
+
+    auto deadline = ch::steady_clock::now() +
+                    ch::duration_cast<ch::steady_clock::duration>(
+                        ch::duration<double>(options_.timeout_));
+    auto recvAll = [&](void *buf, size_t bytes) {
+        for (size_t done = 0; done < bytes;) {
+            auto left = ch::duration_cast<ch::milliseconds>(
+                            deadline - ch::steady_clock::now())
+                            .count();
+            if (left <= 0) {
+                fail("timed out after " + std::to_string(options_.timeout_) +
+                     " s");
+            }
+            struct pollfd pfd = {sock_, POLLIN, 0};
+            if (auto ready = poll(&pfd, 1, left);
+                ready == 0 || (ready < 0 && errno == EINTR)) {
+                continue; // Timed out or interrupted. Checked above
+            }
+            auto n = recv(sock_, (char *)buf + done, bytes - done, 0);
+            if (n > 0) {
+                done += n;
+            } else if (n == 0 || errno != EINTR) {
+                int status;
+                while (waitpid(pid_, &status, 0) == -1 && errno == EINTR)
+                    ;
+                pid_ = -1; // Reaped
+                close(sock_);
+                sock_ = -1;
+                if (WIFSIGNALED(status)) {
+                    fail((std::string) "crashed: " +
+                         strsignal(WTERMSIG(status)));
+                }
+                fail("exited with status " +
+                     std::to_string(WEXITSTATUS(status)));
+            }
+        }
+    };
+
+    char kind;
+    recvAll(&kind, 1);
+    if (kind == 'E') {
+        uint64_t len;
+        recvAll(&len, sizeof(len));
+        std::string err(len, '\0');
+        recvAll(err.data(), len);
+        throw DriverError(err);
+    }
+    if (kind != 'K') {
+        fail("sent an invalid reply");
+    }
+    std::string ret(replyBytes, '\0');
+    recvAll(ret.data(), replyBytes);
+    return ret;
+}
+
+TimingResult MeasureWorker::time(const Ref<MeasureImage> &image,
+                                 const std::string &entry,
+                                 const Ref<MeasureArgs> &args, size_t nRets,
+                                 const TimingOptions &options) {
+    if (pid_ == -1) {
+        start();
+    }
+    if (imageId_ != image->id_) {
+        imageId_ = 0; // Unknown state if failed
+        std::string msg = "L";
+        appendBytes(msg, image->bytes_);
+        request(msg, 0);
+        imageId_ = image->id_;
+    }
+    if (argsId_ != args->id_) {
+        argsId_ = 0; // Unknown state if failed
+        std::string msg = "A";
+        appendU64(msg, args->bytes_.size());
+        for (auto &&item : args->bytes_) {
+            appendBytes(msg, item);
+        }
+        request(msg, 0);
+        argsId_ = args->id_;
+    }
+    std::string msg = "T";
+    appendBytes(msg, entry);
+    appendU64(msg, nRets);
+    appendU64(msg, options.warmups_);
+    appendU64(msg, options.minRounds_);
+    appendU64(msg, options.maxRounds_);
+    appendF64(msg, options.maxRelCI_);
+    appendF64(msg, options.minRoundTime_);
+    appendU64(msg, options.flushCache_);
+
+    double stats[5];
+    uint64_t counts[2];
+    auto reply = request(msg, sizeof(stats) + sizeof(counts));
+    memcpy(stats, reply.data(), sizeof(stats));
+    memcpy(counts, reply.data() + sizeof(stats), sizeof(counts));
+    TimingResult ret;
+    ret.mean_ = stats[0];
+    ret.median_ = stats[1];
+    ret.trimmedMean_ = stats[2];
+    ret.stddev_ = stats[3];
+    ret.relCI_ = stats[4];
+    ret.rounds_ = counts[0];
+    ret.repeats_ = counts[1];
+    return ret;
+}
+
+} // namespace freetensor
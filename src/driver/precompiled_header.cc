@@ -0,0 +1,98 @@
+#include <cstdlib> // mkdtemp
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+#include <config.h>
+#include <debug.h>
+#include <driver/compiler_job.h>
+#include <driver/precompiled_header.h>
+#include <except.h>
+
+#define NAME_(macro) #macro
+#define NAME(macro) NAME_(macro)
+
+namespace freetensor {
+
+namespace fs = std::filesystem;
+
+Opt<std::string> precompiledCPURuntime(const std::vector<std::string> &flags,
+                                       const std::string &key) {
+    static std::mutex lock;
+    static std::unordered_map<std::string, Opt<std::string>> built;
+
+    auto dir = fs::path(Config::compileCacheDir()) / "pch" / key;
+
+    auto gch = dir / "cpu_runtime.h.gch";
+    std::error_code ec;
+
+    // Hold the lock while building, so other compilations with the same flags
+    // wait for the header instead of parsing the runtime by themselves
+    std::lock_guard<std::mutex> guard(lock);
+    if (auto it = built.find(dir.string()); it != built.end()) {
+        // Build again if it has been evicted from the cache since
+        if (!it->second.isValid() || fs::is_regular_file(gch, ec)) {
+            // Mark as recently used, for `CompileCache::evict`
+            fs::last_write_time(dir, fs::file_time_type::clock::now(), ec);
+            return it->second;
+        }
+    }
+    auto &ret = built[dir.string()]; // Null if failed, and we won't try again
+    ret = nullptr;
+
+    if (fs::is_regular_file(gch, ec)) {
+        fs::last_write_time(dir, fs::file_time_type::clock::now(), ec);
+        return ret = Opt<std::string>::make(dir.string());
+    }
+
+    fs::create_directories(dir.parent_path(), ec);
+    if (ec) {
+        WARNING("Unable to create " + dir.parent_path().string() + ": " +
+                ec.message());
+        return ret;
+    }
+    auto tmp = dir.string() + ".XXXXXX";
+    if (mkdtemp(tmp.data()) == nullptr) {
+        WARNING("Unable to create a directory in " +
+                dir.parent_path().string());
+        return ret;
+    }
+
+    auto cmd = flags;
+    cmd.insert(cmd.end(),
+               {"-x", "c++-header", NAME(FT_RUNTIME_DIR) "/cpu_runtime.h", "-o",
+                (fs::path(tmp) / gch.filename()).string()});
+    try {
+        runCompilerJob(cmd);
+    } catch (const DriverError &e) {
+        WARNING((std::string) "Unable to precompile the CPU runtime: " +
+                e.what());
+        fs::remove_all(tmp, ec);
+        return ret;
+    }
+
+    // Once the precompiled header is used, the compiler resolves any later
+    // inclusion of the header (e.g., in a batch of programs) into this
+    // directory, so put the plain header here as well. The later inclusions
+    // are then skipped by its include guard
+    fs::create_symlink(NAME(FT_RUNTIME_DIR) "/cpu_runtime.h",
+                       fs::path(tmp) / "cpu_runtime.h", ec);
+    if (ec) {
+        WARNING("Unable to link the CPU runtime into " + tmp + ": " +
+                ec.message());
+        fs::remove_all(tmp, ec);
+        return ret;
+    }
+
+    fs::rename(tmp, dir, ec);
+    if (ec) {
+        // Probably another process has published it first
+        fs::remove_all(tmp, ec);
+    }
+    if (fs::is_regular_file(gch, ec)) {
+        ret = Opt<std::string>::make(dir.string());
+    }
+    return ret;
+}
+
+} // namespace freetensor
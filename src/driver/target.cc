@@ -10,8 +10,12 @@ bool isSame(const Ref<Target> &lhs, const Ref<Target> &rhs) {
         return false;
     }
     switch (lhs->type()) {
-    case TargetType::CPU:
-        return true;
+    case TargetType::CPU: {
+        auto &&l = lhs.as<CPU>(), &&r = rhs.as<CPU>();
+        return l->explicitVectorBytes() == r->explicitVectorBytes() &&
+               l->parallelRuntime() == r->parallelRuntime() &&
+               l->pinThreads() == r->pinThreads();
+    }
     case TargetType::GPU: {
         auto &&l = lhs.as<GPU>(), &&r = rhs.as<GPU>();
         if (l->computeCapability() != r->computeCapability()) {
@@ -24,4 +28,22 @@ bool isSame(const Ref<Target> &lhs, const Ref<Target> &rhs) {
     }
 }
 
+int CPU::vectorBytes() const {
+    if (auto bytes = vectorBytes_; bytes.isValid()) {
+        return *bytes;
+    }
+    if (useNativeArch()) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return 64;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return 32;
+        }
+#endif
+    }
+    return 16;
+}
+
 } // namespace freetensor
@@ -1,6 +1,10 @@
 #include <func.h>
+#include <hash.h>
+
 namespace freetensor {
 
+void FuncNode::compHash() { hash_ = Hasher::compHash(*this); }
+
 Func deepCopy(const Func &func) {
     return _makeFunc(func->name_, func->params_, func->returns_,
                      deepCopy(func->body_));
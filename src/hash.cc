@@ -46,6 +46,27 @@ size_t Hasher::compHash(const ForProperty &p) {
         h = ((h + std::hash<std::string>()(item)) * K2 + B2) % P;
     }
     h = ((h + std::hash<bool>()(p.preferLibs_)) * K2 + B2) % P;
+    for (auto &&item : p.streamingStores_) {
+        h = ((h + std::hash<std::string>()(item)) * K2 + B2) % P;
+    }
+    return (h * K3 + B3) % P;
+}
+
+size_t Hasher::compHash(const FuncNode &op) {
+    size_t h = ((size_t)op.nodeType() * K1 + B1) % P;
+    h = ((h + std::hash<std::string>()(op.name_)) * K2 + B2) % P;
+    for (auto &&param : op.params_) {
+        h = ((h + std::hash<std::string>()(param.name_)) * K2 + B2) % P;
+        h = ((h + std::hash<bool>()(param.isInClosure())) * K2 + B2) % P;
+        h = ((h + std::hash<bool>()(param.updateClosure_)) * K2 + B2) % P;
+    }
+    for (auto &&ret : op.returns_) {
+        h = ((h + std::hash<std::string>()(ret.name_)) * K2 + B2) % P;
+        h = ((h + std::hash<int>()((int)ret.dtype_)) * K2 + B2) % P;
+        h = ((h + std::hash<bool>()(ret.isInClosure())) * K2 + B2) % P;
+        h = ((h + std::hash<bool>()(ret.returnClosure_)) * K2 + B2) % P;
+    }
+    h = ((h + op.body_->hash()) * K2 + B2) % P;
     return (h * K3 + B3) % P;
 }
 
@@ -368,6 +389,32 @@ bool HashComparator::compare(const Assume &lhs, const Assume &rhs) const {
     return true;
 }
 
+bool HashComparator::compare(const Func &lhs, const Func &rhs) const {
+    if (lhs->name_ != rhs->name_) {
+        return false;
+    }
+    if (lhs->params_.size() != rhs->params_.size()) {
+        return false;
+    }
+    for (auto &&[l, r] : iter::zip(lhs->params_, rhs->params_)) {
+        if (l.name_ != r.name_ || l.isInClosure() != r.isInClosure() ||
+            l.updateClosure_ != r.updateClosure_) {
+            return false;
+        }
+    }
+    if (lhs->returns_.size() != rhs->returns_.size()) {
+        return false;
+    }
+    for (auto &&[l, r] : iter::zip(lhs->returns_, rhs->returns_)) {
+        if (l.name_ != r.name_ || l.dtype_ != r.dtype_ ||
+            l.isInClosure() != r.isInClosure() ||
+            l.returnClosure_ != r.returnClosure_) {
+            return false;
+        }
+    }
+    return (*this)(lhs->body_, rhs->body_);
+}
+
 bool HashComparator::compare(const Eval &lhs, const Eval &rhs) const {
     return (*this)(lhs->expr_, rhs->expr_);
 }
@@ -545,6 +592,9 @@ bool HashComparator::operator()(const Ref<ForProperty> &lhs,
     if (lhs->preferLibs_ != rhs->preferLibs_) {
         return false;
     }
+    if (lhs->streamingStores_ != rhs->streamingStores_) {
+        return false;
+    }
     return true;
 }
 
@@ -584,6 +634,7 @@ bool HashComparator::operator()(const AST &lhs, const AST &rhs) const {
     case ASTNodeType::name:                                                    \
         return compare(lhs.as<name##Node>(), rhs.as<name##Node>());
 
+        DISPATCH(Func);
         DISPATCH(
             Any); // HashComparator does not treat Any as a universal matcher
         DISPATCH(StmtSeq);
@@ -7,4 +7,13 @@ size_t hashCombine(size_t seed, size_t other) {
     return seed ^ (other + 0x9e3779b9 + (seed << 6) + (seed >> 2));
 }
 
+uint64_t fnv1a(const std::string &data, uint64_t basis) {
+    uint64_t h = basis;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
 } // namespace freetensor
@@ -0,0 +1,498 @@
+#include <algorithm>
+
+#include <analyze/all_uses.h>
+#include <analyze/analyze_linear.h>
+#include <pass/cpu/lower_vector.h>
+#include <pass/replace_iter.h>
+#include <pass/simplify.h>
+
+namespace freetensor {
+
+namespace cpu {
+
+namespace {
+
+class InvalidCPUVector : public InvalidProgram {
+  public:
+    InvalidCPUVector(const std::string &msg) : InvalidProgram(msg) {}
+};
+
+} // namespace
+
+bool LowerVector::isVarying(const Expr &op) const {
+    return allIters(op).count(var_);
+}
+
+int LowerVector::varyingDim(const std::vector<Expr> &indices) const {
+    for (size_t i = 0, n = indices.size(); i < n; i++) {
+        if (isVarying(indices[i])) {
+            if (i + 1 != n) {
+                throw InvalidCPUVector(
+                    "Only the last dimension of an access may depend on the "
+                    "vectorized loop");
+            }
+            return i;
+        }
+    }
+    return -1;
+}
+
+Expr LowerVector::contiguousBase(const Expr &index) const {
+    bool found = false;
+    for (auto &&[k, a] : linear(index).coeff_) {
+        if (a->nodeType() == ASTNodeType::Var &&
+            a.as<VarNode>()->name_ == var_) {
+            if (k != 1) {
+                return nullptr;
+            }
+            found = true;
+        } else if (allIters(a).count(var_)) {
+            return nullptr;
+        }
+    }
+    return found ? ReplaceIter(var_, lane0_)(index) : nullptr;
+}
+
+std::string LowerVector::vecType(DataType dtype) const {
+    return "Vec<" + tmplArgs(dtype) + ">";
+}
+
+std::string LowerVector::tmplArgs(DataType dtype) const {
+    std::string ret;
+    switch (dtype) {
+    case DataType::Float64:
+        ret = "double";
+        break;
+    case DataType::Float32:
+        ret = "float";
+        break;
+    case DataType::Int64:
+        ret = "int64_t";
+        break;
+    case DataType::Int32:
+        ret = "int32_t";
+        break;
+    default:
+        throw InvalidCPUVector("Unsupported data type " + toString(dtype));
+    }
+    return ret + ", " + std::to_string(vecLen_);
+}
+
+std::string LowerVector::laneCntArg(std::vector<Expr> &params) {
+    if (laneCnt_.isValid()) {
+        params.emplace_back(laneCnt_);
+        return ", %";
+    }
+    return "";
+}
+
+LowerVector::VecExpr LowerVector::convert(const VecExpr &expr,
+                                          DataType dtype) {
+    if (expr.maskBytes_ > 0) {
+        throw InvalidCPUVector("Using a comparison result as a value");
+    }
+    if (expr.dtype_ == dtype) {
+        return expr;
+    }
+    return {"__builtin_convertvector(" + expr.code_ + ", " + vecType(dtype) +
+                ")",
+            dtype};
+}
+
+LowerVector::VecExpr LowerVector::vectorizeAs(const Expr &op, DataType dtype,
+                                              std::vector<Expr> &params) {
+    if (!isVarying(op)) {
+        params.emplace_back(op);
+        return {"vecBroadcast<" + tmplArgs(dtype) + ">(%)", dtype};
+    }
+    return convert(vectorize(op, params), dtype);
+}
+
+Expr LowerVector::baseAddr(const std::string &var,
+                           const std::vector<Expr> &indices,
+                           const Expr &base) {
+    auto newIndices = indices;
+    newIndices.back() = base;
+    return makeLoad(var, std::move(newIndices));
+}
+
+LowerVector::VecExpr LowerVector::vectorize(const Expr &op,
+                                            std::vector<Expr> &params) {
+    if (!isVarying(op)) {
+        return vectorizeAs(op, dtype(op), params);
+    }
+
+    auto binary = [&](const std::string &fmtBegin, const std::string &fmtMid,
+                      const std::string &fmtEnd, const Expr &lhs,
+                      const Expr &rhs, DataType dtype) {
+        auto l = vectorizeAs(lhs, dtype, params);
+        auto r = vectorizeAs(rhs, dtype, params);
+        return fmtBegin + l.code_ + fmtMid + r.code_ + fmtEnd;
+    };
+    auto compare = [&](const std::string &sign, const Expr &lhs,
+                       const Expr &rhs) -> VecExpr {
+        auto dtype = upCast(this->dtype(lhs), this->dtype(rhs));
+        return {binary("(", " " + sign + " ", ")", lhs, rhs, dtype), dtype,
+                (int)sizeOf(dtype)};
+    };
+    auto logic = [&](const std::string &sign, const Expr &lhs,
+                     const Expr &rhs) -> VecExpr {
+        if (!isVarying(lhs) || !isVarying(rhs)) {
+            throw InvalidCPUVector("Mixing a loop-invariant condition with a "
+                                   "vectorized one");
+        }
+        auto l = vectorize(lhs, params);
+        auto r = vectorize(rhs, params);
+        if (l.maskBytes_ == 0 || l.maskBytes_ != r.maskBytes_) {
+            throw InvalidCPUVector("Mixing conditions of different widths");
+        }
+        return {"(" + l.code_ + " " + sign + " " + r.code_ + ")", l.dtype_,
+                l.maskBytes_};
+    };
+
+    switch (op->nodeType()) {
+    case ASTNodeType::Var:
+        // Must be `var_`, or it is not varying
+        params.emplace_back(lane0_);
+        return {"vecIota<" + tmplArgs(DataType::Int32) + ">(%)",
+                DataType::Int32};
+
+    case ASTNodeType::Load: {
+        auto &&load = op.as<LoadNode>();
+        auto dtype = buffer(load->var_)->tensor()->dtype();
+        varyingDim(load->indices_); // Only to check
+        if (auto base = contiguousBase(load->indices_.back());
+            base.isValid()) {
+            params.emplace_back(baseAddr(load->var_, load->indices_, base));
+            auto code = "vecLoad" + suffix() + "<" + tmplArgs(dtype) + ">(&%";
+            code += laneCntArg(params) + ")";
+            return {code, dtype};
+        } else {
+            params.emplace_back(
+                baseAddr(load->var_, load->indices_, makeIntConst(0)));
+            auto idx = vectorize(load->indices_.back(), params);
+            if (!isInt(idx.dtype_) || idx.maskBytes_ > 0) {
+                throw InvalidCPUVector("Non-integer index");
+            }
+            auto code = "vecGather" + suffix() + "<" + tmplArgs(dtype) +
+                        ">(&%, " + idx.code_;
+            code += laneCntArg(params) + ")";
+            return {code, dtype};
+        }
+    }
+
+    case ASTNodeType::Add: {
+        auto &&e = op.as<AddNode>();
+        auto dtype = this->dtype(op);
+        return {binary("(", " + ", ")", e->lhs_, e->rhs_, dtype), dtype};
+    }
+    case ASTNodeType::Sub: {
+        auto &&e = op.as<SubNode>();
+        auto dtype = this->dtype(op);
+        return {binary("(", " - ", ")", e->lhs_, e->rhs_, dtype), dtype};
+    }
+    case ASTNodeType::Mul: {
+        auto &&e = op.as<MulNode>();
+        auto dtype = this->dtype(op);
+        return {binary("(", " * ", ")", e->lhs_, e->rhs_, dtype), dtype};
+    }
+    case ASTNodeType::RealDiv: {
+        auto &&e = op.as<RealDivNode>();
+        auto dtype = this->dtype(op);
+        if (!isFloat(dtype)) {
+            throw InvalidCPUVector("Integer division");
+        }
+        return {binary("(", " / ", ")", e->lhs_, e->rhs_, dtype), dtype};
+    }
+    case ASTNodeType::Min: {
+        auto &&e = op.as<MinNode>();
+        auto dtype = this->dtype(op);
+        return {binary("vecMin(", ", ", ")", e->lhs_, e->rhs_, dtype), dtype};
+    }
+    case ASTNodeType::Max: {
+        auto &&e = op.as<MaxNode>();
+        auto dtype = this->dtype(op);
+        return {binary("vecMax(", ", ", ")", e->lhs_, e->rhs_, dtype), dtype};
+    }
+
+    case ASTNodeType::LT:
+        return compare("<", op.as<LTNode>()->lhs_, op.as<LTNode>()->rhs_);
+    case ASTNodeType::LE:
+        return compare("<=", op.as<LENode>()->lhs_, op.as<LENode>()->rhs_);
+    case ASTNodeType::GT:
+        return compare(">", op.as<GTNode>()->lhs_, op.as<GTNode>()->rhs_);
+    case ASTNodeType::GE:
+        return compare(">=", op.as<GENode>()->lhs_, op.as<GENode>()->rhs_);
+    case ASTNodeType::EQ:
+        return compare("==", op.as<EQNode>()->lhs_, op.as<EQNode>()->rhs_);
+    case ASTNodeType::NE:
+        return compare("!=", op.as<NENode>()->lhs_, op.as<NENode>()->rhs_);
+    case ASTNodeType::LAnd:
+        return logic("&", op.as<LAndNode>()->lhs_, op.as<LAndNode>()->rhs_);
+    case ASTNodeType::LOr:
+        return logic("|", op.as<LOrNode>()->lhs_, op.as<LOrNode>()->rhs_);
+
+    case ASTNodeType::IfExpr: {
+        auto &&e = op.as<IfExprNode>();
+        auto dtype = this->dtype(op);
+        std::string cond;
+        if (isVarying(e->cond_)) {
+            auto c = vectorize(e->cond_, params);
+            if (c.maskBytes_ != (int)sizeOf(dtype)) {
+                throw InvalidCPUVector(
+                    "Selecting values of a different width from the "
+                    "condition");
+            }
+            cond = c.code_;
+        } else {
+            params.emplace_back(e->cond_);
+            cond = "%";
+        }
+        auto thenCase = vectorizeAs(e->thenCase_, dtype, params);
+        auto elseCase = vectorizeAs(e->elseCase_, dtype, params);
+        return {"(" + cond + " ? " + thenCase.code_ + " : " + elseCase.code_ +
+                    ")",
+                dtype};
+    }
+
+    case ASTNodeType::Cast: {
+        auto &&e = op.as<CastNode>();
+        return convert(vectorize(e->expr_, params), e->dtype_);
+    }
+
+    default:
+        throw InvalidCPUVector(toString(op->nodeType()) +
+                               " is not supported in a vectorized loop");
+    }
+}
+
+Stmt LowerVector::lowerBody(const Stmt &body, const Expr &lane0,
+                            const Expr &laneCnt) {
+    lane0_ = lane0;
+    laneCnt_ = laneCnt;
+    return (*this)(body);
+}
+
+Stmt LowerVector::visitStmt(const Stmt &op) {
+    if (!var_.empty()) {
+        switch (op->nodeType()) {
+        case ASTNodeType::StmtSeq:
+        case ASTNodeType::Store:
+        case ASTNodeType::ReduceTo:
+        case ASTNodeType::If:
+            break;
+        default:
+            throw InvalidCPUVector(toString(op->nodeType()) +
+                                   " is not supported in a vectorized loop");
+        }
+    }
+    auto ret = BaseClass::visitStmt(op);
+    if (!var_.empty() && laneCnt_.isValid()) {
+        // In the tail, which is a second copy of the body besides the main
+        // loop. Give it new IDs, or the IDs would be duplicated
+        ret->setId(ID());
+    }
+    return ret;
+}
+
+Stmt LowerVector::visit(const For &op) {
+    auto &&streaming = op->property_->streamingStores_;
+    auto oldStreaming = streaming_.size();
+    streaming_.insert(streaming_.end(), streaming.begin(), streaming.end());
+    auto ret = op->property_->vectorize_ ? lowerLoop(op) : BaseClass::visit(op);
+    streaming_.resize(oldStreaming);
+    return ret;
+}
+
+Stmt LowerVector::lowerLoop(const For &op) {
+    try {
+        if (op->step_->nodeType() != ASTNodeType::IntConst ||
+            op->step_.as<IntConstNode>()->val_ != 1) {
+            throw InvalidCPUVector("Only loops with step 1 are supported");
+        }
+        size_t maxBytes = sizeOf(DataType::Int32); // For the iterator
+        for (auto &&name : allUses(op->body_)) {
+            if (!hasDef(name)) {
+                throw InvalidCPUVector("Local variable " + name +
+                                       " defined in a vectorized loop");
+            }
+            auto dtype = buffer(name)->tensor()->dtype();
+            if (!isNumber(dtype)) {
+                throw InvalidCPUVector("Unsupported data type " +
+                                       toString(dtype) + " of " + name);
+            }
+            maxBytes = std::max(maxBytes, sizeOf(dtype));
+        }
+        vecLen_ = vectorBytes_ / maxBytes;
+        if (vecLen_ < 2) {
+            throw InvalidCPUVector("The target has no vector registers");
+        }
+
+        var_ = op->iter_;
+        auto vecLen = makeIntConst(vecLen_);
+        auto mainLen = makeFloorDiv(op->len_, vecLen);
+        auto tailLen = makeMod(op->len_, vecLen);
+
+        auto main = deepCopy(op).as<ForNode>();
+        main->len_ = mainLen;
+        main->end_ = makeAdd(main->begin_, mainLen);
+        main->property_->vectorize_ = false; // done
+        main->body_ = lowerBody(
+            op->body_,
+            makeAdd(makeMul(makeSub(makeVar(var_), op->begin_), vecLen),
+                    op->begin_),
+            nullptr);
+
+        // The last iteration with only some lanes active. It is out of the
+        // loop and not fenced with it, so it uses regular stores
+        streaming_.resize(streaming_.size() -
+                          op->property_->streamingStores_.size());
+        auto tail = makeIf(
+            "", makeNE(tailLen, makeIntConst(0)),
+            lowerBody(op->body_, makeAdd(op->begin_, makeMul(mainLen, vecLen)),
+                      tailLen));
+
+        var_.clear();
+        lane0_ = laneCnt_ = nullptr;
+        return makeStmtSeq("", {main, tail});
+    } catch (const InvalidCPUVector &e) {
+        var_.clear();
+        lane0_ = laneCnt_ = nullptr;
+        WARNING("Vectorizing loop " + op->id().strId() +
+                " failed because: " + e.what() +
+                ". It is left to the backend compiler");
+        return BaseClass::visit(op);
+    }
+}
+
+Stmt LowerVector::visit(const If &op) {
+    if (!var_.empty() && isVarying(op->cond_)) {
+        throw InvalidCPUVector(
+            "Branching on a condition depending on the vectorized loop");
+    }
+    return BaseClass::visit(op);
+}
+
+Stmt LowerVector::visit(const Store &op) {
+    if (var_.empty()) {
+        return BaseClass::visit(op);
+    }
+    if (varyingDim(op->indices_) == -1) {
+        if (isVarying(op->expr_)) {
+            throw InvalidCPUVector("Storing values from all lanes to the "
+                                   "same location in " +
+                                   op->var_);
+        }
+        return BaseClass::visit(op);
+    }
+
+    auto dtype = buffer(op->var_)->tensor()->dtype();
+    std::vector<Expr> params;
+    std::string code;
+    if (auto base = contiguousBase(op->indices_.back()); base.isValid()) {
+        params.emplace_back(baseAddr(op->var_, op->indices_, base));
+        auto val = vectorizeAs(op->expr_, dtype, params);
+        bool stream = std::find(streaming_.begin(), streaming_.end(),
+                                op->var_) != streaming_.end();
+        code = (stream ? "vecStreamStore" : "vecStore") + suffix() + "<" +
+               tmplArgs(dtype) + ">(&%, " + val.code_;
+    } else {
+        params.emplace_back(baseAddr(op->var_, op->indices_, makeIntConst(0)));
+        auto idx = vectorize(op->indices_.back(), params);
+        if (!isInt(idx.dtype_) || idx.maskBytes_ > 0) {
+            throw InvalidCPUVector("Non-integer index");
+        }
+        auto val = vectorizeAs(op->expr_, dtype, params);
+        code = "vecScatter" + suffix() + "<" + tmplArgs(dtype) + ">(&%, " +
+               idx.code_ + ", " + val.code_;
+    }
+    code += laneCntArg(params) + ")";
+    return makeEval(
+        "", makeIntrinsic(code, std::move(params), DataType::Void, true));
+}
+
+Stmt LowerVector::visit(const ReduceTo &op) {
+    if (var_.empty()) {
+        return BaseClass::visit(op);
+    }
+
+    std::string opName;
+    switch (op->op_) {
+    case ReduceOp::Add:
+        opName = "Add";
+        break;
+    case ReduceOp::Mul:
+        opName = "Mul";
+        break;
+    case ReduceOp::Min:
+        opName = "Min";
+        break;
+    case ReduceOp::Max:
+        opName = "Max";
+        break;
+    default:
+        throw InvalidCPUVector("Unsupported reduction");
+    }
+
+    auto dtype = buffer(op->var_)->tensor()->dtype();
+    std::vector<Expr> params;
+    if (varyingDim(op->indices_) == -1) {
+        // Reduce all lanes into one location
+        if (!isVarying(op->expr_)) {
+            throw InvalidCPUVector(
+                "Reducing a loop-invariant value into the same location");
+        }
+        auto val = vectorizeAs(op->expr_, dtype, params);
+        auto code =
+            "vecReduce" + opName + "<" + tmplArgs(dtype) + ">(" + val.code_;
+        code += laneCntArg(params) + ")";
+        return makeReduceTo(
+            op->id(), op->var_, op->indices_, op->op_,
+            makeIntrinsic(code, std::move(params), dtype, false), op->atomic_);
+    }
+
+    // Reduce each lane into its own location, which must be contiguous, or
+    // different lanes may conflict
+    auto base = contiguousBase(op->indices_.back());
+    if (!base.isValid()) {
+        throw InvalidCPUVector("Reducing into non-contiguous locations");
+    }
+    if (op->atomic_) {
+        throw InvalidCPUVector("Atomic reduction into vectors");
+    }
+    auto addr = baseAddr(op->var_, op->indices_, base);
+    params.emplace_back(addr);
+    auto code = "vecStore" + suffix() + "<" + tmplArgs(dtype) + ">(&%, ";
+    params.emplace_back(addr);
+    auto old = "vecLoad" + suffix() + "<" + tmplArgs(dtype) + ">(&%";
+    old += laneCntArg(params) + ")";
+    auto val = vectorizeAs(op->expr_, dtype, params);
+    switch (op->op_) {
+    case ReduceOp::Add:
+        code += "(" + old + " + " + val.code_ + ")";
+        break;
+    case ReduceOp::Mul:
+        code += "(" + old + " * " + val.code_ + ")";
+        break;
+    case ReduceOp::Min:
+        code += "vecMin(" + old + ", " + val.code_ + ")";
+        break;
+    case ReduceOp::Max:
+        code += "vecMax(" + old + ", " + val.code_ + ")";
+        break;
+    default:
+        ASSERT(false);
+    }
+    code += laneCntArg(params) + ")";
+    return makeEval(
+        "", makeIntrinsic(code, std::move(params), DataType::Void, true));
+}
+
+Stmt lowerVector(const Stmt &_op, const Ref<CPU> &target) {
+    auto op = LowerVector(target->vectorBytes())(_op);
+    return simplify(op);
+}
+
+} // namespace cpu
+
+} // namespace freetensor
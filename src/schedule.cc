@@ -13,6 +13,7 @@
 #include <pass/hoist_var_over_stmt_seq.h>
 #include <pass/simplify.h>
 #include <schedule.h>
+#include <schedule/as_blocked_matmul.h>
 #include <schedule/as_matmul.h>
 #include <schedule/blend.h>
 #include <schedule/cache.h>
@@ -27,6 +28,7 @@
 #include <schedule/separate_tail.h>
 #include <schedule/set_mem_type.h>
 #include <schedule/split.h>
+#include <schedule/streaming_store.h>
 #include <schedule/swap.h>
 #include <schedule/unroll.h>
 #include <schedule/var_merge.h>
@@ -440,6 +442,16 @@ void Schedule::vectorize(const ID &loop) {
     }
 }
 
+void Schedule::streamingStore(const ID &loop, const std::string &var) {
+    auto log = "streaming_store(" + toString(loop) + ", " + var + ")";
+    try {
+        ast_ = freetensor::streamingStore(ast_, loop, var);
+        appendLog(log);
+    } catch (const InvalidSchedule &e) {
+        throw InvalidSchedule("Invalid " + log + ": " + e.what(), ast_);
+    }
+}
+
 void Schedule::separateTail(bool noDuplicateVarDefs) {
     ast_ = freetensor::separateTail(ast_, noDuplicateVarDefs);
 }
@@ -454,6 +466,19 @@ void Schedule::asMatMul(const ID &loop) {
     }
 }
 
+void Schedule::asBlockedMatMul(const ID &loop, const Ref<Target> &target) {
+    auto log = "as_blocked_matmul(" + toString(loop) + ")";
+    try {
+        if (target->type() != TargetType::CPU) {
+            throw InvalidSchedule("Only CPU targets are supported");
+        }
+        ast_ = freetensor::asBlockedMatMul(ast_, loop, target.as<CPU>());
+        appendLog(log);
+    } catch (const InvalidSchedule &e) {
+        throw InvalidSchedule("Invalid " + log + ": " + e.what(), ast_);
+    }
+}
+
 void Schedule::autoSchedule(const Target &target) {
     autoUseLib(target);
     autoFuse(target);
@@ -816,6 +841,70 @@ void Schedule::autoUnroll(const Target &target) {
     visitNest(getLoopNestTree(ast_));
 }
 
+void Schedule::autoStreamingStore(const Target &target) {
+    if (target.type() != TargetType::CPU) {
+        return;
+    }
+
+    // Only large outputs are worth bypassing the cache. 4M elements is beyond
+    // the last level cache share of a core on most CPUs
+    constexpr int64_t minArea = 4 << 20;
+
+    // Number of stores to `var` in `loop`, or -1 if unknown
+    auto storeCnt = [](const For &loop, const std::string &var) -> int64_t {
+        int64_t cnt = 0;
+        for (auto &&store : findStmt(loop, [&](const Stmt &s) {
+                 return s->nodeType() == ASTNodeType::Store &&
+                        s.as<StoreNode>()->var_ == var;
+             })) {
+            int64_t repeat = 1;
+            for (Stmt s = store->parentStmt();; s = s->parentStmt()) {
+                if (s->nodeType() == ASTNodeType::If) {
+                    return -1; // Maybe not all stored
+                }
+                if (s->nodeType() == ASTNodeType::For) {
+                    auto &&len = s.as<ForNode>()->len_;
+                    if (len->nodeType() != ASTNodeType::IntConst) {
+                        return -1;
+                    }
+                    repeat *= len.as<IntConstNode>()->val_;
+                }
+                if (s->id() == loop->id()) {
+                    break;
+                }
+            }
+            cnt += repeat;
+        }
+        return cnt;
+    };
+
+    for (auto &&[defId, name] : allDefs(ast_, {AccessType::Output})) {
+        auto &&shape =
+            findStmt(ast_, defId).as<VarDefNode>()->buffer_->tensor()->shape();
+        int64_t area = 1;
+        for (auto &&dim : shape) {
+            area = dim->nodeType() == ASTNodeType::IntConst && area != -1
+                       ? area * dim.as<IntConstNode>()->val_
+                       : -1;
+        }
+        if (area < minArea) {
+            continue;
+        }
+        for (auto &&subNest : getLoopNestTree(ast_)->subLoops_) {
+            // If a loop stores as many times as the elements of the output,
+            // and `streamingStore` finds no element stored twice, each
+            // element is written exactly once
+            if (storeCnt(subNest->loop_, name) == area) {
+                try {
+                    streamingStore(subNest->loop_->id(), name);
+                } catch (const InvalidSchedule &e) {
+                    // do nothing
+                }
+            }
+        }
+    }
+}
+
 std::vector<std::pair<ID, int>>
 Schedule::multiLevelTiling(const ForsWithDataReuse &target,
                            const MultiLevelTilingAnnotation &annotation,
@@ -0,0 +1,321 @@
+#include <algorithm>
+
+#include <../runtime/cpu_gemm_blocking.h>
+#include <analyze/all_uses.h>
+#include <pass/replace_iter.h>
+#include <pass/simplify.h>
+#include <schedule/as_blocked_matmul.h>
+
+namespace freetensor {
+
+static bool isConst0(const Expr &op) {
+    return (op->nodeType() == ASTNodeType::IntConst &&
+            op.as<IntConstNode>()->val_ == 0) ||
+           (op->nodeType() == ASTNodeType::FloatConst &&
+            op.as<FloatConstNode>()->val_ == 0);
+}
+
+static std::unordered_set<std::string>
+itersInIndices(const std::vector<Expr> &indices) {
+    std::unordered_set<std::string> ret;
+    for (auto &&idx : indices) {
+        for (auto &&name : allIters(idx)) {
+            ret.insert(name);
+        }
+    }
+    return ret;
+}
+
+static Expr roundUp(const Expr &len, int factor) {
+    if (len->nodeType() == ASTNodeType::IntConst) {
+        auto val = len.as<IntConstNode>()->val_;
+        return makeIntConst((val + factor - 1) / factor * factor);
+    }
+    return nullptr;
+}
+
+GEMMBlocking gemmBlocking(const Ref<CPU> &target, DataType dtype) {
+    auto sizes = gemmBlockSizes(target->vectorBytes(), sizeOf(dtype));
+    return {sizes.mr, sizes.nr, sizes.kc, sizes.mc, sizes.nc};
+}
+
+void AsBlockedMatMul::collect(const Stmt &op) {
+    switch (op->nodeType()) {
+    case ASTNodeType::For: {
+        auto loop = op.as<ForNode>();
+        nests_.emplace_back(loop);
+        scope_.emplace_back(loop->iter_);
+        collect(loop->body_);
+        scope_.pop_back();
+        break;
+    }
+    case ASTNodeType::StmtSeq: {
+        auto &&stmts = op.as<StmtSeqNode>()->stmts_;
+        if (std::count_if(stmts.begin(), stmts.end(), [](const Stmt &s) {
+                return s->nodeType() == ASTNodeType::For;
+            }) > 1) {
+            throw InvalidSchedule("Imperfectly nested loops are not supported");
+        }
+        for (auto &&stmt : stmts) {
+            collect(stmt);
+        }
+        break;
+    }
+    case ASTNodeType::Store:
+        if (init_.isValid() || leaf_.isValid()) {
+            throw InvalidSchedule("Unexpected Store node " +
+                                  toString(op->id()));
+        }
+        init_ = op.as<StoreNode>();
+        initScope_ = scope_;
+        break;
+    case ASTNodeType::ReduceTo:
+        if (leaf_.isValid()) {
+            throw InvalidSchedule("Unexpected multiple ReduceTo node");
+        }
+        leaf_ = op.as<ReduceToNode>();
+        break;
+    default:
+        throw InvalidSchedule("Unexpected " + toString(op->nodeType()) +
+                              " node");
+    }
+}
+
+Stmt AsBlockedMatMul::transform() {
+    if (!leaf_.isValid()) {
+        throw InvalidSchedule("`c += a * b` statement not found");
+    }
+    if (leaf_->op_ != ReduceOp::Add) {
+        throw InvalidSchedule("`+=` not found");
+    }
+    if (leaf_->expr_->nodeType() != ASTNodeType::Mul) {
+        throw InvalidSchedule("Multiplication not found");
+    }
+    auto mul = leaf_->expr_.as<MulNode>();
+    if (mul->lhs_->nodeType() != ASTNodeType::Load ||
+        mul->rhs_->nodeType() != ASTNodeType::Load) {
+        throw InvalidSchedule("Matrix a or b not found");
+    }
+    auto loadA = mul->lhs_.as<LoadNode>(), loadB = mul->rhs_.as<LoadNode>();
+    if (loadA->var_ == leaf_->var_ || loadB->var_ == leaf_->var_) {
+        throw InvalidSchedule("Matrix " + leaf_->var_ +
+                              " should not be read as a or b");
+    }
+
+    // Classify the loops by which matrices they index, the same as `asMatMul`
+    auto itersA = itersInIndices(loadA->indices_);
+    auto itersB = itersInIndices(loadB->indices_);
+    auto itersC = itersInIndices(leaf_->indices_);
+    For mLoop, nLoop, kLoop;
+    std::vector<For> batchLoops;
+    auto setAxis = [](For &axis, const For &loop, const std::string &name) {
+        if (axis.isValid()) {
+            throw InvalidSchedule("More than one loop in the " + name +
+                                  " axis is not supported");
+        }
+        axis = loop;
+    };
+    for (auto &&loop : nests_) {
+        bool inA = itersA.count(loop->iter_);
+        bool inB = itersB.count(loop->iter_);
+        bool inC = itersC.count(loop->iter_);
+        if (inA && inB && inC) {
+            batchLoops.emplace_back(loop);
+        } else if (inA && !inB && inC) {
+            setAxis(mLoop, loop, "m");
+        } else if (!inA && inB && inC) {
+            setAxis(nLoop, loop, "n");
+        } else if (inA && inB && !inC) {
+            setAxis(kLoop, loop, "k");
+        } else {
+            throw InvalidSchedule("Loop " + toString(loop->id()) +
+                                  " is not in the batch, m, n or k axis");
+        }
+    }
+    if (!mLoop.isValid() || !nLoop.isValid() || !kLoop.isValid()) {
+        throw InvalidSchedule("Each of the m, n and k axes should have a loop");
+    }
+
+    if (init_.isValid()) {
+        bool sameIndices = init_->var_ == leaf_->var_ &&
+                           init_->indices_.size() == leaf_->indices_.size();
+        for (size_t i = 0; sameIndices && i < init_->indices_.size(); i++) {
+            sameIndices =
+                HashComparator()(init_->indices_[i], leaf_->indices_[i]);
+        }
+        if (!sameIndices) {
+            throw InvalidSchedule("The initialized matrix " + init_->var_ +
+                                  " does not match " + leaf_->var_ +
+                                  ", the matrix being reduced to");
+        }
+        if (!isConst0(init_->expr_)) {
+            throw InvalidSchedule("Matrix c can either be not initialized or "
+                                  "initialized to zeros");
+        }
+        if (std::find(initScope_.begin(), initScope_.end(), kLoop->iter_) !=
+            initScope_.end()) {
+            throw InvalidSchedule("Matrix c should not be initialized inside "
+                                  "the k loop");
+        }
+    }
+
+    auto dtypeA = buffer(loadA->var_)->tensor()->dtype();
+    auto dtypeB = buffer(loadB->var_)->tensor()->dtype();
+    auto dtypeC = buffer(leaf_->var_)->tensor()->dtype();
+    auto blk = gemmBlocking(target_, dtypeC);
+    int MR = blk.mr_, NR = blk.nr_;
+    Expr M = mLoop->len_, N = nLoop->len_, K = kLoop->len_;
+
+    // Do not allocate more than needed for small matrices
+    Expr MC = makeIntConst(blk.mc_), NC = makeIntConst(blk.nc_);
+    Expr KC = makeIntConst(blk.kc_);
+    if (auto m = roundUp(M, MR); m.isValid()) {
+        MC = makeMin(MC, m);
+    }
+    if (auto n = roundUp(N, NR); n.isValid()) {
+        NC = makeMin(NC, n);
+    }
+    if (K->nodeType() == ASTNodeType::IntConst) {
+        KC = makeMin(KC, K);
+    }
+
+    auto base = loop_.strId();
+    auto mIter = mLoop->iter_, nIter = nLoop->iter_, kIter = kLoop->iter_;
+    auto jc = makeVar(nIter + ".c"), jr = makeVar(nIter + ".r"),
+         j = makeVar(nIter + ".v");
+    auto ic = makeVar(mIter + ".c"), ir = makeVar(mIter + ".r"),
+         i = makeVar(mIter + ".v");
+    auto pc = makeVar(kIter + ".c"), p = makeVar(kIter + ".r");
+    auto iMR = makeIntConst(MR), iNR = makeIntConst(NR);
+
+    auto ncLen = makeMin(NC, makeSub(N, makeMul(jc, NC)));
+    auto kcLen = makeMin(KC, makeSub(K, makeMul(pc, KC)));
+    auto mcLen = makeMin(MC, makeSub(M, makeMul(ic, MC)));
+    auto nrLen = makeMin(iNR, makeSub(ncLen, makeMul(jr, iNR)));
+    auto mrLen = makeMin(iMR, makeSub(mcLen, makeMul(ir, iMR)));
+    auto nrCnt = makeCeilDiv(ncLen, iNR), mrCnt = makeCeilDiv(mcLen, iMR);
+
+    auto iterOf = [](const For &loop, const Expr &idx) {
+        return makeAdd(loop->begin_, makeMul(idx, loop->step_));
+    };
+    auto mIdx = iterOf(mLoop, makeAdd(makeMul(ic, MC),
+                                      makeAdd(makeMul(ir, iMR), i)));
+    auto nIdx = iterOf(nLoop, makeAdd(makeMul(jc, NC),
+                                      makeAdd(makeMul(jr, iNR), j)));
+    auto kIdx = iterOf(kLoop, makeAdd(makeMul(pc, KC), p));
+    typedef std::unordered_map<std::string, Expr> IterMap;
+    auto newA = ReplaceIter(IterMap{{mIter, mIdx}, {kIter, kIdx}})(loadA);
+    auto newB = ReplaceIter(IterMap{{kIter, kIdx}, {nIter, nIdx}})(loadB);
+    std::vector<Expr> newCIndices;
+    ReplaceIter replaceC(IterMap{{mIter, mIdx}, {nIter, nIdx}});
+    for (auto &&idx : leaf_->indices_) {
+        newCIndices.emplace_back(replaceC(idx));
+    }
+
+    auto packA = loadA->var_ + ".pack.a", packB = loadB->var_ + ".pack.b";
+    auto acc = leaf_->var_ + ".r";
+    auto makeLoop = [](const ID &id, const Expr &iter, const Expr &len,
+                       const Stmt &body, bool unroll = false,
+                       bool vectorize = false) -> Stmt {
+        auto property = Ref<ForProperty>::make();
+        property->unroll_ = unroll;
+        property->vectorize_ = vectorize;
+        return makeFor(id, iter.as<VarNode>()->name_, makeIntConst(0), len,
+                       makeIntConst(1), len, std::move(property), body);
+    };
+    auto localDef = [](const std::string &name, std::vector<Expr> shape,
+                       DataType dtype, const Stmt &body) {
+        return makeVarDef("", name,
+                          makeBuffer(makeTensor(std::move(shape), dtype),
+                                     AccessType::Cache, MemType::CPU),
+                          nullptr, body, false);
+    };
+
+    // Micro-kernel: accumulate an MR x NR tile of C in registers
+    auto zeroAcc = makeLoop(
+        "", i, iMR,
+        makeLoop("", j, iNR, makeStore("", acc, {i, j}, makeIntConst(0)),
+                 false, true),
+        true);
+    auto fma = makeReduceTo("", acc, {i, j}, ReduceOp::Add,
+                            makeMul(makeLoad(packA, {ir, p, i}),
+                                    makeLoad(packB, {jr, p, j})),
+                            false);
+    auto accumulate = makeLoop(
+        base + ".kr", p, kcLen,
+        makeLoop("", i, iMR, makeLoop("", j, iNR, fma, false, true), true));
+    auto storeC = makeLoop(
+        base + ".store", i, mrLen,
+        makeLoop("", j, nrLen,
+                 makeReduceTo("", leaf_->var_, newCIndices, ReduceOp::Add,
+                              makeLoad(acc, {i, j}), false),
+                 false, true));
+    Stmt kernel = localDef(acc, {iMR, iNR}, dtypeC,
+                           makeStmtSeq("", {zeroAcc, accumulate, storeC}));
+    kernel = makeLoop(base + ".ir", ir, mrCnt, kernel);
+    kernel = makeLoop(base + ".jr", jr, nrCnt, kernel);
+
+    // Pack an MC x KC block of A into panels of MR rows, padded with 0
+    auto fillA = makeIf("", makeLT(makeAdd(makeMul(ir, iMR), i), mcLen),
+                        makeStore("", packA, {ir, p, i}, newA),
+                        makeStore("", packA, {ir, p, i}, makeIntConst(0)));
+    fillA = makeLoop(base + ".pack_a", ir, mrCnt,
+                     makeLoop("", p, kcLen, makeLoop("", i, iMR, fillA)));
+    Stmt blockA = localDef(packA, {makeCeilDiv(MC, iMR), KC, iMR}, dtypeA,
+                           makeStmtSeq("", {fillA, kernel}));
+    blockA = makeLoop(base + ".ic", ic, makeCeilDiv(M, MC), blockA);
+
+    // Pack a KC x NC block of B into panels of NR columns, padded with 0
+    auto fillB = makeIf("", makeLT(makeAdd(makeMul(jr, iNR), j), ncLen),
+                        makeStore("", packB, {jr, p, j}, newB),
+                        makeStore("", packB, {jr, p, j}, makeIntConst(0)));
+    fillB = makeLoop(base + ".pack_b", jr, nrCnt,
+                     makeLoop("", p, kcLen, makeLoop("", j, iNR, fillB)));
+    Stmt blockB = localDef(packB, {makeCeilDiv(NC, iNR), KC, iNR}, dtypeB,
+                           makeStmtSeq("", {fillB, blockA}));
+    blockB = makeLoop(base + ".pc", pc, makeCeilDiv(K, KC), blockB);
+
+    Stmt ret = makeLoop(base + ".jc", jc, makeCeilDiv(N, NC), blockB);
+
+    if (init_.isValid()) {
+        auto initLoops = makeFor(
+            base + ".init", mIter, mLoop->begin_, mLoop->end_, mLoop->step_,
+            mLoop->len_, Ref<ForProperty>::make(),
+            makeFor("", nIter, nLoop->begin_, nLoop->end_, nLoop->step_,
+                    nLoop->len_, Ref<ForProperty>::make(),
+                    makeStore("", init_->var_, init_->indices_,
+                              init_->expr_)));
+        ret = makeStmtSeq("", {initLoops, ret});
+    }
+
+    // Every batch loop indexes all the matrices, so they can be hoisted out
+    for (auto it = batchLoops.rbegin(); it != batchLoops.rend(); it++) {
+        auto &&l = *it;
+        ret = makeFor(l->id(), l->iter_, l->begin_, l->end_, l->step_, l->len_,
+                      l->property_, ret);
+    }
+    return ret;
+}
+
+Stmt AsBlockedMatMul::visit(const For &op) {
+    if (op->id() == loop_) {
+        collect(op);
+        done_ = true;
+        return transform();
+    }
+    return BaseClass::visit(op);
+}
+
+Stmt asBlockedMatMul(const Stmt &_ast, const ID &loop,
+                     const Ref<CPU> &target) {
+    auto ast = simplify(_ast); // const prop
+    AsBlockedMatMul mutator(loop, target);
+    ast = mutator(ast);
+    if (!mutator.done()) {
+        throw InvalidSchedule("Loop " + toString(loop) + " not found");
+    }
+    ast = simplify(ast);
+    return ast;
+}
+
+} // namespace freetensor
@@ -0,0 +1,74 @@
+#include <algorithm>
+
+#include <analyze/all_uses.h>
+#include <analyze/deps.h>
+#include <analyze/find_stmt.h>
+#include <schedule/streaming_store.h>
+
+namespace freetensor {
+
+Stmt StreamingStore::visit(const For &_op) {
+    if (_op->id() == loop_) {
+        if (!hasDef(var_)) {
+            throw InvalidSchedule(var_ + " is not defined outside loop " +
+                                  toString(loop_));
+        }
+        if (buffer(var_)->mtype() != MemType::CPU) {
+            throw InvalidSchedule(
+                "Only variables in the main memory of CPU (MemType::CPU) can "
+                "be written with streaming stores, but " +
+                var_ + " is in " + toString(buffer(var_)->mtype()));
+        }
+        def_ = def(var_)->id();
+        outerLoops_ = loopStack_;
+    }
+    loopStack_.emplace_back(_op->id());
+    auto __op = BaseClass::visit(_op);
+    loopStack_.pop_back();
+    ASSERT(__op->nodeType() == ASTNodeType::For);
+    auto op = __op.as<ForNode>();
+    if (op->id() == loop_) {
+        auto &&vars = op->property_->streamingStores_;
+        if (std::find(vars.begin(), vars.end(), var_) == vars.end()) {
+            vars.emplace_back(var_);
+        }
+        done_ = true;
+    }
+    return op;
+}
+
+Stmt streamingStore(const Stmt &_ast, const ID &loop, const std::string &var) {
+    StreamingStore mutator(loop, var);
+    auto ast = mutator(_ast);
+    if (!mutator.done()) {
+        throw InvalidSchedule("Loop " + toString(loop) + " not found");
+    }
+
+    // A non-temporal store evicts the line from the cache, so it only pays off
+    // if the data is not read again by the program
+    auto def = findStmt(ast, mutator.def()).as<VarDefNode>();
+    if (allUses(def->body_, AllUses::CHECK_LOAD | AllUses::CHECK_REDUCE)
+            .count(var)) {
+        throw InvalidSchedule(var + " is read in the program");
+    }
+
+    // Each element should be written only once in the loop, or we lose the
+    // chance to combine the stores in the cache
+    FindDepsCond findDepsCond;
+    for (auto &&outerLoop : mutator.outerLoops()) {
+        findDepsCond.push_back({outerLoop, DepDirection::Same});
+    }
+    auto filter = [&](const AccessPoint &later, const AccessPoint &earlier) {
+        return later.def_->id() == def->id() &&
+               earlier.stmt_->ancestorById(loop).isValid() &&
+               later.stmt_->ancestorById(loop).isValid();
+    };
+    auto found = [&](const Dependency &d) {
+        throw InvalidSchedule(var + " is overwritten in loop " +
+                              toString(loop) + ": " + toString(d));
+    };
+    findDeps(ast, {findDepsCond}, found, FindDepsMode::Dep, DEP_WAW, filter);
+    return ast;
+}
+
+} // namespace freetensor
@@ -574,6 +574,16 @@ void PrintVisitor::visit(const For &op) {
         makeIndent();
         os() << "@!prefer_libs" << std::endl;
     }
+    if (!op->property_->streamingStores_.empty()) {
+        makeIndent();
+        os() << "@!streaming_stores : ";
+        for (auto &&[i, var] :
+             iter::enumerate(op->property_->streamingStores_)) {
+            os() << (i == 0 ? "" : ", ");
+            os() << prettyVarDefName(var);
+        }
+        os() << std::endl;
+    }
     makeIndent();
     os() << prettyKeyword("for ") << prettyIterName(op->iter_)
          << prettyKeyword(" in ");
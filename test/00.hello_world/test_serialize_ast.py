@@ -149,6 +149,42 @@ def test_for_with_parallel():
     assert s.find("foo").property.parallel == ft.ffi.ParallelScope("openmp")
 
 
+def test_for_with_openmp_schedule():
+    with ft.VarDef([("x", (4,), "int32", "input", "cpu"),
+                    ("y", (4,), "int32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="foo") as i:
+            y[i] = x[i] + 1
+    s = ft.Schedule(ft.pop_ast())
+    s.parallelize("foo", "openmp:dynamic:16")
+    ast = s.ast()
+    txt = ft.dump_ast(ast)
+    print(txt)
+    ast2 = ft.load_ast(txt)
+    print(ast2)
+    assert ast2.match(ast)
+    s = ft.Schedule(ast2)
+    assert s.find("foo").property.parallel == ft.ffi.ParallelScope(
+        "openmp:dynamic:16")
+    assert s.find("foo").property.parallel != ft.ffi.ParallelScope("openmp")
+
+
+def test_for_with_streaming_stores():
+    with ft.VarDef([("x", (4,), "int32", "input", "cpu"),
+                    ("y", (4,), "int32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="foo") as i:
+            y[i] = x[i] + 1
+    s = ft.Schedule(ft.pop_ast())
+    s.streaming_store("foo", "y")
+    ast = s.ast()
+    txt = ft.dump_ast(ast)
+    print(txt)
+    ast2 = ft.load_ast(txt)
+    print(ast2)
+    assert ast2.match(ast)
+    s = ft.Schedule(ast2)
+    assert s.find("foo").property.streaming_stores == ["y"]
+
+
 def test_for_with_parallel_reduction():
     with ft.VarDef([("x", (4, 64), "int32", "input", "cpu"),
                     ("y", (4,), "int32", "inout", "cpu")]) as (x, y):
@@ -0,0 +1,122 @@
+import freetensor as ft
+import pytest
+import numpy as np
+
+target = ft.CPU()
+device = ft.Device(target)
+
+
+def test_basic():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(50, 300), "float32", "input", "cpu"]
+        b: ft.Var[(300, 77), "float32", "input", "cpu"]
+        c: ft.Var[(50, 77), "float32", "inout", "cpu"]
+        #! nid: L1
+        for i in range(50):
+            for j in range(77):
+                for k in range(300):
+                    c[i, j] += a[i, k] * b[k, j]
+
+    s = ft.Schedule(test)
+    s.as_blocked_matmul("L1", target)
+    for suffix in ["jc", "pc", "ic", "jr", "ir", "kr", "store"]:
+        s.find("L1." + suffix)
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "cblas" not in str(code)
+    assert "gemmBatchStrided" not in str(code)
+
+    a_np = np.random.uniform(size=(50, 300)).astype("float32")
+    b_np = np.random.uniform(size=(300, 77)).astype("float32")
+    c_np = np.random.uniform(size=(50, 77)).astype("float32")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(c_np, device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(np.isclose(c_result, c_np + a_np @ b_np, rtol=1e-4))
+
+
+def test_init_and_trans():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(64, 48), "float64", "input", "cpu"]
+        b: ft.Var[(72, 64), "float64", "input", "cpu"]
+        c: ft.Var[(72, 48), "float64", "output", "cpu"]
+        #! nid: L1
+        for i in range(48):
+            for j in range(72):
+                c[j, i] = 0
+                for k in range(64):
+                    c[j, i] += a[k, i] * b[j, k]
+
+    s = ft.Schedule(test)
+    s.as_blocked_matmul("L1", target)
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+
+    a_np = np.random.uniform(size=(64, 48)).astype("float64")
+    b_np = np.random.uniform(size=(72, 64)).astype("float64")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(np.zeros((72, 48), dtype="float64"), device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(
+        np.isclose(c_result, (a_np.transpose() @ b_np.transpose()).transpose()))
+
+
+def test_batch():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(4, 48, 64), "float32", "input", "cpu"]
+        b: ft.Var[(4, 64, 72), "float32", "input", "cpu"]
+        c: ft.Var[(4, 48, 72), "float32", "inout", "cpu"]
+        #! nid: L1
+        for n in range(4):
+            for i in range(48):
+                for j in range(72):
+                    for k in range(64):
+                        c[n, i, j] += a[n, i, k] * b[n, k, j]
+
+    s = ft.Schedule(test)
+    s.as_blocked_matmul("L1", target)
+    s.parallelize("L1", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+
+    a_np = np.random.uniform(size=(4, 48, 64)).astype("float32")
+    b_np = np.random.uniform(size=(4, 64, 72)).astype("float32")
+    c_np = np.random.uniform(size=(4, 48, 72)).astype("float32")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(c_np, device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(np.isclose(c_result, c_np + a_np @ b_np))
+
+
+def test_multiple_loops_in_an_axis():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(48, 16, 4), "float32", "input", "cpu"]
+        b: ft.Var[(16, 4, 72), "float32", "input", "cpu"]
+        c: ft.Var[(48, 72), "float32", "inout", "cpu"]
+        #! nid: L1
+        for i in range(48):
+            for j in range(72):
+                for k0 in range(16):
+                    for k1 in range(4):
+                        c[i, j] += a[i, k0, k1] * b[k0, k1, j]
+
+    s = ft.Schedule(test)
+    with pytest.raises(ft.InvalidSchedule):
+        s.as_blocked_matmul("L1", target)
@@ -0,0 +1,159 @@
+import freetensor as ft
+import pytest
+
+target = ft.CPU()
+device = ft.Device(target)
+
+# For normal test cases, please refer to test/codegen
+
+
+def test_basic():
+    with ft.VarDef([("x", (4, 8), "int32", "input", "cpu"),
+                    ("y", (4, 8), "int32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            with ft.For("j", 0, 8, nid="L2") as j:
+                y[i, j] = x[i, j] + 1
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    s.streaming_store("L1", "y")
+    ast = s.ast()
+    print(ast)
+    assert s.find("L1").property.streaming_stores == ["y"]
+    assert s.find("L2").property.streaming_stores == []
+
+
+def test_not_found():
+    with ft.VarDef([("x", (4,), "int32", "input", "cpu"),
+                    ("y", (4,), "int32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            y[i] = x[i] + 1
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    with pytest.raises(ft.InvalidSchedule):
+        s.streaming_store("L0", "y")
+    with pytest.raises(ft.InvalidSchedule):
+        s.streaming_store("L1", "z")
+    assert s.ast().match(ast)
+
+
+def test_not_on_cpu():
+    with ft.VarDef([("x", (4,), "int32", "input", "gpu/global"),
+                    ("y", (4,), "int32", "output", "gpu/global")]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            y[i] = x[i] + 1
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    with pytest.raises(ft.InvalidSchedule):
+        s.streaming_store("L1", "y")
+    assert s.ast().match(ast)
+
+
+def test_read_in_program():
+    with ft.VarDef([("x", (4,), "int32", "input", "cpu"),
+                    ("y", (4,), "int32", "output", "cpu"),
+                    ("z", (4,), "int32", "output", "cpu")]) as (x, y, z):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            y[i] = x[i] + 1
+        with ft.For("i", 0, 4, nid="L2") as i:
+            z[i] = y[i] * 2
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    with pytest.raises(ft.InvalidSchedule):
+        s.streaming_store("L1", "y")
+    assert s.ast().match(ast)
+
+
+def test_written_twice():
+    with ft.VarDef([("x", (4, 8), "int32", "input", "cpu"),
+                    ("y", (8,), "int32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            with ft.For("j", 0, 8, nid="L2") as j:
+                y[j] = x[i, j] + 1
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    with pytest.raises(ft.InvalidSchedule):
+        s.streaming_store("L1", "y")
+    assert s.ast().match(ast)
+
+    # Each element is written once in L2
+    s.streaming_store("L2", "y")
+    assert s.find("L2").property.streaming_stores == ["y"]
+
+
+def test_auto_large_output():
+    with ft.VarDef([("x", (4096, 4096), "float32", "input", "cpu"),
+                    ("y", (4096, 4096), "float32", "output", "cpu")]) as (x,
+                                                                          y):
+        with ft.For("i", 0, 4096, nid="L1") as i:
+            with ft.For("j", 0, 4096, nid="L2") as j:
+                y[i, j] = x[i, j] * 2
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    s.auto_streaming_store(target)
+    print(s.ast())
+    assert s.find("L1").property.streaming_stores == ["y"]
+
+
+def test_auto_small_output():
+    with ft.VarDef([("x", (64, 64), "float32", "input", "cpu"),
+                    ("y", (64, 64), "float32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 64, nid="L1") as i:
+            with ft.For("j", 0, 64, nid="L2") as j:
+                y[i, j] = x[i, j] * 2
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    s.auto_streaming_store(target)
+    assert s.ast().match(ast)
+
+
+def test_auto_only_large_outputs():
+    with ft.VarDef([("x", (4096, 4096), "float32", "input", "cpu"),
+                    ("y", (4096, 4096), "float32", "output", "cpu"),
+                    ("z", (4096,), "float32", "output", "cpu")]) as (x, y, z):
+        with ft.For("i", 0, 4096, nid="L1") as i:
+            with ft.For("j", 0, 4096, nid="L2") as j:
+                y[i, j] = x[i, j] * 2
+            z[i] = x[i, 0]
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    s.auto_streaming_store(target)
+    assert s.find("L1").property.streaming_stores == ["y"]
+
+
+def test_auto_partly_written_output():
+    with ft.VarDef([("x", (4096, 4096), "float32", "input", "cpu"),
+                    ("y", (4096, 4096), "float32", "output", "cpu")]) as (x,
+                                                                          y):
+        with ft.For("i", 0, 4096, nid="L1") as i:
+            with ft.For("j", 0, 2048, nid="L2") as j:
+                y[i, j] = x[i, j] * 2
+        with ft.For("i", 0, 4096, nid="L3") as i:
+            with ft.For("j", 2048, 4096, nid="L4") as j:
+                y[i, j] = 0
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    s.auto_streaming_store(target)
+    assert s.ast().match(ast)
+
+
+def test_not_in_auto_schedule():
+    with ft.VarDef([("x", (4096, 4096), "float32", "input", "cpu"),
+                    ("y", (4096, 4096), "float32", "output", "cpu")]) as (x,
+                                                                          y):
+        with ft.For("i", 0, 4096, nid="L1") as i:
+            with ft.For("j", 0, 4096, nid="L2") as j:
+                y[i, j] = x[i, j] * 2
+    ast = ft.pop_ast(verbose=True)
+
+    s = ft.Schedule(ast)
+    s.auto_schedule(target)
+    assert "@!streaming_stores" not in str(s.ast())
@@ -0,0 +1,172 @@
+import freetensor as ft
+import pytest
+import numpy as np
+
+if ft.cpu_blas() == "mkl":
+    pytest.skip("MKL is tested in test_mkl.py", allow_module_level=True)
+
+target = ft.CPU()
+device = ft.Device(target)
+
+
+def test_blas_basic():
+
+    # Sizes not divisible by micro tiles
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(50, 300), "float32", "input", "cpu"]
+        b: ft.Var[(300, 77), "float32", "input", "cpu"]
+        c: ft.Var[(50, 77), "float32", "inout", "cpu"]
+        #! nid: L1
+        for i in range(50):
+            for j in range(77):
+                for k in range(300):
+                    c[i, j] += a[i, k] * b[k, j]
+
+    s = ft.Schedule(test)
+    s.as_matmul("L1")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "gemmBatchStrided<float>" in str(code)
+    a_np = np.random.uniform(size=(50, 300)).astype("float32")
+    b_np = np.random.uniform(size=(300, 77)).astype("float32")
+    c_np = np.random.uniform(size=(50, 77)).astype("float32")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(c_np, device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(np.isclose(c_result, c_np + a_np @ b_np, rtol=1e-4))
+
+
+def test_blas_trans_a_b():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(64, 48), "float64", "input", "cpu"]
+        b: ft.Var[(72, 64), "float64", "input", "cpu"]
+        c: ft.Var[(48, 72), "float64", "inout", "cpu"]
+        #! nid: L1
+        for i in range(48):
+            for j in range(72):
+                for k in range(64):
+                    c[i, j] += a[k, i] * b[j, k]
+
+    s = ft.Schedule(test)
+    s.as_matmul("L1")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "gemmBatchStrided<double>" in str(code)
+    a_np = np.random.uniform(size=(64, 48)).astype("float64")
+    b_np = np.random.uniform(size=(72, 64)).astype("float64")
+    c_np = np.random.uniform(size=(48, 72)).astype("float64")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(c_np, device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(
+        np.isclose(c_result, c_np + a_np.transpose() @ b_np.transpose()))
+
+
+def test_blas_trans_c():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(48, 64), "float32", "input", "cpu"]
+        b: ft.Var[(64, 72), "float32", "input", "cpu"]
+        c: ft.Var[(72, 48), "float32", "inout", "cpu"]
+        #! nid: L1
+        for i in range(48):
+            for j in range(72):
+                for k in range(64):
+                    c[j, i] += a[i, k] * b[k, j]
+
+    s = ft.Schedule(test)
+    s.as_matmul("L1")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "gemmBatchStrided<float>" in str(code)
+    a_np = np.random.uniform(size=(48, 64)).astype("float32")
+    b_np = np.random.uniform(size=(64, 72)).astype("float32")
+    c_np = np.random.uniform(size=(72, 48)).astype("float32")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(c_np, device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(np.isclose(c_result, c_np + (a_np @ b_np).transpose()))
+
+
+def test_blas_batch_in_parallel():
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(4, 48, 64), "float32", "input", "cpu"]
+        b: ft.Var[(4, 64, 72), "float32", "input", "cpu"]
+        c: ft.Var[(4, 48, 72), "float32", "inout", "cpu"]
+        #! nid: L0
+        for n in range(4):
+            #! nid: L1
+            for i in range(48):
+                for j in range(72):
+                    for k in range(64):
+                        c[n, i, j] += a[n, i, k] * b[n, k, j]
+
+    s = ft.Schedule(test)
+    s.as_matmul("L1")
+    s.parallelize("L0", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "gemmBatchStrided<float>" in str(code)
+    a_np = np.random.uniform(size=(4, 48, 64)).astype("float32")
+    b_np = np.random.uniform(size=(4, 64, 72)).astype("float32")
+    c_np = np.random.uniform(size=(4, 48, 72)).astype("float32")
+    a_arr = ft.Array(a_np, device)
+    b_arr = ft.Array(b_np, device)
+    c_arr = ft.Array(c_np, device)
+    ft.Driver(func, code, device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(np.isclose(c_result, c_np + a_np @ b_np))
+
+
+def test_blas_batch_in_thread_pool():
+    pool_target = ft.CPU()
+    pool_target.set_parallel_runtime(ft.ParallelRuntime.ThreadPool)
+    pool_device = ft.Device(pool_target)
+
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(4, 48, 64), "float32", "input", "cpu"]
+        b: ft.Var[(4, 64, 72), "float32", "input", "cpu"]
+        c: ft.Var[(4, 48, 72), "float32", "inout", "cpu"]
+        #! nid: L0
+        for n in range(4):
+            #! nid: L1
+            for i in range(48):
+                for j in range(72):
+                    for k in range(64):
+                        c[n, i, j] += a[n, i, k] * b[n, k, j]
+
+    s = ft.Schedule(test)
+    s.as_matmul("L1")
+    s.parallelize("L0", "openmp")
+    func = ft.lower(s.func(), pool_target, verbose=1)
+    code = ft.codegen(func, pool_target, verbose=True)
+    assert "threadPool().parallelFor" in str(code)
+    # Each worker of the pool runs its GEMM on one thread
+    assert "_ctx, 1)" in str(code)
+    a_np = np.random.uniform(size=(4, 48, 64)).astype("float32")
+    b_np = np.random.uniform(size=(4, 64, 72)).astype("float32")
+    c_np = np.random.uniform(size=(4, 48, 72)).astype("float32")
+    a_arr = ft.Array(a_np, pool_device)
+    b_arr = ft.Array(b_np, pool_device)
+    c_arr = ft.Array(c_np, pool_device)
+    ft.Driver(func, code, pool_device)(a=a_arr, b=b_arr, c=c_arr)
+    c_result = c_arr.numpy()
+
+    assert np.all(np.isclose(c_result, c_np + a_np @ b_np))
@@ -95,6 +95,86 @@ def test_omp_for_collapse_nested():
     assert np.all(np.isclose(y_np, x_np + 1))
 
 
+def test_omp_for_dynamic_schedule():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(64, 64), "float32", "input", "cpu"]
+        y: ft.Var[(64,), "float32", "output", "cpu"]
+        #! nid: L1
+        for i in range(64):
+            y[i] = 0
+            for j in range(i + 1):  # Triangular
+                y[i] += x[i, j]
+
+    s = ft.Schedule(test)
+    s.parallelize("L1", "openmp:dynamic:4")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "schedule(dynamic, 4)" in str(code)
+    x_np = np.random.rand(64, 64).astype("float32")
+    y_np = np.zeros((64,), dtype="float32")
+    x_arr = ft.Array(x_np, ft.Device(target))
+    y_arr = ft.Array(y_np, ft.Device(target))
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.all(np.isclose(y_np, np.tril(x_np).sum(axis=1)))
+
+
+def test_omp_taskloop():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(64, 64), "float32", "input", "cpu"]
+        y: ft.Var[(64,), "float32", "output", "cpu"]
+        #! nid: L1
+        for i in range(64):
+            y[i] = 0
+            for j in range(i + 1):  # Triangular
+                y[i] += x[i, j]
+
+    s = ft.Schedule(test)
+    s.parallelize("L1", "openmp:taskloop:2")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "#pragma omp taskloop grainsize(2)" in str(code)
+    x_np = np.random.rand(64, 64).astype("float32")
+    y_np = np.zeros((64,), dtype="float32")
+    x_arr = ft.Array(x_np, ft.Device(target))
+    y_arr = ft.Array(y_np, ft.Device(target))
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.all(np.isclose(y_np, np.tril(x_np).sum(axis=1)))
+
+
+def test_omp_for_pin_threads():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(1000,), "int32", "input", "cpu"]
+        y: ft.Var[(1000,), "int32", "output", "cpu"]
+        #! nid: L1
+        for i in range(0, 1000):
+            y[i] = x[i] + 1
+
+    pinned = ft.CPU()
+    pinned.set_pin_threads()
+    s = ft.Schedule(test)
+    s.parallelize("L1", "openmp")
+    func = ft.lower(s.func(), pinned, verbose=1)
+    code = ft.codegen(func, pinned, verbose=True)
+    assert "proc_bind(spread)" in str(code)
+    x_np = np.random.randint(0, 100, (1000,)).astype("int32")
+    pinned_device = ft.Device(pinned)
+    x_arr = ft.Array(x_np, pinned_device)
+    y_arr = ft.Array(np.zeros((1000,), dtype="int32"), pinned_device)
+    ft.Driver(func, code, pinned_device)(x=x_arr, y=y_arr)
+
+    assert np.array_equal(y_arr.numpy(), x_np + 1)
+
+
 def test_parallelize_parametric_access_1():
 
     @ft.transform
@@ -191,7 +271,7 @@ def test_vectorize_for():
     s.vectorize("L1")
     func = ft.lower(s.func(), target, verbose=1)
     code = ft.codegen(func, target, verbose=True)
-    assert "#pragma omp simd" in str(code)
+    assert "vecStore" in str(code)
     x_np = np.array([1, 2, 3, 4], dtype="int32")
     y_np = np.zeros((4,), dtype="int32")
     x_arr = ft.Array(x_np, ft.Device(ft.CPU()))
@@ -201,3 +281,107 @@ def test_vectorize_for():
 
     y_std = np.array([2, 3, 4, 5], dtype="int32")
     assert np.array_equal(y_np, y_std)
+
+
+def test_workspace_reuse():
+    with ft.VarDef([("x", (1024,), "float32", "input", "cpu"),
+                    ("y", (1024,), "float32", "output", "cpu")]) as (x, y):
+        with ft.VarDef("t", (1024,), "float32", "cache", "cpu") as t:
+            with ft.VarDef("u", (1024,), "float32", "cache", "cpu") as u:
+                with ft.VarDef("v", (1024,), "float32", "cache", "cpu") as v:
+                    with ft.For("i", 0, 1024) as i:
+                        t[i] = x[i] * 2
+                    with ft.For("i", 0, 1024) as i:
+                        u[i] = t[i] + t[1023 - i]
+                    with ft.For("i", 0, 1024) as i:
+                        v[i] = u[i] * u[1023 - i]
+                    with ft.For("i", 0, 1024) as i:
+                        y[i] = v[i] + v[1023 - i]
+    func = ft.lower(ft.Func("main", ["x", "y"], [], ft.pop_ast()),
+                    target,
+                    verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    # t and v are not alive at the same time, so they share the space
+    assert "_ctx->reserveWorkspace(8192)" in code.code
+
+    x_np = np.random.rand(1024).astype("float32")
+    t_np = x_np * 2
+    u_np = t_np + t_np[::-1]
+    v_np = u_np * u_np[::-1]
+    y_std = v_np + v_np[::-1]
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((1024,), dtype="float32"), device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    assert np.allclose(y_arr.numpy(), y_std)
+
+
+def test_workspace_loop_carried():
+    with ft.VarDef([("x", (4, 1024), "float32", "input", "cpu"),
+                    ("y", (4, 1024), "float32", "output", "cpu")]) as (x, y):
+        with ft.VarDef("acc", (1024,), "float32", "cache", "cpu") as acc:
+            with ft.For("i", 0, 1024) as i:
+                acc[i] = 0
+            with ft.For("k", 0, 4) as k:
+                with ft.VarDef("t", (1024,), "float32", "cache", "cpu") as t:
+                    with ft.For("i", 0, 1024) as i:
+                        t[i] = x[k, i] + x[k, 1023 - i]
+                    with ft.For("i", 0, 1024) as i:
+                        acc[i] += t[i] * t[1023 - i]
+                        y[k, i] = acc[i]
+    func = ft.lower(ft.Func("main", ["x", "y"], [], ft.pop_ast()),
+                    target,
+                    verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    # acc is alive in the whole k loop, so t must not overlap with it
+    assert "_ctx->reserveWorkspace(8192)" in code.code
+
+    x_np = np.random.rand(4, 1024).astype("float32")
+    t_np = x_np + x_np[:, ::-1]
+    y_std = np.cumsum(t_np * t_np[:, ::-1], axis=0)
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((4, 1024), dtype="float32"), device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    assert np.allclose(y_arr.numpy(), y_std)
+
+
+def test_streaming_store():
+    with ft.VarDef([("x", (4, 64), "float32", "input", "cpu"),
+                    ("y", (4, 64), "float32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            with ft.For("j", 0, 64, nid="L2") as j:
+                y[i, j] = x[i, j] * 2 + 1
+    s = ft.Schedule(ft.Func("main", ["x", "y"], [], ft.pop_ast()))
+    s.streaming_store("L1", "y")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "streamStore<float>(&y[i][j]" in code.code
+    assert code.code.count("streamFence()") == 1
+
+    x_np = np.random.rand(4, 64).astype("float32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((4, 64), dtype="float32"), device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    assert np.allclose(y_arr.numpy(), x_np * 2 + 1)
+
+
+def test_streaming_store_in_collapsed_loops():
+    with ft.VarDef([("x", (4, 64), "float32", "input", "cpu"),
+                    ("y", (4, 64), "float32", "output", "cpu")]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            with ft.For("j", 0, 64, nid="L2") as j:
+                y[i, j] = x[i, j] * 2 + 1
+    s = ft.Schedule(ft.Func("main", ["x", "y"], [], ft.pop_ast()))
+    s.parallelize("L1", "openmp")
+    s.parallelize("L2", "openmp")
+    s.streaming_store("L2", "y")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    # The fence is after the outer loop, to keep the loops perfectly nested
+    assert "collapse(2)" in code.code
+    assert code.code.count("streamFence()") == 1
+
+    x_np = np.random.rand(4, 64).astype("float32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((4, 64), dtype="float32"), device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    assert np.allclose(y_arr.numpy(), x_np * 2 + 1)
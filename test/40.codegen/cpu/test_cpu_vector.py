@@ -0,0 +1,182 @@
+import freetensor as ft
+import pytest
+import numpy as np
+
+target = ft.CPU()
+target.set_vector_bytes(32)
+device = ft.Device(target)
+
+
+def test_vectorize():
+    with ft.VarDef([
+        ("x", (4, 64), "float32", "input", "cpu"),
+        ("y", (4, 64), "float32", "output", "cpu"),
+    ]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            with ft.For("j", 0, 64, nid="L2") as j:
+                y[i, j] = x[i, j] * 2 + 1
+    func = ft.Func("main", ["x", "y"], [], ft.pop_ast())
+
+    s = ft.Schedule(func)
+    s.vectorize("L2")
+    func = ft.lower(s.func(), target, verbose=1)
+
+    code = ft.codegen(func, target, verbose=True)
+    assert "vecStore<float, 8>" in str(code)
+    assert "#pragma omp simd" not in str(code)
+
+    x_np = np.random.rand(4, 64).astype("float32")
+    y_np = np.zeros((4, 64), dtype="float32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(y_np, device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.allclose(y_np, x_np * 2 + 1)
+
+
+@pytest.mark.parametrize("n", [3, 8, 21])
+def test_masked_tail(n):
+    with ft.VarDef([
+        ("x", (n,), "int32", "input", "cpu"),
+        ("y", (n,), "int32", "output", "cpu"),
+    ]) as (x, y):
+        with ft.For("i", 0, n, nid="L1") as i:
+            y[i] = x[i] + i
+    func = ft.Func("main", ["x", "y"], [], ft.pop_ast())
+
+    s = ft.Schedule(func)
+    s.vectorize("L1")
+    func = ft.lower(s.func(), target, verbose=1)
+
+    code = ft.codegen(func, target, verbose=True)
+    if n % 8 != 0:
+        assert "vecStoreN" in str(code)
+
+    x_np = np.random.randint(0, 100, (n,)).astype("int32")
+    y_np = np.zeros((n,), dtype="int32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(y_np, device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.array_equal(y_np, x_np + np.arange(n, dtype="int32"))
+
+
+def test_horizontal_reduction():
+    with ft.VarDef([
+        ("x", (4, 61), "float64", "input", "cpu"),
+        ("y", (4,), "float64", "output", "cpu"),
+    ]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            y[i] = 0
+            with ft.For("j", 0, 61, nid="L2") as j:
+                y[i] += x[i, j] * x[i, j]
+    func = ft.Func("main", ["x", "y"], [], ft.pop_ast())
+
+    s = ft.Schedule(func)
+    s.vectorize("L2")
+    func = ft.lower(s.func(), target, verbose=1)
+
+    # The main loop and the masked tail do not share statement IDs
+    ids = [str(stmt.nid) for stmt in ft.Schedule(func).find_all(lambda _: True)]
+    assert len(ids) == len(set(ids))
+
+    code = ft.codegen(func, target, verbose=True)
+    assert "vecReduceAdd<double, 4>" in str(code)
+
+    x_np = np.random.rand(4, 61)
+    y_np = np.zeros((4,), dtype="float64")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(y_np, device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.allclose(y_np, np.sum(x_np * x_np, axis=1))
+
+
+def test_gather():
+    with ft.VarDef([
+        ("idx", (20,), "int32", "input", "cpu"),
+        ("x", (100,), "float32", "input", "cpu"),
+        ("y", (20,), "float32", "output", "cpu"),
+    ]) as (idx, x, y):
+        with ft.For("i", 0, 20, nid="L1") as i:
+            y[i] = x[idx[i]] + x[2 * i]
+    func = ft.Func("main", ["idx", "x", "y"], [], ft.pop_ast())
+
+    s = ft.Schedule(func)
+    s.vectorize("L1")
+    func = ft.lower(s.func(), target, verbose=1)
+
+    code = ft.codegen(func, target, verbose=True)
+    assert "vecGather" in str(code)
+
+    idx_np = np.random.randint(0, 100, (20,)).astype("int32")
+    x_np = np.random.rand(100).astype("float32")
+    y_np = np.zeros((20,), dtype="float32")
+    idx_arr = ft.Array(idx_np, device)
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(y_np, device)
+    ft.build_binary(code, device)(idx=idx_arr, x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.allclose(y_np, x_np[idx_np] + x_np[0:40:2])
+
+
+def test_unsupported_fallback():
+    with ft.VarDef([
+        ("x", (64,), "float32", "input", "cpu"),
+        ("y", (64,), "float32", "output", "cpu"),
+    ]) as (x, y):
+        with ft.For("i", 0, 64, nid="L1") as i:
+            y[i] = ft.sqrt(x[i])
+    func = ft.Func("main", ["x", "y"], [], ft.pop_ast())
+
+    s = ft.Schedule(func)
+    s.vectorize("L1")
+    func = ft.lower(s.func(), target, verbose=1)
+
+    code = ft.codegen(func, target, verbose=True)
+    assert "#pragma omp simd" in str(code)
+
+    x_np = np.random.rand(64).astype("float32")
+    y_np = np.zeros((64,), dtype="float32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(y_np, device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.allclose(y_np, np.sqrt(x_np))
+
+
+@pytest.mark.parametrize("n", [64, 70])
+def test_streaming_store(n):
+    with ft.VarDef([
+        ("x", (4, n), "float32", "input", "cpu"),
+        ("y", (4, n), "float32", "output", "cpu"),
+    ]) as (x, y):
+        with ft.For("i", 0, 4, nid="L1") as i:
+            with ft.For("j", 0, n, nid="L2") as j:
+                y[i, j] = x[i, j] * 2 + 1
+    func = ft.Func("main", ["x", "y"], [], ft.pop_ast())
+
+    s = ft.Schedule(func)
+    s.vectorize("L2")
+    s.streaming_store("L2", "y")
+    func = ft.lower(s.func(), target, verbose=1)
+
+    code = ft.codegen(func, target, verbose=True)
+    assert "vecStreamStore<float, 8>" in str(code)
+    if n % 8 != 0:
+        # The tail is out of the fenced loop
+        assert "vecStoreN<float, 8>" in str(code)
+
+    x_np = np.random.rand(4, n).astype("float32")
+    y_np = np.zeros((4, n), dtype="float32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(y_np, device)
+    ft.build_binary(code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.allclose(y_np, x_np * 2 + 1)
@@ -1,3 +1,5 @@
+import ctypes
+
 import freetensor as ft
 import pytest
 import numpy as np
@@ -9,6 +11,21 @@ target = ft.CPU()
 device = ft.Device(target)
 
 
+def loaded_function(name):
+    """ Find a C function from the libraries loaded in this process """
+    with open("/proc/self/maps") as f:
+        paths = {
+            line.split()[-1]
+            for line in f
+            if ".so" in line and ("mkl" in line or "omp" in line)
+        }
+    for path in sorted(paths):
+        func = getattr(ctypes.CDLL(path), name, None)
+        if func is not None:
+            return func
+    return None
+
+
 def test_mkl_basic():
 
     @ft.transform
@@ -277,7 +294,8 @@ def test_mkl_in_parallel():
     func = ft.lower(s.func(), target, verbose=1)
     code = ft.codegen(func, target, verbose=True)
     assert "cblas" in str(code)
-    assert "mkl_set_num_threads_local(1)" in str(code)
+    assert "mkl_set_num_threads_local(innerBLASThreads(64))" in str(code)
+    assert "NestedBLASGuard" in str(code)
     a_np = np.random.uniform(size=(64, 48, 64)).astype("float32")
     b_np = np.random.uniform(size=(64, 64, 72)).astype("float32")
     c_np = np.random.uniform(size=(64, 48, 72)).astype("float32")
@@ -290,6 +308,51 @@ def test_mkl_in_parallel():
     assert np.all(np.isclose(c_result, c_np + a_np @ b_np))
 
 
+def test_mkl_few_large_in_parallel():
+
+    # Only 2 outer iterations, so the remaining threads go to MKL
+    @ft.transform
+    def test(a, b, c):
+        a: ft.Var[(2, 256, 512), "float32", "input", "cpu"]
+        b: ft.Var[(2, 512, 384), "float32", "input", "cpu"]
+        c: ft.Var[(2, 256, 384), "float32", "inout", "cpu"]
+        #! nid: L1
+        for n in range(2):
+            #! nid: L2
+            for i in range(256):
+                for j in range(384):
+                    for k in range(512):
+                        c[n, i, j] += a[n, i, k] * b[n, k, j]
+
+    s = ft.Schedule(test)
+    s.as_matmul("L2")
+    s.parallelize("L1", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "mkl_set_num_threads_local(innerBLASThreads(2))" in str(code)
+    a_np = np.random.uniform(size=(2, 256, 512)).astype("float32")
+    b_np = np.random.uniform(size=(2, 512, 384)).astype("float32")
+    c_np = np.random.uniform(size=(2, 256, 384)).astype("float32")
+    a_arr = ft.Array(a_np, ft.Device(ft.CPU()))
+    b_arr = ft.Array(b_np, ft.Device(ft.CPU()))
+    c_arr = ft.Array(c_np, ft.Device(ft.CPU()))
+    driver = ft.Driver(func, code, ft.Device(ft.CPU()))
+
+    # The process-wide settings of MKL and OpenMP are restored after running
+    get_dynamic = loaded_function("mkl_get_dynamic")
+    get_max_active_levels = loaded_function("omp_get_max_active_levels")
+    if get_dynamic is None or get_max_active_levels is None:
+        pytest.skip("MKL or OpenMP is not found in this process")
+    old_dynamic = get_dynamic()
+    old_max_active_levels = get_max_active_levels()
+    driver(a=a_arr, b=b_arr, c=c_arr)
+    assert get_dynamic() == old_dynamic
+    assert get_max_active_levels() == old_max_active_levels
+
+    c_result = c_arr.numpy()
+    assert np.all(np.isclose(c_result, c_np + a_np @ b_np, rtol=1e-4))
+
+
 def test_mkl_matrix_vector():
 
     @ft.transform
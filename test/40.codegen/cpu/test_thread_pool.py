@@ -0,0 +1,130 @@
+import freetensor as ft
+import pytest
+import numpy as np
+
+target = ft.CPU()
+target.set_parallel_runtime(ft.ParallelRuntime.ThreadPool)
+device = ft.Device(target)
+
+
+def test_parallel_for():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(1000,), "int32", "input", "cpu"]
+        y: ft.Var[(1000,), "int32", "output", "cpu"]
+        #! nid: L1
+        for i in range(0, 1000):
+            y[i] = x[i] + 1
+
+    s = ft.Schedule(test)
+    s.parallelize("L1", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "threadPool().parallelFor" in str(code)
+    assert "#pragma omp parallel" not in str(code)
+    x_np = np.random.randint(0, 100, (1000,)).astype("int32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((1000,), dtype="int32"), device)
+    driver = ft.Driver(func, code, device)
+    for _ in range(3):  # The workers are reused
+        driver(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.array_equal(y_np, x_np + 1)
+
+
+def test_nested_and_imbalanced():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(64, 64), "float32", "input", "cpu"]
+        y: ft.Var[(64, 64), "float32", "output", "cpu"]
+        #! nid: L1
+        for i in range(64):
+            #! nid: L2
+            for j in range(64):
+                y[i, j] = 0
+                for k in range(i + 1):
+                    y[i, j] += x[k, j]
+
+    s = ft.Schedule(test)
+    s.parallelize("L1", "openmp:dynamic:2")
+    s.parallelize("L2", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert str(code).count("threadPool().parallelFor") == 1
+    x_np = np.random.rand(64, 64).astype("float32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((64, 64), dtype="float32"), device)
+    ft.Driver(func, code, device)(x=x_arr, y=y_arr)
+    y_np = y_arr.numpy()
+
+    assert np.allclose(y_np, np.cumsum(x_np, axis=0), rtol=1e-4)
+
+
+def test_parallel_reduction():
+
+    @ft.transform
+    def test(x, y, z):
+        x: ft.Var[(4, 256), "int32", "input", "cpu"]
+        y: ft.Var[(4,), "int32", "inout", "cpu"]
+        z: ft.Var[(4,), "int32", "inout", "cpu"]
+        #! nid: L1
+        for i in range(0, 4):
+            #! nid: L2
+            for j in range(0, 256):
+                y[i] = y[i] + x[i, j]
+                z[i] = ft.max(z[i], x[i, j])
+
+    s = ft.Schedule(test)
+    s.parallelize("L2", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    assert "reductionLock()" in str(code)
+    assert "#pragma omp atomic" not in str(code)
+    x_np = np.random.randint(0, 100, (4, 256)).astype("int32")
+    x_arr = ft.Array(x_np, device)
+    y_arr = ft.Array(np.zeros((4,), dtype="int32"), device)
+    z_arr = ft.Array(np.zeros((4,), dtype="int32"), device)
+    ft.Driver(func, code, device)(x=x_arr, y=y_arr, z=z_arr)
+
+    assert np.array_equal(y_arr.numpy(), np.sum(x_np, axis=1))
+    assert np.array_equal(z_arr.numpy(), np.max(x_np, axis=1))
+
+
+def mapped_libraries():
+    with open("/proc/self/maps") as f:
+        return {line.split()[-1] for line in f if line.rstrip().endswith(".so")}
+
+
+def test_unloaded_and_pool_shared():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(1000,), "int32", "input", "cpu"]
+        y: ft.Var[(1000,), "int32", "output", "cpu"]
+        #! nid: L1
+        for i in range(0, 1000):
+            y[i] = x[i] * 3
+
+    s = ft.Schedule(test)
+    s.parallelize("L1", "openmp")
+    func = ft.lower(s.func(), target, verbose=1)
+    code = ft.codegen(func, target, verbose=True)
+    x_np = np.random.randint(0, 100, (1000,)).astype("int32")
+    x_arr = ft.Array(x_np, device)
+
+    before = mapped_libraries()
+    drivers = [ft.Driver(func, code, device) for _ in range(2)]
+    for driver in drivers:
+        y_arr = ft.Array(np.zeros((1000,), dtype="int32"), device)
+        driver(x=x_arr, y=y_arr)
+        assert np.array_equal(y_arr.numpy(), x_np * 3)
+    loaded = mapped_libraries() - before
+    assert loaded
+
+    # The workers are owned by FreeTensor, not by the program, so the program
+    # can really be unmapped
+    del driver, drivers
+    assert not (mapped_libraries() & loaded)
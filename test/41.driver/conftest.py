@@ -0,0 +1,38 @@
+import freetensor as ft
+import pytest
+
+
+@pytest.fixture
+def make_code():
+    '''
+    Make the native code of a program setting `x[i] = i + val`
+    '''
+
+    def make(val=0):
+        with ft.VarDef("x", (4,), "int32", "output") as x:
+            with ft.For("i", 0, 4) as i:
+                x[i] = i + val
+        func = ft.lower(ft.Func("main", ["x"], [], ft.pop_ast()), verbose=1)
+        return ft.codegen(func, verbose=True)
+
+    return make
+
+
+@pytest.fixture
+def make_exe():
+    '''
+    Make a Driver of a program setting `y[i] = x[i] + 1`
+    '''
+
+    def make():
+
+        @ft.optimize(verbose=1)
+        def f(x, y):
+            x: ft.Var[(4,), "int32", "input", "cpu"]
+            y: ft.Var[(4,), "int32", "output", "cpu"]
+            for i in range(4):
+                y[i] = x[i] + 1
+
+        return f
+
+    return make
@@ -0,0 +1,47 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+def test_reuse():
+    ft.trim_array_pool()
+    ft.Array(np.zeros((1000,), dtype="float32"))  # Freed immediately
+    hits = ft.array_pool_stats()["hits"]
+    assert ft.array_pool_stats()["cached_bytes"] >= 4000
+    x = ft.Array(np.ones((1000,), dtype="float32"))
+    assert ft.array_pool_stats()["hits"] == hits + 1
+    assert np.array_equal(x.numpy(), np.ones((1000,), dtype="float32"))
+
+
+def test_trim():
+    ft.Array(np.zeros((1000,), dtype="float32"))
+    ft.trim_array_pool()
+    assert ft.array_pool_stats()["cached_bytes"] == 0
+
+
+def test_alignment():
+    old = ft.array_alignment()
+    ft.set_array_alignment(4096)
+    try:
+        x = ft.Array(np.zeros((3,), dtype="int32"))
+        view = np.asarray(x)
+        assert view.ctypes.data % 4096 == 0
+    finally:
+        ft.set_array_alignment(old)
+
+
+def test_invalid_alignment():
+    with pytest.raises(ft.DriverError):
+        ft.set_array_alignment(3)
+
+
+def test_first_touch():
+    old = ft.array_first_touch()
+    ft.set_array_first_touch(True)
+    try:
+        ft.trim_array_pool()  # Make sure the storage is newly allocated
+        x_np = np.random.rand(1 << 20).astype("float32")
+        x = ft.Array(x_np)
+        assert np.array_equal(x.numpy(), x_np)
+    finally:
+        ft.set_array_first_touch(old)
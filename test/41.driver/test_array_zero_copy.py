@@ -0,0 +1,89 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+def test_borrow():
+    x_np = np.array([1, 2, 3, 4], dtype="int32")
+    x_arr = ft.Array(x_np, copy=False)
+    assert x_arr.is_borrowed
+    x_np[0] = 10
+    assert np.array_equal(x_arr.numpy(),
+                          np.array([10, 2, 3, 4], dtype="int32"))
+
+
+def test_copy_by_default():
+    x_np = np.array([1, 2, 3, 4], dtype="int32")
+    x_arr = ft.Array(x_np)
+    assert not x_arr.is_borrowed
+    x_np[0] = 10
+    assert np.array_equal(x_arr.numpy(), np.array([1, 2, 3, 4],
+                                                  dtype="int32"))
+
+
+def test_read_only_is_copied():
+    x_np = np.array([1, 2, 3, 4], dtype="int32")
+    x_np.flags.writeable = False
+    x_arr = ft.Array(x_np, copy=False)
+    assert not x_arr.is_borrowed
+
+
+def test_non_contiguous_is_copied():
+    x_np = np.array([1, 2, 3, 4], dtype="int32")[::2]
+    x_arr = ft.Array(x_np, copy=False)
+    assert not x_arr.is_borrowed
+    assert np.array_equal(x_arr.numpy(), np.array([1, 3], dtype="int32"))
+
+
+def test_unsupported_dtype():
+    with pytest.raises(ft.DriverError):
+        ft.Array(np.array([1, 2, 3, 4], dtype="int16"), copy=False)
+
+
+def test_unsupported_dtype_is_converted_when_copied():
+    for x in [np.array([1, 2, 3, 4], dtype="int16"), [1, 2, 3, 4]]:
+        x_arr = ft.Array(x)
+        assert x_arr.dtype == "float64"
+        assert np.array_equal(x_arr.numpy(),
+                              np.array([1, 2, 3, 4], dtype="float64"))
+
+
+def test_write_to_borrowed():
+    with ft.VarDef("x", (4,), "int32", "inout") as x:
+        with ft.For("i", 0, 4) as i:
+            x[i] = x[i] + 1
+    func = ft.lower(ft.Func("main", ["x"], [], ft.pop_ast()), verbose=1)
+    exe = ft.build_binary(ft.codegen(func, verbose=True))
+
+    x_np = np.array([1, 2, 3, 4], dtype="int32")
+    exe(x=ft.Array(x_np, copy=False))
+    assert np.array_equal(x_np, np.array([2, 3, 4, 5], dtype="int32"))
+
+
+def test_write_to_borrowed_on_another_cpu_device():
+    with ft.VarDef("x", (4,), "int32", "inout") as x:
+        with ft.For("i", 0, 4) as i:
+            x[i] = x[i] + 1
+    func = ft.lower(ft.Func("main", ["x"], [], ft.pop_ast()), verbose=1)
+    exe = ft.build_binary(ft.codegen(func, verbose=True))
+
+    # An equal device object, but not the one of the Driver
+    x_np = np.array([1, 2, 3, 4], dtype="int32")
+    exe(x=ft.Array(x_np, ft.Device(ft.CPU()), copy=False))
+    assert np.array_equal(x_np, np.array([2, 3, 4, 5], dtype="int32"))
+
+
+def test_borrowed_outlives_numpy():
+    x_arr = ft.Array(np.array([1, 2, 3, 4], dtype="int32"), copy=False)
+    assert np.array_equal(x_arr.numpy(), np.array([1, 2, 3, 4],
+                                                  dtype="int32"))
+
+
+def test_buffer_protocol():
+    x_arr = ft.Array(np.array([[1, 2], [3, 4]], dtype="float32"))
+    view = np.asarray(x_arr)
+    assert view.dtype == np.float32
+    assert view.shape == (2, 2)
+    assert np.array_equal(view, np.array([[1, 2], [3, 4]], dtype="float32"))
+    view[0, 0] = 10
+    assert x_arr.numpy()[0, 0] == 10
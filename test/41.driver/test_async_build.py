@@ -0,0 +1,53 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+def test_run_joins(make_code):
+    exe = ft.build_binary(make_code(1), async_build=True)
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    exe(x=x_arr)
+    assert exe.is_ready()
+    assert np.array_equal(x_arr.numpy(), np.array([1, 2, 3, 4], dtype="int32"))
+
+
+def test_wait(make_code):
+    exe = ft.build_binary(make_code(1), async_build=True)
+    exe.wait()
+    assert exe.is_ready()
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    exe(x=x_arr)
+    assert np.array_equal(x_arr.numpy(), np.array([1, 2, 3, 4], dtype="int32"))
+
+
+def test_multiple(make_code):
+    exes = [ft.build_binary(make_code(i), async_build=True) for i in range(4)]
+    for i, exe in enumerate(exes):
+        x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+        exe(x=x_arr)
+        assert np.array_equal(x_arr.numpy(),
+                              np.array([i, i + 1, i + 2, i + 3], dtype="int32"))
+
+
+def test_error_on_join(make_code):
+    code = make_code(1)
+    exe = ft.build_binary(ft.NativeCode(code.func, code.code + "#error x",
+                                        code.target),
+                          async_build=True)
+    with pytest.raises(ft.DriverError):
+        exe.wait()
+
+
+def test_error_is_sticky(make_code):
+    code = make_code(1)
+    exe = ft.build_binary(ft.NativeCode(code.func, code.code + "#error x",
+                                        code.target),
+                          async_build=True)
+    with pytest.raises(ft.DriverError):
+        exe.wait()
+    # Raised again, instead of running a program not loaded
+    with pytest.raises(ft.DriverError):
+        exe.wait()
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    with pytest.raises(ft.DriverError):
+        exe(x=x_arr)
@@ -0,0 +1,37 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+def check(exe, val):
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    exe(x=x_arr)
+    assert np.array_equal(
+        x_arr.numpy(), np.array([val, val + 1, val + 2, val + 3],
+                                dtype="int32"))
+
+
+def test_basic(make_code):
+    exes = ft.build_binaries([make_code(i) for i in range(4)])
+    assert len(exes) == 4
+    for i, exe in enumerate(exes):
+        check(exe, i)
+
+
+def test_async(make_code):
+    exes = ft.build_binaries([make_code(i) for i in range(4)], async_build=True)
+    for i, exe in reversed(list(enumerate(exes))):
+        check(exe, i)
+    assert all(exe.is_ready() for exe in exes)
+
+
+def test_keep_alive(make_code):
+    exe = ft.build_binaries([make_code(1), make_code(2)])[1]
+    check(exe, 2)
+
+
+def test_error(make_code):
+    code = make_code(1)
+    bad = ft.NativeCode(code.func, code.code + "#error x", code.target)
+    with pytest.raises(ft.DriverError):
+        ft.build_binaries([code, bad])
@@ -0,0 +1,47 @@
+import freetensor as ft
+import numpy as np
+
+
+def test_fixed_rounds(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    exe.set_args(x, y)
+    result = exe.benchmark(ft.TimingOptions(min_rounds=7, max_rounds=7))
+    exe.collect_returns()
+    assert result.rounds == 7
+    assert result.repeats == 1
+    assert 0 < result.median
+    assert np.array_equal(y.numpy(), np.array([2, 3, 4, 5], dtype="int32"))
+
+
+def test_adaptive_rounds(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    exe.set_args(x, y)
+    result = exe.benchmark(
+        ft.TimingOptions(min_rounds=5,
+                         max_rounds=1000,
+                         max_rel_ci=0.5,
+                         min_round_time=1))
+    exe.collect_returns()
+    assert 5 <= result.rounds < 1000
+    assert result.rel_ci <= 0.5
+    # A tiny program is run repeatedly in a round of at least 1 ms
+    assert result.repeats > 1
+
+
+def test_flush_cache(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    exe.set_args(x, y)
+    result = exe.benchmark(
+        ft.TimingOptions(min_rounds=3,
+                         max_rounds=3,
+                         min_round_time=1,
+                         flush_cache=True))
+    exe.collect_returns()
+    assert result.rounds == 3
+    assert result.repeats == 1  # Not repeated, to keep the caches cold
@@ -0,0 +1,99 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+@pytest.fixture
+def cache_dir(tmp_path):
+    old_flag = ft.compile_cache()
+    old_dir = ft.compile_cache_dir()
+    old_size = ft.compile_cache_size()
+    ft.set_compile_cache(True)
+    ft.set_compile_cache_dir(str(tmp_path))
+    ft.reset_compile_cache_stats()
+    yield tmp_path
+    ft.set_compile_cache(old_flag)
+    ft.set_compile_cache_dir(old_dir)
+    ft.set_compile_cache_size(old_size)
+
+
+def run(code, val):
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    ft.build_binary(code)(x=x_arr)
+    assert np.array_equal(
+        x_arr.numpy(), np.array([val, val + 1, val + 2, val + 3],
+                                dtype="int32"))
+
+
+def test_hit(cache_dir, make_code):
+    code = make_code(1)
+    run(code, 1)
+    assert ft.compile_cache_misses() == 1
+    assert ft.compile_cache_hits() == 0
+    assert len(list(cache_dir.glob("*.so"))) == 1
+
+    run(code, 1)
+    assert ft.compile_cache_misses() == 1
+    assert ft.compile_cache_hits() == 1
+
+
+def test_broken_entry_is_not_a_hit(cache_dir, make_code):
+    code = make_code(1)
+    run(code, 1)
+    for so in cache_dir.glob("*.so"):
+        so.write_bytes(b"broken")
+    run(code, 1)  # Failed to load the cached one, and built again
+    assert ft.compile_cache_misses() == 2
+    assert ft.compile_cache_hits() == 0
+
+
+def test_different_code(cache_dir, make_code):
+    run(make_code(1), 1)
+    run(make_code(2), 2)
+    assert ft.compile_cache_misses() == 2
+    assert ft.compile_cache_hits() == 0
+    assert len(list(cache_dir.glob("*.so"))) == 2
+
+
+def test_different_target(cache_dir, make_code):
+    code = make_code(1)
+    run(code, 1)
+    target = ft.CPU(use_native_arch=False)
+    with ft.Device(target):
+        code = make_code(1)
+        run(code, 1)
+    assert ft.compile_cache_misses() == 2
+
+
+def test_evict(cache_dir, make_code):
+    ft.set_compile_cache_size(0)
+    code = make_code(1)
+    run(code, 1)
+    assert len(list(cache_dir.glob("*.so"))) == 0
+    run(code, 1)
+    assert ft.compile_cache_misses() == 2
+
+
+def test_disabled(cache_dir, make_code):
+    ft.set_compile_cache(False)
+    code = make_code(1)
+    run(code, 1)
+    run(code, 1)
+    assert ft.compile_cache_misses() == 0
+    assert ft.compile_cache_hits() == 0
+    assert len(list(cache_dir.glob("*.so"))) == 0
+
+
+def test_precompiled_runtime_header(cache_dir, make_code):
+    run(make_code(1), 1)
+    run(make_code(2), 2)
+    # Shared by both programs
+    assert len(list(cache_dir.glob("pch/*/cpu_runtime.h.gch"))) == 1
+
+
+def test_evict_precompiled_runtime_header(cache_dir, make_code):
+    ft.set_compile_cache_size(0)
+    run(make_code(1), 1)
+    assert len(list(cache_dir.glob("pch/*"))) == 0
+    # Built again after being evicted
+    run(make_code(2), 2)
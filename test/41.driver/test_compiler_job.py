@@ -0,0 +1,41 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+@pytest.fixture(autouse=True)
+def no_cache():
+    old_flag = ft.compile_cache()
+    ft.set_compile_cache(False)
+    yield
+    ft.set_compile_cache(old_flag)
+
+
+def test_diagnostics_in_error(make_code):
+    code = make_code()
+    with pytest.raises(ft.DriverError, match="this_is_a_test_error"):
+        ft.build_binary(
+            ft.NativeCode(code.func, code.code + "#error this_is_a_test_error",
+                          code.target))
+
+
+def test_compile_time(make_code):
+    exe = ft.build_binary(make_code())
+    assert exe.compile_time() > 0
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    exe(x=x_arr)
+    assert np.array_equal(x_arr.numpy(), np.array([0, 1, 2, 3], dtype="int32"))
+
+
+def test_limited_jobs(make_code):
+    old = ft.backend_compiler_jobs()
+    ft.set_backend_compiler_jobs(1)
+    try:
+        exes = [
+            ft.build_binary(make_code(), async_build=True) for _ in range(3)
+        ]
+        for exe in exes:
+            exe.wait()
+            assert exe.is_ready()
+    finally:
+        ft.set_backend_compiler_jobs(old)
@@ -0,0 +1,45 @@
+import freetensor as ft
+import numpy as np
+
+
+def test_dynamic_sized_local():
+    with ft.VarDef("n", (), "int32", "input", "byvalue") as n:
+        with ft.VarDef([("x", (n,), "int32", "input", "cpu"),
+                        ("y", (n,), "int32", "output", "cpu")]) as (x, y):
+            with ft.VarDef("t", (n,), "int32", "cache", "cpu") as t:
+                with ft.For("i", 0, n) as i:
+                    t[i] = x[i] * 2
+                with ft.For("i", 0, n) as i:
+                    y[i] = t[n - 1 - i] + t[i]
+    func = ft.lower(ft.Func("main", ["n", "x", "y"], [], ft.pop_ast()),
+                    skip_passes=["prop_one_time_use"],
+                    verbose=1)
+    code = ft.codegen(func, verbose=True)
+    assert "_ctx->alloc" in code.code
+    exe = ft.build_binary(code)
+
+    for size in [10, 1000]:
+        n_arr = ft.Array(np.array(size, dtype="int32"))
+        x_np = np.arange(size, dtype="int32")
+        x_arr = ft.Array(x_np)
+        y_arr = ft.Array(np.zeros((size,), dtype="int32"))
+        exe(n_arr, x_arr, y_arr)
+        assert np.array_equal(y_arr.numpy(), x_np[::-1] * 2 + x_np * 2)
+
+
+def test_return_from_pool():
+
+    @ft.optimize(verbose=1)
+    def f(n: ft.Var[(), "int32"]):
+        y = ft.empty((n,), "int32")
+        for i in range(n):
+            y[i] = i
+        return y
+
+    ft.trim_array_pool()
+    live = ft.array_pool_stats()["live_bytes"]
+    y = f(ft.Array(np.array(1000, dtype="int32")))
+    assert ft.array_pool_stats()["live_bytes"] >= live + 4000
+    assert np.array_equal(y.numpy(), np.arange(1000, dtype="int32"))
+    del y
+    assert ft.array_pool_stats()["live_bytes"] == live
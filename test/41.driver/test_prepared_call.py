@@ -0,0 +1,87 @@
+import os
+import time
+
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+def test_basic(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    call = exe.prepare(x, y)
+    for i in range(3):
+        x = ft.Array(np.array([1, 2, 3, 4], dtype="int32") * i)
+        y = ft.Array(np.zeros((4,), dtype="int32"))
+        call(x, y)
+        assert np.array_equal(y.numpy(),
+                              np.array([1, 2, 3, 4], dtype="int32") * i + 1)
+
+
+def test_prepare_with_kws(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    call = exe.prepare(y=y, x=x)
+    # Positional in the order in the signature
+    call(x, y)
+    assert np.array_equal(y.numpy(), np.array([2, 3, 4, 5], dtype="int32"))
+
+
+def test_wrong_dtype(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    call = exe.prepare(x, y)
+    with pytest.raises(ft.DriverError):
+        call(ft.Array(np.array([1, 2, 3, 4], dtype="float32")), y)
+
+
+def test_wrong_number_of_args(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    call = exe.prepare(x, y)
+    with pytest.raises(ft.DriverError):
+        call(x)
+
+
+def test_alternating_arrays(make_exe):
+    exe = make_exe()
+    x_np = [np.array([1, 2, 3, 4], dtype="int32") * k for k in range(2)]
+    xs = [ft.Array(x) for x in x_np]
+    call = exe.prepare(xs[0], ft.Array(np.zeros((4,), dtype="int32")))
+    # Each call on the fast path writes to the arrays given to it, not to the
+    # ones of the previous call
+    last_y = None
+    for i in range(100):
+        k = i % 2
+        y = ft.Array(np.zeros((4,), dtype="int32"))
+        call(xs[k], y)
+        assert np.array_equal(y.numpy(), x_np[k] + 1)
+        if last_y is not None:
+            assert np.array_equal(last_y.numpy(), x_np[1 - k] + 1)
+        last_y = y
+
+
+@pytest.mark.skipif("FT_BENCHMARK" not in os.environ,
+                    reason="benchmark, set FT_BENCHMARK to run")
+def test_overhead(make_exe):
+    exe = make_exe()
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    call = exe.prepare(x, y)
+    n = 10000
+
+    def per_call(f):
+        for _ in range(100):  # Warm up
+            f(x, y)
+        beg = time.perf_counter()
+        for _ in range(n):
+            f(x, y)
+        return (time.perf_counter() - beg) / n * 1e6
+
+    # Only printed. Timings are too noisy to assert
+    print(f"driver(...): {per_call(exe):.2f} us per call")
+    print(f"prepare()(...): {per_call(call):.2f} us per call")
@@ -0,0 +1,45 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+def check(exe, val):
+    x_arr = ft.Array(np.zeros((4,), dtype="int32"))
+    exe(x=x_arr)
+    assert np.array_equal(
+        x_arr.numpy(), np.array([val, val + 1, val + 2, val + 3],
+                                dtype="int32"))
+
+
+def test_unload(make_code):
+    count = ft.resident_library_count()
+    nbytes = ft.resident_library_bytes()
+    exe = ft.build_binary(make_code(1000))
+    check(exe, 1000)
+    assert ft.resident_library_count() == count + 1
+    assert ft.resident_library_bytes() > nbytes
+    del exe
+    assert ft.resident_library_count() == count
+    assert ft.resident_library_bytes() == nbytes
+
+
+def test_shared_by_batch(make_code):
+    count = ft.resident_library_count()
+    exes = ft.build_binaries([make_code(2000), make_code(2001)])
+    assert ft.resident_library_count() == count + 1
+    exe = exes[1]
+    del exes
+    assert ft.resident_library_count() == count + 1
+    check(exe, 2001)
+    del exe
+    assert ft.resident_library_count() == count
+
+
+def test_reload_many_times(make_code):
+    count = ft.resident_library_count()
+    code = make_code(3000)
+    for _ in range(10):
+        exe = ft.build_binary(code)
+        check(exe, 3000)
+        del exe
+    assert ft.resident_library_count() == count
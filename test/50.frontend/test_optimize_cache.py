@@ -0,0 +1,117 @@
+import freetensor as ft
+import numpy as np
+import pytest
+
+
+@pytest.fixture(autouse=True)
+def clear_cache():
+    ft.clear_optimize_cache()
+    yield
+    ft.set_optimize_cache_size(128)
+    ft.clear_optimize_cache()
+
+
+def make_func():
+
+    @ft.transform
+    def f(x, y):
+        x: ft.Var[(4,), "int32", "input", "cpu"]
+        y: ft.Var[(4,), "int32", "output", "cpu"]
+        #! nid: L1
+        for i in range(4):
+            y[i] = x[i] + 1
+
+    return f
+
+
+def check(exe):
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y = ft.Array(np.zeros((4,), dtype="int32"))
+    exe(x, y)
+    assert np.array_equal(y.numpy(), np.array([2, 3, 4, 5], dtype="int32"))
+
+
+def test_hit():
+    device = ft.Device(ft.CPU())
+    exe1 = ft.optimize(make_func(), device=device)
+    count = ft.resident_library_count()
+    exe2 = ft.optimize(make_func(), device=device)
+    check(exe1)
+    check(exe2)
+    # A new Driver sharing the loaded binary
+    assert exe1 is not exe2
+    assert ft.resident_library_count() == count
+    info = ft.optimize_cache_info()
+    assert info.hits == 1
+    assert info.misses == 1
+    assert info.currsize == 1
+
+
+def test_different_schedule():
+    device = ft.Device(ft.CPU())
+    exe1 = ft.optimize(make_func(), device=device)
+    exe2 = ft.optimize(make_func(),
+                       lambda s: s.parallelize("L1", "openmp"),
+                       device=device)
+    check(exe1)
+    check(exe2)
+    assert exe1 is not exe2
+    assert ft.optimize_cache_info().misses == 2
+
+
+def test_different_target():
+    exe1 = ft.optimize(make_func(), device=ft.Device(ft.CPU()))
+    exe2 = ft.optimize(make_func(),
+                       device=ft.Device(ft.CPU(use_native_arch=False)))
+    check(exe1)
+    check(exe2)
+    assert exe1 is not exe2
+    assert ft.optimize_cache_info().misses == 2
+
+
+def test_drivers_are_independent():
+    device = ft.Device(ft.CPU())
+    exe1 = ft.optimize(make_func(), device=device)
+    exe2 = ft.optimize(make_func(), device=device)
+    x = ft.Array(np.array([1, 2, 3, 4], dtype="int32"))
+    y1 = ft.Array(np.zeros((4,), dtype="int32"))
+    y2 = ft.Array(np.zeros((4,), dtype="int32"))
+    call = exe1.prepare(x, y1)
+    exe2(x, y2)
+    call(x, y1)
+    assert np.array_equal(y1.numpy(), np.array([2, 3, 4, 5], dtype="int32"))
+    assert np.array_equal(y2.numpy(), np.array([2, 3, 4, 5], dtype="int32"))
+    del exe1, call
+    check(exe2)
+
+
+def test_different_config():
+    device = ft.Device(ft.CPU())
+    old = ft.debug_binary()
+    try:
+        ft.set_debug_binary(False)
+        exe1 = ft.optimize(make_func(), device=device)
+        ft.set_debug_binary(True)
+        exe2 = ft.optimize(make_func(), device=device)
+    finally:
+        ft.set_debug_binary(old)
+    check(exe1)
+    check(exe2)
+    assert ft.optimize_cache_info().misses == 2
+
+
+def test_disabled():
+    ft.set_optimize_cache_size(0)
+    device = ft.Device(ft.CPU())
+    exe1 = ft.optimize(make_func(), device=device)
+    exe2 = ft.optimize(make_func(), device=device)
+    assert exe1 is not exe2
+    assert ft.optimize_cache_info().currsize == 0
+
+
+def test_device_is_hashable():
+    dev1 = ft.Device(ft.CPU())
+    dev2 = ft.Device(ft.CPU())
+    assert dev1 == dev2
+    assert hash(dev1) == hash(dev2)
+    assert len({dev1, dev2}) == 1
@@ -0,0 +1,56 @@
+import freetensor as ft
+import numpy as np
+
+target = ft.CPU()
+device = ft.Device(target)
+
+
+def test_rank_by_features():
+    rng = np.random.default_rng(0)
+
+    def gen(n):
+        features = rng.random((n, 32)) * 1000
+        flops = np.exp(3 * (features[:, 3] > 500) + features[:, 7] / 300)
+        return features.tolist(), flops.tolist()
+
+    model = ft.ffi.CostModel()
+    assert not model.trained()
+    assert model.predict([[0.] * 32] * 3) == [1., 1., 1.]
+    for i in range(5):
+        model.update(*gen(64))
+    assert model.trained()
+
+    features, flops = gen(1000)
+    pred = model.predict(features)
+    agree = sum((pred[i] < pred[i + 1]) == (flops[i] < flops[i + 1])
+                for i in range(0, 1000, 2))
+    assert agree > 400
+
+
+def test_search_with_native_model():
+    a = 64
+    b = 64
+
+    @ft.transform
+    def test(x, y, z):
+        x: ft.Var[(a, b), "float32", "input", "cpu"]
+        y: ft.Var[(b, a), "float32", "input", "cpu"]
+        z: ft.Var[(a, a), "float32", "output", "cpu"]
+        #! nid: L1
+        for i in range(a):
+            #! nid: L2
+            for j in range(a):
+                z[i, j] = 0
+                #! nid: L3
+                for k in range(b):
+                    z[i, j] += x[i, k] * y[k, j]
+
+    s = ft.AutoSchedule(ft.Schedule(test), target, device, 8)
+    x_arr = ft.Array(np.random.rand(a, b).astype("float32"), device)
+    y_arr = ft.Array(np.random.rand(b, a).astype("float32"), device)
+    z_arr = ft.Array(np.zeros((a, a), dtype="float32"), device)
+    s.set_params(x=x_arr, y=y_arr, z=z_arr)
+    # The second round is guided by the model trained in the first one
+    s.search_one_round(4)
+    s.search_one_round(4)
+    assert s.get_best_time() < 1e30
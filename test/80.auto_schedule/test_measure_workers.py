@@ -0,0 +1,110 @@
+import time
+
+import freetensor as ft
+import numpy as np
+import pytest
+
+target = ft.CPU()
+device = ft.Device(target)
+
+
+def test_measure_in_workers():
+    a = 64
+    b = 64
+
+    @ft.transform
+    def test(x, y, z):
+        x: ft.Var[(a, b), "float32", "input", "cpu"]
+        y: ft.Var[(b, a), "float32", "input", "cpu"]
+        z: ft.Var[(a, a), "float32", "output", "cpu"]
+        #! nid: L1
+        for i in range(a):
+            #! nid: L2
+            for j in range(a):
+                z[i, j] = 0
+                #! nid: L3
+                for k in range(b):
+                    z[i, j] += x[i, k] * y[k, j]
+
+    s = ft.Schedule(test)
+    s = ft.AutoSchedule(s, target, device, 8, measure_workers=2)
+    x_arr = ft.Array(np.random.rand(a, b).astype("float32"), device)
+    y_arr = ft.Array(np.random.rand(b, a).astype("float32"), device)
+    z_arr = ft.Array(np.zeros((a, a), dtype="float32"), device)
+    s.set_params(x=x_arr, y=y_arr, z=z_arr)
+    s.search_one_round(4)
+    assert s.get_best_time() < 1e30
+
+
+def test_crash_is_recovered():
+
+    @ft.transform
+    def test(x, idx, y):
+        x: ft.Var[(4,), "float32", "input", "cpu"]
+        idx: ft.Var[(4,), "int64", "input", "cpu"]
+        y: ft.Var[(4,), "float32", "output", "cpu"]
+        for i in range(4):
+            y[i] = x[idx[i]]
+
+    func = ft.lower(test, target, verbose=1)
+    code = str(ft.codegen(func, target, verbose=True))
+    x_arr = ft.Array(np.array([1, 2, 3, 4], dtype="float32"), device)
+    y_arr = ft.Array(np.zeros((4,), dtype="float32"), device)
+    bad_idx = ft.Array(np.full((4,), 1 << 44, dtype="int64"), device)
+    good_idx = ft.Array(np.array([3, 2, 1, 0], dtype="int64"), device)
+
+    worker = ft.MeasureWorker()
+    with pytest.raises(ft.DriverError, match="crashed"):
+        worker.time(func, code, [x_arr, bad_idx, y_arr])
+    # The worker is spawned again for the next program
+    assert worker.time(func, code, [x_arr, good_idx, y_arr]).median < 1e30
+
+
+def test_timeout():
+
+    @ft.transform
+    def test(x, y):
+        x: ft.Var[(4,), "float32", "input", "cpu"]
+        y: ft.Var[(1,), "float32", "inout", "cpu"]
+        for i in range(1 << 20):
+            for j in range(1 << 20):
+                y[0] = y[0] * 0.5 + x[(i + j) % 4]
+
+    func = ft.lower(test, target, verbose=1)
+    code = str(ft.codegen(func, target, verbose=True))
+    x_arr = ft.Array(np.array([1, 2, 3, 4], dtype="float32"), device)
+    y_arr = ft.Array(np.zeros((1,), dtype="float32"), device)
+
+    worker = ft.MeasureWorker(timeout=1)
+    begin = time.time()
+    with pytest.raises(ft.DriverError, match="timed out"):
+        worker.time(func, code, [x_arr, y_arr])
+    assert time.time() - begin < 30  # Including the compiling time
+
+
+def test_mem_limit():
+
+    # A local buffer of 1 GiB, indexed by an input so it is not shrunk. Only 4
+    # elements are touched, so it is cheap if allowed
+    @ft.transform
+    def test(x, idx, y):
+        x: ft.Var[(4,), "float32", "input", "cpu"]
+        idx: ft.Var[(4,), "int32", "input", "cpu"]
+        y: ft.Var[(4,), "float32", "output", "cpu"]
+        t = ft.empty((1 << 28,), "float32", "cpu")
+        for i in range(4):
+            t[idx[i]] = x[i]
+        for i in range(4):
+            y[i] = t[idx[i]] * 2
+
+    func = ft.lower(test, target, verbose=1)
+    code = str(ft.codegen(func, target, verbose=True))
+    x_arr = ft.Array(np.array([1, 2, 3, 4], dtype="float32"), device)
+    idx_arr = ft.Array(np.array([0, 1, 2, 3], dtype="int32"), device)
+    y_arr = ft.Array(np.zeros((4,), dtype="float32"), device)
+
+    assert ft.MeasureWorker().time(func, code,
+                                   [x_arr, idx_arr, y_arr]).median < 1e30
+    with pytest.raises(ft.DriverError):
+        ft.MeasureWorker(mem_limit=256 << 20).time(func, code,
+                                                   [x_arr, idx_arr, y_arr])
@@ -0,0 +1,44 @@
+import freetensor as ft
+import numpy as np
+
+target = ft.CPU()
+device = ft.Device(target)
+
+
+def test_replay_and_warm_start(tmp_path):
+    a = 64
+    b = 64
+
+    @ft.transform
+    def test(x, y, z):
+        x: ft.Var[(a, b), "float32", "input", "cpu"]
+        y: ft.Var[(b, a), "float32", "input", "cpu"]
+        z: ft.Var[(a, a), "float32", "output", "cpu"]
+        #! nid: L1
+        for i in range(a):
+            #! nid: L2
+            for j in range(a):
+                z[i, j] = 0
+                #! nid: L3
+                for k in range(b):
+                    z[i, j] += x[i, k] * y[k, j]
+
+    log = ft.TuningLog(str(tmp_path / "log.jsonl"))
+    x_arr = ft.Array(np.random.rand(a, b).astype("float32"), device)
+    y_arr = ft.Array(np.random.rand(b, a).astype("float32"), device)
+    z_arr = ft.Array(np.zeros((a, a), dtype="float32"), device)
+
+    s = ft.AutoSchedule(ft.Schedule(test), target, device, 8, tuning_log=log)
+    s.set_params(x=x_arr, y=y_arr, z=z_arr)
+    s.search_one_round(4)
+    best = log.best(s.get_workload(), s.target_fingerprint)
+    assert best is not None
+
+    # A new run replays the best program without measuring
+    s2 = ft.AutoSchedule(ft.Schedule(test), target, device, 8, tuning_log=log)
+    replayed = s2.apply_best_record()
+    assert replayed is not None
+    assert len(replayed.logs()) == len(best.logs)
+
+    # ... and starts with the measured programs
+    assert s2.get_best_time() == best.time